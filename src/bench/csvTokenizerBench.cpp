@@ -0,0 +1,118 @@
+// Microbenchmark for the CSV tokenizer used by LOAD and LOAD MATRIX.
+// Build and run from src/ with: make bench && ./bench/csvTokenizerBench [MB]
+//
+// Generates a narrow (3 columns) and a wide (100 columns) CSV text in memory
+// and parses each with the old getline/stringstream/stoi path and with
+// CsvTokenizer + parseCsvInteger at every scan level the CPU supports. Every
+// path sums the parsed values, so the checksums must agree.
+
+#include "../csvTokenizer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+static string generateCsv(int columnCount, size_t targetBytes)
+{
+    mt19937 generator(42);
+    uniform_int_distribution<int> values(-100000, 100000);
+    string csv;
+    csv.reserve(targetBytes + 4096);
+    while (csv.size() < targetBytes)
+    {
+        for (int column = 0; column < columnCount; column++)
+        {
+            if (column != 0)
+            {
+                csv += ", ";
+            }
+            csv += to_string(values(generator));
+        }
+        csv += '\n';
+    }
+    return csv;
+}
+
+static long long parseWithStreams(const string &csv)
+{
+    long long sum = 0;
+    istringstream input(csv);
+    string line, word;
+    while (getline(input, line))
+    {
+        stringstream fields(line);
+        while (getline(fields, word, ','))
+        {
+            sum += stoi(word);
+        }
+    }
+    return sum;
+}
+
+static long long parseWithTokenizer(const string &csv)
+{
+    long long sum = 0;
+    CsvTokenizer tokenizer(csv.data(), csv.data() + csv.size());
+    const char *fieldBegin;
+    const char *fieldEnd;
+    while (tokenizer.nextLine())
+    {
+        while (tokenizer.nextField(fieldBegin, fieldEnd))
+        {
+            int value;
+            if (parseCsvInteger(fieldBegin, fieldEnd, value) == CSV_PARSE_OK)
+            {
+                sum += value;
+            }
+        }
+    }
+    return sum;
+}
+
+static void report(const char *path, const char *file, const string &csv, long long (*parse)(const string &))
+{
+    // Best of three runs
+    double bestSeconds = 0;
+    long long checksum = 0;
+    for (int run = 0; run < 3; run++)
+    {
+        auto start = chrono::steady_clock::now();
+        checksum = parse(csv);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (run == 0 || seconds < bestSeconds)
+        {
+            bestSeconds = seconds;
+        }
+    }
+    printf("%-8s %-22s %9.1f MB/s  checksum %lld\n", file, path, csv.size() / bestSeconds / (1 << 20), checksum);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t megabytes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 64;
+    const int columnCounts[] = {3, 100};
+    const char *fileNames[] = {"narrow", "wide"};
+    const CsvScanLevel levels[] = {CSV_SCAN_SCALAR, CSV_SCAN_SSE2, CSV_SCAN_AVX2};
+    CsvScanLevel bestLevel = getCsvScanLevel();
+
+    for (int file = 0; file < 2; file++)
+    {
+        string csv = generateCsv(columnCounts[file], megabytes << 20);
+        report("getline+stoi", fileNames[file], csv, parseWithStreams);
+        for (CsvScanLevel level : levels)
+        {
+            if (!setCsvScanLevel(level))
+            {
+                continue;
+            }
+            string path = string("tokenizer/") + getCsvScanLevelName(level);
+            report(path.c_str(), fileNames[file], csv, parseWithTokenizer);
+        }
+        setCsvScanLevel(bestLevel);
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include "global.h"
+#include "bloomFilter.h"
+
+/**
+ * @brief Allocates BLOOM_BITS_PER_KEY bits per expected key, rounded up to a
+ * power of two so a probe is a mask instead of a division.
+ *
+ * @param expectedKeys
+ */
+BloomFilter::BloomFilter(long long expectedKeys) : capacity(max(1LL, expectedKeys))
+{
+    uint64_t bitCount = 64;
+    while (bitCount < (uint64_t)this->capacity * BLOOM_BITS_PER_KEY)
+    {
+        bitCount <<= 1;
+    }
+    this->words.assign(bitCount / 64, 0);
+    this->bitMask = bitCount - 1;
+}
+
+/**
+ * @brief Starts filters on the given columns for a table with no pages.
+ *
+ * @param columnIndexes
+ */
+void PageBloomFilters::reset(const vector<int> &columnIndexes)
+{
+    this->columnIndexes = columnIndexes;
+    this->filters.assign(columnIndexes.size(), vector<BloomFilter>());
+}
+
+/**
+ * @brief Drops the filters of all pages but keeps the columns, before the
+ * pages are rewritten from the first one on.
+ */
+void PageBloomFilters::clearPages()
+{
+    this->reset(vector<int>(this->columnIndexes));
+}
+
+int PageBloomFilters::getSlot(int columnIndex) const
+{
+    for (size_t slot = 0; slot < this->columnIndexes.size(); slot++)
+    {
+        if (this->columnIndexes[slot] == columnIndex)
+        {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Gives pageIndex empty filters sized for expectedKeys, appending them
+ * if pageIndex is the next page.
+ *
+ * @param pageIndex
+ * @param expectedKeys
+ * @return false if there are no filtered columns or pageIndex would leave a gap
+ */
+bool PageBloomFilters::startPage(int pageIndex, long long expectedKeys)
+{
+    if (this->columnIndexes.empty() || pageIndex < 0 || pageIndex > this->getPageCount())
+    {
+        return false;
+    }
+    BloomFilter filter(max(expectedKeys, (long long)BLOOM_MIN_KEYS));
+    for (vector<BloomFilter> &pageFilters : this->filters)
+    {
+        if (pageIndex == (int)pageFilters.size())
+        {
+            pageFilters.push_back(filter);
+        }
+        else
+        {
+            pageFilters[pageIndex] = filter;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Builds the filters of pageIndex from all the rows of the page.
+ *
+ * @param pageIndex
+ * @param rows row-major
+ */
+void PageBloomFilters::setPage(int pageIndex, const RowBatch &rows)
+{
+    if (!this->startPage(pageIndex, rows.rowCount))
+    {
+        return;
+    }
+    for (size_t slot = 0; slot < this->columnIndexes.size(); slot++)
+    {
+        BloomFilter &filter = this->filters[slot][pageIndex];
+        const int *value = rows.data + this->columnIndexes[slot];
+        for (int rowCounter = 0; rowCounter < rows.rowCount; rowCounter++, value += rows.columnCount)
+        {
+            filter.add(*value);
+        }
+    }
+}
+
+/**
+ * @brief Rebuilds the filters of pageIndex from the page itself, after its
+ * rows were changed in place.
+ *
+ * @param pageIndex
+ * @param page
+ */
+void PageBloomFilters::setPage(int pageIndex, const Page &page)
+{
+    if (!this->startPage(pageIndex, page.getRowCount()))
+    {
+        return;
+    }
+    for (size_t slot = 0; slot < this->columnIndexes.size(); slot++)
+    {
+        BloomFilter &filter = this->filters[slot][pageIndex];
+        const int *column = page.getColumn(this->columnIndexes[slot]);
+        for (long long rowCounter = 0; column != nullptr && rowCounter < page.getRowCount(); rowCounter++)
+        {
+            filter.add(column[rowCounter]);
+        }
+    }
+}
+
+/**
+ * @brief Adds the keys of a row appended to pageIndex, which may be a new
+ * page right after the last one.
+ *
+ * @param pageIndex
+ * @param row
+ */
+void PageBloomFilters::addRow(int pageIndex, const RowView &row)
+{
+    if (pageIndex == this->getPageCount() && !this->startPage(pageIndex, 0))
+    {
+        return;
+    }
+    if (pageIndex < 0 || pageIndex >= this->getPageCount())
+    {
+        return;
+    }
+    for (size_t slot = 0; slot < this->columnIndexes.size(); slot++)
+    {
+        if (this->columnIndexes[slot] < row.size())
+        {
+            this->filters[slot][pageIndex].add(row[this->columnIndexes[slot]]);
+        }
+    }
+}
+
+/**
+ * @brief Whether the filters of pageIndex have taken so many more keys than
+ * they were sized for that they should be rebuilt from the page.
+ *
+ * @param pageIndex
+ */
+bool PageBloomFilters::isOverloaded(int pageIndex) const
+{
+    return pageIndex >= 0 && pageIndex < this->getPageCount() && this->filters[0][pageIndex].isOverloaded();
+}
+
+/**
+ * @brief Whether page pageIndex may hold key in the column.
+ *
+ * @return false only if the page definitely does not hold it
+ */
+bool PageBloomFilters::mayContain(int pageIndex, int columnIndex, int key) const
+{
+    int slot = this->getSlot(columnIndex);
+    if (slot < 0 || pageIndex < 0 || pageIndex >= (int)this->filters[slot].size())
+    {
+        return true;
+    }
+    return this->filters[slot][pageIndex].mayContain(key);
+}
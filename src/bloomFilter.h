@@ -0,0 +1,113 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include "cursor.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// DO NOT USE "using namespace std;" in header files
+
+const int BLOOM_BITS_PER_KEY = 10; // about 1% false positives at capacity
+const int BLOOM_HASH_COUNT = 7;
+const int BLOOM_MIN_KEYS = 1024;   // smallest capacity, so short pages can grow by INSERT
+
+/**
+ * @brief Bloom filter over int keys: mayContain is false only for keys that
+ * were never added. Sized for a number of keys; adding more only raises the
+ * false positive rate, and isOverloaded() tells when it is worth rebuilding.
+ */
+class BloomFilter
+{
+    std::vector<uint64_t> words;
+    uint64_t bitMask = 0;
+    long long capacity = 0;
+    long long keyCount = 0;
+
+    static uint64_t hash(int key)
+    {
+        // splitmix64 finaliser, as in HyperLogLog
+        uint64_t hash = (uint64_t)(uint32_t)key + 0x9e3779b97f4a7c15ULL;
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+        return hash ^ (hash >> 31);
+    }
+
+public:
+    BloomFilter() {}
+    explicit BloomFilter(long long expectedKeys);
+
+    void add(int key)
+    {
+        if (this->words.empty())
+        {
+            return;
+        }
+        // Double hashing: probe i is h1 + i * h2
+        uint64_t keyHash = hash(key);
+        uint64_t probe = keyHash & 0xffffffffULL;
+        uint64_t step = (keyHash >> 32) | 1;
+        for (int hashCounter = 0; hashCounter < BLOOM_HASH_COUNT; hashCounter++, probe += step)
+        {
+            uint64_t bit = probe & this->bitMask;
+            this->words[bit >> 6] |= (uint64_t)1 << (bit & 63);
+        }
+        this->keyCount++;
+    }
+    bool mayContain(int key) const
+    {
+        if (this->words.empty())
+        {
+            return true;
+        }
+        uint64_t keyHash = hash(key);
+        uint64_t probe = keyHash & 0xffffffffULL;
+        uint64_t step = (keyHash >> 32) | 1;
+        for (int hashCounter = 0; hashCounter < BLOOM_HASH_COUNT; hashCounter++, probe += step)
+        {
+            uint64_t bit = probe & this->bitMask;
+            if ((this->words[bit >> 6] & ((uint64_t)1 << (bit & 63))) == 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool isOverloaded() const { return this->keyCount > 2 * this->capacity; }
+    size_t getByteCount() const { return this->words.size() * sizeof(uint64_t); }
+};
+
+/**
+ * @brief Optional per-page Bloom filters on chosen columns of a table, so an
+ * equality condition or a join probe can skip pages that cannot hold the
+ * key. Built by BloomFilterSink during LOAD and kept up to date by the
+ * commands that change pages in place.
+ *
+ * Like ZoneMap, a filter may hold more keys than its page (values since
+ * updated or deleted) but never fewer. Pages past getPageCount() and columns
+ * without filters may always hold the key.
+ */
+class PageBloomFilters
+{
+    std::vector<int> columnIndexes;
+    std::vector<std::vector<BloomFilter>> filters; // [column slot][page]
+
+    int getSlot(int columnIndex) const;
+    bool startPage(int pageIndex, long long expectedKeys);
+
+public:
+    void reset(const std::vector<int> &columnIndexes);
+    void clearPages();
+
+    const std::vector<int> &getColumnIndexes() const { return this->columnIndexes; }
+    bool hasColumn(int columnIndex) const { return this->getSlot(columnIndex) >= 0; }
+    int getPageCount() const { return this->filters.empty() ? 0 : this->filters[0].size(); }
+
+    void setPage(int pageIndex, const RowBatch &rows);
+    void setPage(int pageIndex, const Page &page);
+    void addRow(int pageIndex, const RowView &row);
+    bool isOverloaded(int pageIndex) const;
+    bool mayContain(int pageIndex, int columnIndex, int key) const;
+};
+
+#endif // BLOOMFILTER_H
@@ -5,12 +5,13 @@
 #include "table.h"          // Include the full Table definition
 #include <string>
 #include <vector>
-#include <deque>     // Use deque for efficient front removal
+#include <deque>     // Frames live in a deque so references to them stay valid
 #include <algorithm> // For std::find_if, std::remove_if
 #include <iostream>  // For cerr
 #include <fstream>   // For file operations
 #include <sstream>   // For stringstream
 #include <cstdio>    // For remove()
+#include <unistd.h>  // For sysconf()
 
 using namespace std; // Make std namespace accessible
 
@@ -19,174 +20,454 @@ BufferManager::BufferManager()
     logger.log("BufferManager::BufferManager");
     // Initialize buffer size based on global BLOCK_COUNT
     this->maxSize = BLOCK_COUNT; // Initialize maxSize
+    this->policy.reset(createReplacementPolicy(DEFAULT_REPLACEMENT_POLICY));
+    this->policy->setCapacity(this->maxSize);
 }
 
 /**
- * @brief Function called to read a page from the buffer manager. If the page is
- * not present in the pool, the page is read and then inserted into the pool.
- * Uses LRU eviction policy.
+ * @brief Switches the replacement policy. Resident pages are handed to the new
+ * policy as if they had just been loaded, and the hit/miss counters start
+ * from zero.
+ *
+ * @param policyName LRU, CLOCK or 2Q
+ * @return true if the policy was changed
+ * @return false if the name is unknown
+ */
+bool BufferManager::setReplacementPolicy(const string &policyName)
+{
+    logger.log("BufferManager::setReplacementPolicy");
+    ReplacementPolicy *newPolicy = createReplacementPolicy(policyName);
+    if (newPolicy == nullptr)
+    {
+        cerr << "BufferManager::setReplacementPolicy ERROR: Unknown replacement policy " << policyName << ". Use LRU, CLOCK or 2Q." << endl;
+        return false;
+    }
+    this->policy.reset(newPolicy);
+    this->policy->setCapacity(this->maxSize);
+    for (int frameIndex = 0; frameIndex < (int)this->frames.size(); frameIndex++)
+    {
+        if (this->frames[frameIndex].occupied)
+        {
+            this->policy->recordInsert(frameIndex, this->frames[frameIndex].key);
+        }
+    }
+    logger.log("BufferManager::setReplacementPolicy: Using " + this->policy->getName() + ".");
+    return true;
+}
+
+/**
+ * @brief Returns the compact id of a table, assigning the next free one the
+ * first time a table name is seen. Ids are keyed by name and never cleared,
+ * so a dropped and re-created table gets the same id again; its old frames
+ * and queued read-ahead must be gone by then, which is why dropping a table
+ * goes through discardTablePages (and Prefetcher::cancelTable).
+ *
+ * @param tableName
+ * @return uint32_t
+ */
+uint32_t BufferManager::getTableId(const string &tableName)
+{
+    auto it = this->tableIds.find(tableName);
+    if (it != this->tableIds.end())
+    {
+        return it->second;
+    }
+    uint32_t tableId = this->tableIds.size();
+    this->tableIds.emplace(tableName, tableId);
+    return tableId;
+}
+
+/**
+ * @brief Builds the frame table key of a page: the table id in the high 32
+ * bits and the page index in the low 32 bits.
  *
  * @param tableName
  * @param pageIndex
- * @return Page
+ * @return uint64_t
  */
-Page BufferManager::getPage(const string &tableName, int pageIndex) // Use const& for string
+uint64_t BufferManager::pageKey(const string &tableName, int pageIndex)
 {
-    logger.log("BufferManager::getPage");
-    // Use to_string for converting int pageIndex
-    string pageName = "../data/temp/" + tableName + "_Page" + to_string(pageIndex);
+    return ((uint64_t)this->getTableId(tableName) << 32) | (uint32_t)pageIndex;
+}
+
+/**
+ * @brief Looks a page up in the frame table.
+ *
+ * @param tableName
+ * @param pageIndex
+ * @return int index of the frame holding the page, -1 if it is not resident
+ */
+int BufferManager::findFrame(const string &tableName, int pageIndex)
+{
+    auto it = this->frameTable.find(this->pageKey(tableName, pageIndex));
+    return it == this->frameTable.end() ? -1 : it->second;
+}
 
-    // Check if page is already in the buffer pool using its name
-    auto it = find_if(pages.begin(), pages.end(),
-                      [&](const Page &p)
-                      { return p.getPageName() == pageName; }); // Use getter
+/**
+ * @brief Asks the replacement policy for an unpinned resident frame to evict.
+ *
+ * @return int frame index, -1 if every resident frame is pinned
+ */
+int BufferManager::findVictim()
+{
+    return this->policy->chooseVictim([this](int frameIndex) {
+        const Frame &frame = this->frames[frameIndex];
+        return frame.occupied && frame.pinCount == 0;
+    });
+}
 
-    if (it != pages.end())
+/**
+ * @brief Finds a frame for a page that is about to be loaded. While the pool
+ * has room a free frame is reused; once it is full the victim chosen by the
+ * replacement policy is evicted. If every frame is pinned the pool temporarily
+ * grows by one frame, which is given back as soon as it is unpinned.
+ *
+ * @return int index of an empty, unpinned frame
+ */
+int BufferManager::allocateFrame()
+{
+    if (this->residentCount >= this->maxSize)
     {
-        // Page found in buffer, move it to the back (most recently used)
-        Page foundPage = *it;
-        pages.erase(it);
-        pages.push_back(foundPage);
-        logger.log("BufferManager::getPage: Page " + pageName + " found in buffer.");
-        return foundPage;
+        int victim = this->findVictim();
+        if (victim != -1)
+        {
+            logger.log("BufferManager::allocateFrame: Buffer full. Evicting page " + this->frames[victim].page.getPageName());
+            this->evictFrame(victim);
+            return victim;
+        }
+        logger.log("BufferManager::allocateFrame: All frames pinned. Growing pool past " + to_string(this->maxSize) + " frames.");
     }
-    else
+    for (int frameIndex = 0; frameIndex < (int)this->frames.size(); frameIndex++)
     {
-        // Page not in buffer, need to load it
-        logger.log("BufferManager::getPage: Page " + pageName + " not in buffer. Loading.");
-        Page newPage(tableName, pageIndex); // Load the page
-
-        // Check if the loaded page is valid (e.g., file existed, read successful)
-        // A pageIndex of -1 often indicates an error during loading in the Page constructor
-        if (newPage.pageIndex == -1) // Accessing public member pageIndex
+        if (!this->frames[frameIndex].occupied && this->frames[frameIndex].pinCount == 0)
         {
-            logger.log("BufferManager::getPage: Failed to load page " + pageName + ". Returning empty page.");
-            cerr << "BufferManager::getPage: Failed to load page " + pageName + "." << endl;
-            return Page(); // Return a default/empty page to indicate failure
+            return frameIndex;
         }
+    }
+    this->frames.emplace_back();
+    return this->frames.size() - 1;
+}
 
-        // Check if buffer is full before inserting
-        if (pages.size() >= this->maxSize) // Use this->maxSize
+/**
+ * @brief Changes the number of frames in the pool (see
+ * MemoryManager::setBudget). Shrinking evicts unpinned pages in the order the
+ * replacement policy chooses them;
+ * pinned ones are evicted as they are unpinned.
+ *
+ * @param frameCount
+ */
+void BufferManager::setCapacity(size_t frameCount)
+{
+    logger.log("BufferManager::setCapacity");
+    this->maxSize = max((size_t)1, frameCount);
+    this->policy->setCapacity(this->maxSize);
+    while (this->residentCount > this->maxSize)
+    {
+        int victim = this->findVictim();
+        if (victim == -1)
         {
-            // Buffer is full, evict the least recently used page (at the front)
-            Page &evictedPage = pages.front();
-            logger.log("BufferManager::getPage: Buffer full. Evicting page " + evictedPage.getPageName()); // Use getter
-            // Write the evicted page back to disk if it has been modified (implement modification tracking if needed)
-            // For now, we assume pages might need writing back. A 'dirty bit' would optimize this.
-            evictedPage.writePage();
-            pages.pop_front(); // Remove from the front (deque is efficient here)
+            break;
         }
-
-        // Insert the newly loaded page at the back (most recently used)
-        pages.push_back(newPage);
-        logger.log("BufferManager::getPage: Page " + pageName + " loaded and added to buffer.");
-        return newPage;
+        this->evictFrame(victim);
     }
+    logger.log("BufferManager::setCapacity: Pool now holds up to " + to_string(this->maxSize) + " pages.");
 }
 
 /**
- * @brief Checks to see if a page exists in the pool
+ * @brief Removes the page held by a frame from the pool, writing it back to
+ * disk first if it is dirty. Clean pages are simply dropped.
  *
- * @param pageName
- * @return true
- * @return false
+ * @param frameIndex
  */
-bool BufferManager::inPool(const string &pageName) // Use const&
+void BufferManager::evictFrame(int frameIndex)
 {
-    logger.log("BufferManager::inPool");
-    // Use find_if with the getter method
-    auto it = find_if(pages.begin(), pages.end(),
-                      [&](const Page &p)
-                      { return p.getPageName() == pageName; }); // Use getter
-    return it != pages.end();
+    Frame &frame = this->frames[frameIndex];
+    if (frame.dirty)
+    {
+        frame.page.writePage();
+    }
+    this->policy->evictions++;
+    this->dropFrame(frameIndex, true);
 }
 
 /**
- * @brief Find a specific page in the buffer pool by its name.
- * Returns a pointer to the page if found, otherwise nullptr.
- * This allows modifying the page in the buffer directly.
+ * @brief Removes the page held by a frame from the frame table without
+ * writing it. A pinned frame keeps its page alive for the handles that still
+ * reference it and is recycled once the last of them is released.
  *
- * @param pageName
- * @return Page*
+ * @param frameIndex
+ * @param evicted true when the page may be requested again (an eviction),
+ * false when it was deleted or discarded
  */
-Page *BufferManager::findPage(const string &pageName) // Use const&
+void BufferManager::dropFrame(int frameIndex, bool evicted)
+{
+    Frame &frame = this->frames[frameIndex];
+    if (!frame.occupied)
+    {
+        return;
+    }
+    this->frameTable.erase(frame.key);
+    this->policy->recordRemove(frameIndex, frame.key, evicted);
+    frame.occupied = false;
+    frame.dirty = false;
+    this->residentCount--;
+    if (frame.pinCount == 0)
+    {
+        frame.page = Page();
+    }
+}
+
+void BufferManager::pin(int frameIndex)
 {
-    logger.log("BufferManager::findPage");
-    auto it = find_if(pages.begin(), pages.end(),
-                      [&](const Page &p)
-                      { return p.getPageName() == pageName; }); // Use getter
+    Frame &frame = this->frames[frameIndex];
+    frame.pinCount++;
+}
 
-    if (it != pages.end())
+void BufferManager::unpin(int frameIndex)
+{
+    Frame &frame = this->frames[frameIndex];
+    if (--frame.pinCount > 0)
+    {
+        return;
+    }
+    if (!frame.occupied)
+    {
+        frame.page = Page();
+    }
+    else if (this->residentCount > this->maxSize)
     {
-        // Return pointer to the found page
-        return &(*it);
+        // The pool grew while every frame was pinned; shrink back
+        this->evictFrame(frameIndex);
     }
-    return nullptr; // Page not found
 }
 
 /**
- * @brief Inserts page into the pool. Handles eviction if necessary.
- * Replaces existing page with the same name.
+ * @brief Sets how many pages are read ahead of a sequential scan. Zero turns
+ * read-ahead off.
+ *
+ * @param depth
+ */
+void BufferManager::setPrefetchDepth(size_t depth)
+{
+    logger.log("BufferManager::setPrefetchDepth");
+    this->prefetchDepth = depth;
+    // Room for the window being consumed plus the one being read
+    this->prefetcher.setMaxPages(depth * 2);
+}
+
+/**
+ * @brief Chooses how pages are loaded into the pool: memory-mapped and read
+ * in place, or read into a private buffer. Only affects pages loaded from
+ * now on.
+ *
+ * @param enabled
+ */
+void BufferManager::setMappedReads(bool enabled)
+{
+    logger.log("BufferManager::setMappedReads");
+    this->mappedReads = enabled;
+    this->advisedUpTo.clear();
+}
+
+/**
+ * @brief Chooses whether pages are compressed when written. Pages already on
+ * disk keep their format; both formats can always be read.
+ *
+ * @param enabled
+ */
+void BufferManager::setPageCompression(bool enabled)
+{
+    logger.log("BufferManager::setPageCompression");
+    this->pageCompression = enabled;
+}
+
+/**
+ * @brief Counts a page written to disk, for LIST BUFFER.
+ *
+ * @param rawBytes size of the page's rows uncompressed
+ * @param storedBytes size actually written
+ */
+void BufferManager::recordPageWrite(size_t rawBytes, size_t storedBytes)
+{
+    this->pagesWritten++;
+    this->rawBytesWritten += rawBytes;
+    this->storedBytesWritten += storedBytes;
+}
+
+/**
+ * @brief Detects sequential access: when page pageIndex of a table follows
+ * the page requested just before it, the next prefetchDepth pages that are
+ * not resident are scheduled on the prefetch thread. With mapped reads the
+ * pages' segment slots are instead handed to the kernel's read-ahead, each
+ * only once.
  *
- * @param page The page object to insert (passed by reference, will be copied into deque).
+ * @param tableName
+ * @param pageIndex
  */
-void BufferManager::insertIntoPool(Page &page) // Pass by reference
+void BufferManager::readAhead(const string &tableName, int pageIndex)
 {
-    logger.log("BufferManager::insertIntoPool");
-    string pageName = page.getPageName(); // Get page name using getter
+    uint32_t tableId = this->getTableId(tableName);
+    auto last = this->lastPageRequested.find(tableId);
+    bool sequential = last != this->lastPageRequested.end() && pageIndex == last->second + 1;
+    this->lastPageRequested[tableId] = pageIndex;
+    if (!sequential || this->prefetchDepth == 0)
+    {
+        return;
+    }
+    shared_ptr<const TableDescriptor> table = tableCatalogue.getDescriptor(tableName);
+    if (table == nullptr)
+    {
+        return;
+    }
+    shared_ptr<SegmentFile> segment = this->findSegment(tableName);
+    if (segment == nullptr)
+    {
+        return;
+    }
+    int lastPageIndex = min((long long)table->blockCount, (long long)pageIndex + 1 + (long long)this->prefetchDepth);
+    int firstPageIndex = pageIndex + 1;
+    if (this->mappedReads)
+    {
+        auto advised = this->advisedUpTo.find(tableId);
+        if (advised != this->advisedUpTo.end() && advised->second >= pageIndex)
+        {
+            firstPageIndex = max(firstPageIndex, advised->second + 1);
+        }
+        for (int nextPageIndex = firstPageIndex; nextPageIndex < lastPageIndex; nextPageIndex++)
+        {
+            Page::adviseWillNeed(segment->locate(nextPageIndex));
+        }
+        this->advisedUpTo[tableId] = lastPageIndex - 1;
+        return;
+    }
+    for (int nextPageIndex = firstPageIndex; nextPageIndex < lastPageIndex; nextPageIndex++)
+    {
+        if (table->getRowCount(nextPageIndex) == 0 || this->findFrame(tableName, nextPageIndex) != -1)
+        {
+            continue;
+        }
+        this->prefetcher.schedule(this->pageKey(tableName, nextPageIndex), Page::getPageName(tableName, nextPageIndex), segment, nextPageIndex, table->columnCount, table->layout);
+    }
+}
 
-    // First, check if a page with the same name already exists.
-    auto it = find_if(pages.begin(), pages.end(),
-                      [&](const Page &p)
-                      { return p.getPageName() == pageName; }); // Use getter
+/**
+ * @brief Function called to read a page from the buffer manager. If the page is
+ * not present in the pool, the page is read and then inserted into the pool.
+ * The page is returned pinned: it stays in its frame, and may be read or
+ * modified in place, until the returned handle is released or destroyed.
+ * Pages that were read ahead are taken from the prefetcher instead of disk.
+ *
+ * @param tableName
+ * @param pageIndex
+ * @return PageHandle invalid handle if the page could not be loaded
+ */
+PageHandle BufferManager::getPage(const string &tableName, int pageIndex) // Use const& for string
+{
+    logger.log("BufferManager::getPage");
+    this->readAhead(tableName, pageIndex);
+    int frameIndex = this->findFrame(tableName, pageIndex);
+    if (frameIndex != -1)
+    {
+        logger.log("BufferManager::getPage: Page " + to_string(pageIndex) + " of " + tableName + " found in buffer.");
+        this->policy->hits++;
+        this->policy->recordAccess(frameIndex);
+        return PageHandle(this, frameIndex);
+    }
 
-    if (it != pages.end())
+    // Page not in buffer, need to load it
+    logger.log("BufferManager::getPage: Page " + to_string(pageIndex) + " of " + tableName + " not in buffer. Loading.");
+    this->policy->misses++;
+    Page newPage;
+    int columnCount = 0;
+    PageLayout layout = ROW_LAYOUT;
+    vector<int> prefetchedData;
+    long long int prefetchedRowCount = 0;
+    if (this->prefetcher.take(this->pageKey(tableName, pageIndex), columnCount, layout, prefetchedData, prefetchedRowCount))
+    {
+        logger.log("BufferManager::getPage: Page " + to_string(pageIndex) + " of " + tableName + " was read ahead.");
+        newPage = Page(tableName, pageIndex, columnCount, layout, std::move(prefetchedData), prefetchedRowCount);
+    }
+    else
     {
-        // Page already exists. Remove the old one.
-        logger.log("BufferManager::insertIntoPool: Page " + pageName + " already exists. Replacing.");
-        // Optionally write back the old page if it was modified
-        // it->writePage(); // Uncomment if modification tracking is added
-        pages.erase(it);
+        newPage = Page(tableName, pageIndex, this->mappedReads); // Load the page
     }
 
-    // Check if buffer is full before inserting
-    if (pages.size() >= this->maxSize) // Use this->maxSize
+    // A pageIndex of -1 indicates an error during loading in the Page constructor
+    if (newPage.pageIndex == -1) // Accessing public member pageIndex
     {
-        // Buffer is full, evict the least recently used page (at the front)
-        Page &evictedPage = pages.front();
-        logger.log("BufferManager::insertIntoPool: Buffer full. Evicting page " + evictedPage.getPageName()); // Use getter
-        // Write the evicted page back to disk if it has been modified
-        // evictedPage.writePage(); // Uncomment if modification tracking is added
-        pages.pop_front(); // Remove from the front
+        logger.log("BufferManager::getPage: Failed to load page " + to_string(pageIndex) + " of " + tableName + ". Returning invalid handle.");
+        cerr << "BufferManager::getPage: Failed to load page " << pageIndex << " of " << tableName << "." << endl;
+        return PageHandle();
     }
 
-    // Insert the new page at the back (most recently used)
-    pages.push_back(page); // deque stores copies
-    logger.log("BufferManager::insertIntoPool: Page " + pageName + " inserted.");
+    frameIndex = this->allocateFrame();
+    Frame &frame = this->frames[frameIndex];
+    frame.page = std::move(newPage);
+    frame.key = this->pageKey(tableName, pageIndex);
+    frame.occupied = true;
+    this->frameTable[frame.key] = frameIndex;
+    this->residentCount++;
+    this->policy->recordInsert(frameIndex, frame.key);
+    logger.log("BufferManager::getPage: Page loaded into frame " + to_string(frameIndex) + ".");
+    return PageHandle(this, frameIndex);
 }
 
 /**
- * @brief Writes all pages present in the pool buffer to disk.
+ * @brief Checks to see if a page exists in the pool
+ *
+ * @param tableName
+ * @param pageIndex
+ * @return true
+ * @return false
+ */
+bool BufferManager::inPool(const string &tableName, int pageIndex)
+{
+    logger.log("BufferManager::inPool");
+    return this->findFrame(tableName, pageIndex) != -1;
+}
+
+/**
+ * @brief Writes all dirty pages present in the pool buffer to disk. The pages
+ * stay in the pool, now clean.
  *        Useful for saving state before exiting or during checkpoints.
  */
 void BufferManager::writeAllPages()
 {
     logger.log("BufferManager::writeAllPages");
-    logger.log("Writing " + to_string(pages.size()) + " pages to disk.");
-    for (Page &page : pages) // Iterate by reference to call writePage()
+    int writtenCount = 0;
+    for (Frame &frame : this->frames)
     {
-        // Check if the page has a valid name/index before writing
-        if (!page.getPageName().empty() && page.pageIndex >= 0) // Access public member
+        if (frame.occupied && frame.dirty)
         {
-            // logger.log("Writing page: " + page.getPageName()); // Can be verbose
-            page.writePage();
+            frame.page.writePage();
+            frame.dirty = false;
+            writtenCount++;
         }
-        else
+    }
+    logger.log("BufferManager::writeAllPages: Wrote " + to_string(writtenCount) + " dirty pages to disk.");
+}
+
+/**
+ * @brief Writes the dirty pages of one table back to disk. The pages stay in
+ * the pool, now clean.
+ *
+ * @param tableName
+ */
+void BufferManager::flushTable(const string &tableName)
+{
+    logger.log("BufferManager::flushTable");
+    uint32_t tableId = this->getTableId(tableName);
+    int writtenCount = 0;
+    for (Frame &frame : this->frames)
+    {
+        if (frame.occupied && frame.dirty && (frame.key >> 32) == tableId)
         {
-            logger.log("BufferManager::writeAllPages: Skipping write for invalid/empty page.");
+            frame.page.writePage();
+            frame.dirty = false;
+            writtenCount++;
         }
     }
-    logger.log("BufferManager::writeAllPages: Finished writing all pages.");
+    logger.log("BufferManager::flushTable: Wrote " + to_string(writtenCount) + " dirty pages of " + tableName + ".");
 }
 
 /**
@@ -198,18 +479,14 @@ void BufferManager::writeAllPages()
 void BufferManager::deletePage(const string &tableName, int pageIndex) // Use const&
 {
     logger.log("BufferManager::deletePage");
-    // Use to_string for int pageIndex
-    string pageName = "../data/temp/" + tableName + "_Page" + to_string(pageIndex);
+    string pageName = Page::getPageName(tableName, pageIndex);
 
+    this->prefetcher.cancel(this->pageKey(tableName, pageIndex));
     // Remove the page from the buffer pool if it exists
-    // Use erase-remove idiom
-    auto it = remove_if(pages.begin(), pages.end(),
-                        [&](const Page &p)
-                        { return p.getPageName() == pageName; }); // Use getter
-
-    if (it != pages.end())
+    int frameIndex = this->findFrame(tableName, pageIndex);
+    if (frameIndex != -1)
     {
-        pages.erase(it, pages.end()); // Erase the removed elements
+        this->dropFrame(frameIndex);
         logger.log("BufferManager::deletePage: Page " + pageName + " removed from buffer.");
     }
     else
@@ -217,93 +494,262 @@ void BufferManager::deletePage(const string &tableName, int pageIndex) // Use co
         logger.log("BufferManager::deletePage: Page " + pageName + " not found in buffer.");
     }
 
-    // Delete the corresponding file from disk
-    if (remove(pageName.c_str()) != 0)
+    // Free the page's slot in the table's segment file
+    shared_ptr<SegmentFile> segment = this->findSegment(tableName);
+    if (segment == nullptr || segment->getPageBytes(pageIndex) == 0)
     {
-        // Log an error if the file couldn't be deleted (it might not exist, which is okay)
-        // Use perror for system errors
-        // perror(("BufferManager::deletePage: Error deleting file " + pageName).c_str());
-        logger.log("BufferManager::deletePage: Error deleting file " + pageName + ". It might not exist or permissions issue.");
+        // The page might never have been written, which is okay
+        logger.log("BufferManager::deletePage: Page " + pageName + " is not on disk.");
     }
     else
     {
-        logger.log("BufferManager::deletePage: File " + pageName + " deleted from disk.");
+        segment->removePage(pageIndex);
+        logger.log("BufferManager::deletePage: Page " + pageName + " deleted from disk.");
     }
 }
 
 /**
- * @brief Deletes all pages associated with a table from the buffer pool and disk.
+ * @brief Deletes all pages associated with a table from the buffer pool and
+ * disk. The pages share one segment file, so this removes a single file
+ * however large the table is.
  *
  * @param tableName
  */
 void BufferManager::deleteTablePages(const string &tableName) // Use const&
 {
     logger.log("BufferManager::deleteTablePages for table: " + tableName);
-    string prefix = "../data/temp/" + tableName + "_Page";
 
-    // Iterate through the buffer and remove pages belonging to the table
-    // Using remove_if and erase idiom
-    auto new_end = remove_if(pages.begin(), pages.end(),
-                             [&](const Page &p)
-                             {
-                                 // Check if the page name starts with the table's page prefix
-                                 return p.getPageName().rfind(prefix, 0) == 0; // Use getter
-                             });
+    // The file is going away, so pending changes are dropped rather than written
+    this->discardTablePages(tableName);
+    this->deleteSegment(tableName);
+}
 
-    int removedCount = distance(new_end, pages.end());
-    if (new_end != pages.end())
+/**
+ * @brief Returns the open segment file of a table, creating it on the first
+ * write. Slots are large enough for a full block plus the page header,
+ * rounded up to the OS page size so every slot can be mapped. A table whose
+ * rows are wider than a block gets slots that fit the first page written.
+ *
+ * @param tableName
+ * @param pageBytes size of the page about to be written, if any
+ * @return shared_ptr<SegmentFile> nullptr if the file cannot be created
+ */
+shared_ptr<SegmentFile> BufferManager::getSegment(const string &tableName, size_t pageBytes)
+{
+    shared_ptr<SegmentFile> segment = this->findSegment(tableName);
+    if (segment != nullptr)
     {
-        pages.erase(new_end, pages.end()); // Erase the removed elements
+        return segment;
     }
+    return this->createSegment(tableName, max(sizeof(PageHeader) + (size_t)BLOCK_SIZE * 1000, pageBytes));
+}
 
-    if (removedCount > 0)
+/**
+ * @brief Creates an empty segment file for a relation whose pages are not
+ * table blocks, such as the nodes of an index, with slots of slotBytes
+ * rounded up to the OS page size. Replaces any open segment of that name.
+ *
+ * @param tableName
+ * @param slotBytes largest page (header included) the segment must hold
+ * @return shared_ptr<SegmentFile> nullptr if the file cannot be created
+ */
+shared_ptr<SegmentFile> BufferManager::createSegment(const string &tableName, size_t slotBytes)
+{
+    size_t osPageSize = sysconf(_SC_PAGESIZE);
+    slotBytes = (slotBytes + osPageSize - 1) / osPageSize * osPageSize;
+    shared_ptr<SegmentFile> segment = make_shared<SegmentFile>("../data/temp/" + tableName + ".seg", slotBytes);
+    if (!segment->isOpen())
     {
-        logger.log("BufferManager::deleteTablePages: Removed " + to_string(removedCount) + " pages of table " + tableName + " from buffer.");
+        cerr << "BufferManager::createSegment ERROR: Cannot create segment file " << segment->getFileName() << endl;
+        return nullptr;
     }
-    else
+    logger.log("BufferManager::createSegment: Created " + segment->getFileName() + " with " + to_string(slotBytes) + " byte slots.");
+    this->segments[tableName] = segment;
+    return segment;
+}
+
+/**
+ * @brief Returns the open segment file of a table without creating it.
+ *
+ * @param tableName
+ * @return shared_ptr<SegmentFile> nullptr if no page of the table was written
+ */
+shared_ptr<SegmentFile> BufferManager::findSegment(const string &tableName) const
+{
+    auto it = this->segments.find(tableName);
+    return it == this->segments.end() ? nullptr : it->second;
+}
+
+/**
+ * @brief Removes a table's segment file. Pages still mapped or being read
+ * ahead keep the file's contents alive until they let go of it; the next
+ * write to the table starts a new, empty segment.
+ *
+ * @param tableName
+ */
+void BufferManager::deleteSegment(const string &tableName)
+{
+    logger.log("BufferManager::deleteSegment");
+    auto it = this->segments.find(tableName);
+    if (it == this->segments.end())
+    {
+        return;
+    }
+    if (!it->second->removeFile())
     {
-        logger.log("BufferManager::deleteTablePages: No pages of table " + tableName + " found in buffer.");
+        logger.log("BufferManager::deleteSegment: Error deleting file " + it->second->getFileName() + ".");
     }
+    this->segments.erase(it);
+}
 
-    // Now, delete the actual files from disk. This requires knowing the page indices.
-    // We need information from the TableCatalogue or Table object itself.
-    Table *tablePtr = tableCatalogue.getTable(tableName); // Access global tableCatalogue
-    if (tablePtr != nullptr)
+/**
+ * @brief Deletes a file that is not a page, such as a table's temporary
+ * source CSV.
+ *
+ * @param fileName
+ */
+void BufferManager::deleteFile(const string &fileName)
+{
+    if (remove(fileName.c_str()) != 0)
     {
-        // Accessing blockCount requires the full definition of Table, included via table.h
-        int blockCount = tablePtr->blockCount;
-        logger.log("BufferManager::deleteTablePages: Deleting " + to_string(blockCount) + " files for table " + tableName + " from disk.");
-        for (int i = 0; i < blockCount; ++i)
-        {
-            string pageName = prefix + to_string(i);
-            if (remove(pageName.c_str()) != 0)
-            {
-                // Log error, but continue trying to delete other pages
-                // perror(("BufferManager::deleteTablePages: Error deleting file " + pageName).c_str());
-                logger.log("BufferManager::deleteTablePages: Error deleting file " + pageName + ". It might not exist.");
-            }
-            else
-            {
-                // logger.log("BufferManager::deleteTablePages: File " + pageName + " deleted from disk."); // Can be verbose
-            }
-        }
-        logger.log("BufferManager::deleteTablePages: Finished deleting files for table " + tableName + ".");
+        logger.log("BufferManager::deleteFile: Error deleting file " + fileName + ". It might not exist.");
     }
     else
     {
-        logger.log("BufferManager::deleteTablePages: Table " + tableName + " not found in catalogue. Cannot delete disk files systematically.");
-        // Optionally, could try listing files in temp dir and deleting based on pattern, but less safe.
+        logger.log("BufferManager::deleteFile: Deleted " + fileName);
     }
 }
 
-// Destructor: Write all pages back to disk before the BufferManager is destroyed.
+/**
+ * @brief Writes rows directly to the disk slot of tableName/pageIndex in the
+ * binary page format. Used by blockify and the data modification commands
+ * that build a page's contents outside the pool.
+ *
+ * @param tableName
+ * @param pageIndex
+ * @param rows
+ * @param rowCount number of leading entries of rows that belong to the page
+ * @param layout layout of the table
+ */
+void BufferManager::writePage(const string &tableName, int pageIndex, vector<vector<int>> rows, int rowCount, PageLayout layout)
+{
+    logger.log("BufferManager::writePage");
+    Page page(tableName, pageIndex, std::move(rows), rowCount, layout);
+    this->writePage(page);
+}
+
+/**
+ * @brief Writes a page that was modified in memory (e.g. through
+ * Page::setCell/appendRow) to disk. If the page is a copy of a resident page
+ * the pooled copy is refreshed so later getPage calls see the new contents;
+ * a page modified in place through a PageHandle is already the pooled copy.
+ *
+ * @param page
+ */
+void BufferManager::writePage(Page &page)
+{
+    logger.log("BufferManager::writePage");
+    this->prefetcher.cancel(this->pageKey(page.getTableName(), page.pageIndex));
+    page.writePage();
+
+    int frameIndex = this->findFrame(page.getTableName(), page.pageIndex);
+    if (frameIndex != -1)
+    {
+        if (&this->frames[frameIndex].page == &page)
+        {
+            this->frames[frameIndex].dirty = false;
+        }
+        else if (this->frames[frameIndex].pinCount > 0)
+        {
+            // The pooled copy is still in use; like dropFrame, leave it to its
+            // handles and reload the new contents on the next getPage
+            logger.log("BufferManager::writePage: " + page.getPageName() + " is pinned, dropping its frame");
+            this->dropFrame(frameIndex);
+        }
+        else
+        {
+            this->frames[frameIndex].page = page;
+            this->frames[frameIndex].dirty = false;
+        }
+    }
+}
+
+// Destructor: Write all dirty pages back to disk before the BufferManager is destroyed.
 BufferManager::~BufferManager()
 {
     logger.log("BufferManager::~BufferManager");
     writeAllPages();
-    // The deque 'pages' will be automatically cleared when the object goes out of scope.
 }
 
+PageHandle::PageHandle() : bufferManager(nullptr), frameIndex(-1) {}
+
+PageHandle::PageHandle(BufferManager *bufferManager, int frameIndex) : bufferManager(bufferManager), frameIndex(frameIndex)
+{
+    this->bufferManager->pin(frameIndex);
+}
+
+PageHandle::PageHandle(const PageHandle &other) : bufferManager(other.bufferManager), frameIndex(other.frameIndex)
+{
+    if (this->isValid())
+    {
+        this->bufferManager->pin(this->frameIndex);
+    }
+}
+
+PageHandle::PageHandle(PageHandle &&other) : bufferManager(other.bufferManager), frameIndex(other.frameIndex)
+{
+    other.bufferManager = nullptr;
+    other.frameIndex = -1;
+}
+
+PageHandle &PageHandle::operator=(PageHandle other)
+{
+    swap(this->bufferManager, other.bufferManager);
+    swap(this->frameIndex, other.frameIndex);
+    return *this;
+}
+
+PageHandle::~PageHandle()
+{
+    this->release();
+}
+
+/**
+ * @brief Unpins the frame early. The handle is invalid afterwards.
+ *
+ */
+void PageHandle::release()
+{
+    if (this->isValid())
+    {
+        this->bufferManager->unpin(this->frameIndex);
+        this->bufferManager = nullptr;
+        this->frameIndex = -1;
+    }
+}
+
+/**
+ * @brief Gives write access to the pinned page and marks its frame dirty, so
+ * the change is written back when the page is evicted or flushed.
+ *
+ * @return Page&
+ */
+Page &PageHandle::modify() const
+{
+    BufferManager::Frame &frame = this->bufferManager->frames[this->frameIndex];
+    frame.dirty = true;
+    return frame.page;
+}
+
+const Page &PageHandle::operator*() const
+{
+    return this->bufferManager->frames[this->frameIndex].page;
+}
+
+const Page *PageHandle::operator->() const
+{
+    return &this->bufferManager->frames[this->frameIndex].page;
+}
 // --- Matrix Functions ---
 // These seem less related to generic page buffering and more to matrix data handling.
 // They operate directly on files named differently (_Block_ vs _Page).
@@ -534,72 +980,47 @@ void BufferManager::writeBlock(const string &matrixName, int pageIndex, const ve
 }
 
 /**
- * @brief Writes a serialized index page (vector<int>) directly to a file.
- * This bypasses the standard Page object abstraction and is intended specifically
- * for index structures that manage their own serialization format.
+ * @brief Removes all pages belonging to a specific table from the buffer pool,
+ * writing dirty ones back first. Does NOT delete files from disk. Useful when
+ * the table's pages are about to be rewritten outside the pool.
  *
- * @param pageName The full path and name of the index page file.
- * @param pageData The vector of integers representing the serialized node data.
+ * @param tableName The name of the table whose pages should be cleared from the buffer.
  */
-void BufferManager::writeIndexPage(const string &pageName, const vector<int> &pageData)
+void BufferManager::clearPoolForTable(const string &tableName) // Use const&
 {
-    logger.log("BufferManager::writeIndexPage writing to " + pageName);
-    ofstream fout(pageName, ios::trunc | ios::out); // Overwrite existing file
-    if (!fout)
-    {
-        logger.log("BufferManager::writeIndexPage ERROR: Cannot open file for writing: " + pageName);
-        cerr << "BufferManager::writeIndexPage ERROR: Cannot open file for writing: " << pageName << endl;
-        // Consider throwing an exception if this failure is critical
-        return;
-    }
-
-    // Write the integers to the file, space-separated, one line per page (or handle formatting as needed)
-    // Assuming the entire vector<int> represents the page content.
-    // A simple approach is to write all ints on one line, though this might differ
-    // from how regular data pages are formatted. Adjust if needed.
-    for (size_t i = 0; i < pageData.size(); ++i)
-    {
-        if (i != 0)
-            fout << " ";
-        fout << pageData[i];
-    }
-    fout << endl; // Add a newline at the end
-
-    fout.close();
-    if (!fout.good())
-    {
-        logger.log("BufferManager::writeIndexPage ERROR: Error occurred during writing or closing file " + pageName);
-        cerr << "BufferManager::writeIndexPage ERROR: Error occurred during writing or closing file " + pageName << endl;
-        // Consider throwing an exception
-    }
+    logger.log("BufferManager::clearPoolForTable");
+    this->flushTable(tableName);
+    this->discardTablePages(tableName);
 }
 
 /**
- * @brief Removes all pages belonging to a specific table from the buffer pool.
- * Does NOT delete files from disk. Useful when table structure changes or is dropped.
+ * @brief Removes all pages belonging to a specific table from the buffer pool
+ * without writing them back. Used when the table is dropped.
  *
- * @param tableName The name of the table whose pages should be cleared from the buffer.
+ * @param tableName
  */
-void BufferManager::clearPoolForTable(const string &tableName) // Use const&
+void BufferManager::discardTablePages(const string &tableName)
 {
-    logger.log("BufferManager::clearPoolForTable");
-    // Construct the expected prefix for pages of the table.
-    string prefix = "../data/temp/" + tableName + "_Page";
-    // Remove from the deque pages whose pageName starts with prefix.
-    // Use erase-remove idiom
-    auto newEnd = remove_if(pages.begin(), pages.end(),
-                            [&prefix](const Page &p) // Capture prefix by reference
-                            {
-                                // Check if pageName starts with prefix
-                                return p.getPageName().rfind(prefix, 0) == 0; // Use getter
-                            });
-    if (newEnd != pages.end())
-    {
-        logger.log("BufferManager::clearPoolForTable: Clearing " + to_string(distance(newEnd, pages.end())) + " pages for table " + tableName + " from buffer.");
-        pages.erase(newEnd, pages.end());
+    logger.log("BufferManager::discardTablePages");
+    uint32_t tableId = this->getTableId(tableName);
+    this->prefetcher.cancelTable(tableId);
+    this->lastPageRequested.erase(tableId);
+    this->advisedUpTo.erase(tableId);
+    int clearedCount = 0;
+    for (int frameIndex = 0; frameIndex < (int)this->frames.size(); frameIndex++)
+    {
+        if (this->frames[frameIndex].occupied && (this->frames[frameIndex].key >> 32) == tableId)
+        {
+            this->dropFrame(frameIndex);
+            clearedCount++;
+        }
+    }
+    if (clearedCount > 0)
+    {
+        logger.log("BufferManager::discardTablePages: Clearing " + to_string(clearedCount) + " pages for table " + tableName + " from buffer.");
     }
     else
     {
-        logger.log("BufferManager::clearPoolForTable: No pages found in buffer for table " + tableName);
+        logger.log("BufferManager::discardTablePages: No pages found in buffer for table " + tableName);
     }
 }
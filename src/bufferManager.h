@@ -4,44 +4,148 @@
 #include <string>
 #include <vector>
 #include <deque>
+#include <unordered_map>
+#include <cstdint>
+#include <memory>
 #include <fstream>  // Include for file operations used in matrix functions
 #include <sstream>  // Include for stringstream used in matrix functions
 #include "logger.h" // Include Logger for logging capabilities
 #include "page.h"   // Include the full definition of Page
+#include "replacementPolicy.h"
+#include "prefetcher.h"
 
 // Forward declarations to avoid circular dependencies
 class Table; // Needed for deleteTablePages parameter type in tableCatalogue access
+class BufferManager;
+
+/**
+ * @brief A PageHandle is a pinned reference to a page sitting in one of the
+ * buffer manager's frames. While at least one handle to a frame is alive the
+ * frame cannot be evicted, so the Page (and any RowView/RowBatch taken from
+ * it) stays valid. Copying a handle pins the frame again; destroying or
+ * releasing it unpins. getPage returns an invalid handle on failure.
+ * Dereferencing gives read-only access; modify() must be used to change the
+ * page so that its frame is marked dirty and written back later.
+ */
+class PageHandle
+{
+    BufferManager *bufferManager;
+    int frameIndex;
+
+public:
+    PageHandle();
+    PageHandle(BufferManager *bufferManager, int frameIndex);
+    PageHandle(const PageHandle &other);
+    PageHandle(PageHandle &&other);
+    PageHandle &operator=(PageHandle other);
+    ~PageHandle();
+
+    bool isValid() const { return this->frameIndex >= 0; }
+    void release();
+    Page &modify() const;
+    const Page &operator*() const;
+    const Page *operator->() const;
+};
 
 /**
  * @brief The BufferManager is responsible for reading pages to the main memory.
  * Recall that large files are broken and stored as blocks in the hard disk. The
  * minimum amount of memory that can be read from the disk is a block of data.
  * The buffer manager stores pages read from the disk in a pool of buffer frames
- * (memory blocks in main memory). To manage the buffer frames the buffer manager
- * uses eviction policies. Revisit the description of the buffer manager in the
- * course slides for more details.
+ * (memory blocks in main memory). Frames are located through a hash map keyed
+ * on a compact (table id, page index) pair, and callers access them through
+ * pinned PageHandles instead of copies. Which unpinned frame is evicted is
+ * decided by a pluggable ReplacementPolicy (LRU, CLOCK or the scan resistant
+ * 2Q) chosen at startup, which also counts hits and misses. When a table is
+ * read sequentially the following pages are read ahead on a background
+ * thread (see Prefetcher) and installed in frames as the scan reaches them.
+ * With mapped reads on, pages are memory-mapped and read in place; the kernel
+ * is asked to read ahead instead, and a page is copied only when modified.
+ * Pages are compressed column by column when they are written, if that
+ * makes them smaller (see pageCodec.h).
+ * Each table's pages live in one segment file (see SegmentFile) that the
+ * buffer manager keeps open, so pages are read and written by offset and a
+ * whole table is dropped by removing a single file.
+ * A frame is only written back to disk if it is dirty, i.e. it was
+ * changed through PageHandle::modify(), and then only when it is evicted,
+ * flushed with flushTable()/writeAllPages(), or at shutdown. Revisit the
+ * description of the buffer manager in the course slides for more details.
  *
  */
 class BufferManager
 {
-    std::deque<Page> pages; // Use std::deque for efficient front removal (LRU)
+    friend class PageHandle;
+
+    struct Frame
+    {
+        Page page;
+        uint64_t key = 0;
+        bool occupied = false;     // holds a page that is reachable through frameTable
+        bool dirty = false;        // modified since it was read or last written
+        int pinCount = 0;
+    };
+
+    // std::deque keeps references to frames stable if the pool has to grow
+    std::deque<Frame> frames;
+    std::unordered_map<uint64_t, int> frameTable; // (table id, page index) -> frame
+    std::unordered_map<std::string, uint32_t> tableIds;
     size_t maxSize;         // Maximum number of pages the buffer can hold
+    size_t residentCount = 0;
+    std::unique_ptr<ReplacementPolicy> policy;
+    Prefetcher prefetcher;
+    size_t prefetchDepth = DEFAULT_PREFETCH_DEPTH;
+    std::unordered_map<uint32_t, int> lastPageRequested; // table id -> page index
+    std::unordered_map<uint32_t, int> advisedUpTo;       // table id -> last page hinted to the kernel
+    bool mappedReads = true;
+    bool pageCompression = true;
+    std::unordered_map<std::string, std::shared_ptr<SegmentFile>> segments; // table name -> open segment
+
+    uint64_t pageKey(const std::string &tableName, int pageIndex);
+    int findFrame(const std::string &tableName, int pageIndex);
+    int findVictim();
+    int allocateFrame();
+    void evictFrame(int frameIndex);
+    void dropFrame(int frameIndex, bool evicted = false);
+    void pin(int frameIndex);
+    void unpin(int frameIndex);
+    void readAhead(const std::string &tableName, int pageIndex);
 
 public:
     BufferManager();
     ~BufferManager(); // Declare destructor
 
-    Page getPage(const std::string &tableName, int pageIndex);
-    bool inPool(const std::string &pageName);
-    Page *findPage(const std::string &pageName);                  // Declaration for findPage
-    void insertIntoPool(Page &page);                              // Declaration for insertIntoPool
-    void writeAllPages();                                         // Declaration for writeAllPages
+    uint32_t getTableId(const std::string &tableName);
+    void setCapacity(size_t frameCount);
+    size_t getCapacity() const { return this->maxSize; }
+    size_t getResidentCount() const { return this->residentCount; }
+    bool setReplacementPolicy(const std::string &policyName);
+    const ReplacementPolicy &getReplacementPolicy() const { return *this->policy; }
+    void setPrefetchDepth(size_t depth);
+    size_t getPrefetchDepth() const { return this->prefetchDepth; }
+    const Prefetcher &getPrefetcher() const { return this->prefetcher; }
+    void setMappedReads(bool enabled);
+    bool getMappedReads() const { return this->mappedReads; }
+    void setPageCompression(bool enabled);
+    bool getPageCompression() const { return this->pageCompression; }
+    void recordPageWrite(size_t rawBytes, size_t storedBytes);
+    long long pagesWritten = 0;
+    long long rawBytesWritten = 0;
+    long long storedBytesWritten = 0;
+    std::shared_ptr<SegmentFile> getSegment(const std::string &tableName, size_t pageBytes = 0);
+    std::shared_ptr<SegmentFile> createSegment(const std::string &tableName, size_t slotBytes);
+    std::shared_ptr<SegmentFile> findSegment(const std::string &tableName) const;
+    void deleteSegment(const std::string &tableName);
+    void deleteFile(const std::string &fileName);
+    PageHandle getPage(const std::string &tableName, int pageIndex);
+    bool inPool(const std::string &tableName, int pageIndex);
+    void writeAllPages();                                         // Writes back every dirty page
+    void flushTable(const std::string &tableName);                // Writes back the dirty pages of one table
     void deletePage(const std::string &tableName, int pageIndex); // Declaration for deletePage
     void deleteTablePages(const std::string &tableName);          // Declaration for deleteTablePages
-    void clearPoolForTable(const std::string &tableName);         // Declaration for clearPoolForTable
-
-    // Add method specifically for writing index pages (serialized vector<int>)
-    void writeIndexPage(const std::string &pageName, const std::vector<int> &pageData);
+    void clearPoolForTable(const std::string &tableName);         // Flushes, then drops the table's pages
+    void discardTablePages(const std::string &tableName);         // Drops the table's pages without writing them
+    void writePage(const std::string &tableName, int pageIndex, std::vector<std::vector<int>> rows, int rowCount, PageLayout layout = ROW_LAYOUT);
+    void writePage(Page &page);
 
     // Matrix specific functions - Keep declarations consistent with definitions
     std::vector<std::vector<int>> getBlock(const std::string &matrixName, int rowBlockIndex, int colBlockIndex);
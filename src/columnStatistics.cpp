@@ -0,0 +1,181 @@
+#include "columnStatistics.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+HyperLogLog::HyperLogLog() : registers((size_t)1 << HLL_PRECISION, 0)
+{
+}
+
+void HyperLogLog::merge(const HyperLogLog &other)
+{
+    for (size_t index = 0; index < this->registers.size(); index++)
+    {
+        this->registers[index] = max(this->registers[index], other.registers[index]);
+    }
+}
+
+/**
+ * @brief Standard HyperLogLog estimate, with linear counting while many
+ * registers are still empty. The 64-bit hash makes the large-range
+ * correction unnecessary.
+ *
+ * @return double estimated number of distinct values added
+ */
+double HyperLogLog::estimate() const
+{
+    double registerCount = this->registers.size();
+    double sum = 0;
+    size_t emptyRegisters = 0;
+    for (uint8_t rank : this->registers)
+    {
+        sum += ldexp(1.0, -rank);
+        emptyRegisters += rank == 0;
+    }
+    double alpha = 0.7213 / (1.0 + 1.079 / registerCount);
+    double estimate = alpha * registerCount * registerCount / sum;
+    if (estimate <= 2.5 * registerCount && emptyRegisters > 0)
+    {
+        estimate = registerCount * log(registerCount / emptyRegisters);
+    }
+    return estimate;
+}
+
+void HyperLogLog::clear()
+{
+    fill(this->registers.begin(), this->registers.end(), 0);
+}
+
+ColumnStatistics::ColumnStatistics() : sampleState(0x2545f4914f6cdd1dULL)
+{
+}
+
+void ColumnStatistics::addExact(int value)
+{
+    vector<int>::iterator position = lower_bound(this->exactValues.begin(), this->exactValues.end(), value);
+    if (position != this->exactValues.end() && *position == value)
+    {
+        return;
+    }
+    if (this->exactValues.size() >= (size_t)EXACT_DISTINCT_LIMIT)
+    {
+        this->exact = false;
+        vector<int>().swap(this->exactValues);
+        return;
+    }
+    this->exactValues.insert(position, value);
+}
+
+/**
+ * @brief Reservoir sampling: keeps every one of the values added so far in
+ * the sample with the same probability. Uses a fixed-seed xorshift
+ * generator, so loading the same file gives the same histogram.
+ *
+ * @param value
+ */
+void ColumnStatistics::addToSample(int value)
+{
+    if (this->sample.size() < (size_t)HISTOGRAM_SAMPLE_SIZE)
+    {
+        this->sample.push_back(value);
+        return;
+    }
+    this->sampleState ^= this->sampleState << 13;
+    this->sampleState ^= this->sampleState >> 7;
+    this->sampleState ^= this->sampleState << 17;
+    uint64_t slot = this->sampleState % (uint64_t)this->valueCount;
+    if (slot < (uint64_t)HISTOGRAM_SAMPLE_SIZE)
+    {
+        this->sample[slot] = value;
+    }
+}
+
+/**
+ * @brief Turns the sample into equi-depth histogram bounds and frees it.
+ *
+ * @param bucketCount 0 to skip the histogram
+ */
+void ColumnStatistics::buildHistogram(int bucketCount)
+{
+    this->histogramBounds.clear();
+    if (bucketCount > 0 && !this->sample.empty())
+    {
+        sort(this->sample.begin(), this->sample.end());
+        size_t sampleSize = this->sample.size();
+        this->histogramBounds.push_back(this->minValue);
+        for (int bucket = 1; bucket < bucketCount; bucket++)
+        {
+            this->histogramBounds.push_back(this->sample[(sampleSize * bucket) / bucketCount]);
+        }
+        this->histogramBounds.push_back(this->maxValue);
+    }
+    vector<int>().swap(this->sample);
+}
+
+/**
+ * @brief Distinct values: exact for up to EXACT_DISTINCT_LIMIT of them,
+ * otherwise from the sketch. Never more than the number of values, and at
+ * least 1 for a non-empty column.
+ */
+long long ColumnStatistics::getDistinctCount() const
+{
+    if (this->valueCount == 0)
+    {
+        return 0;
+    }
+    if (this->exact)
+    {
+        return this->exactValues.size();
+    }
+    long long estimate = llround(this->distinctValues.estimate());
+    return max(1LL, min(estimate, this->valueCount));
+}
+
+/**
+ * @brief Estimated share of the column's values that lie in [low, high],
+ * from the histogram, taking the values of a bucket as spread evenly over
+ * its range. For an equality the share of one distinct value is a floor,
+ * since the histogram spreads a rare value over its whole bucket. Without a
+ * histogram the values are taken as spread evenly from min to max.
+ *
+ * @param low
+ * @param high
+ * @return a fraction between 0 and 1
+ */
+double ColumnStatistics::estimateSelectivity(int low, int high) const
+{
+    if (this->valueCount == 0 || low > high || high < this->minValue || low > this->maxValue)
+    {
+        return 0;
+    }
+    low = max(low, this->minValue);
+    high = min(high, this->maxValue);
+    double selectivity = 0;
+    if (this->histogramBounds.size() < 2)
+    {
+        selectivity = ((double)high - low + 1) / ((double)this->maxValue - this->minValue + 1);
+    }
+    else
+    {
+        size_t bucketCount = this->histogramBounds.size() - 1;
+        for (size_t bucket = 0; bucket < bucketCount; bucket++)
+        {
+            // (bounds[bucket], bounds[bucket + 1]], the first bucket also holding
+            // its lower bound; equal bounds mark a bucket of one frequent value
+            double upper = this->histogramBounds[bucket + 1];
+            double lower = min(upper, (double)this->histogramBounds[bucket] + (bucket > 0 ? 1 : 0));
+            double overlap = min(upper, (double)high) - max(lower, (double)low) + 1;
+            if (overlap > 0)
+            {
+                selectivity += overlap / (upper - lower + 1);
+            }
+        }
+        selectivity /= bucketCount;
+    }
+    if (low == high)
+    {
+        selectivity = max(selectivity, 1.0 / this->getDistinctCount());
+    }
+    return min(1.0, selectivity);
+}
@@ -0,0 +1,108 @@
+#ifndef COLUMNSTATISTICS_H
+#define COLUMNSTATISTICS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// DO NOT USE "using namespace std;" in header files
+
+const int HLL_PRECISION = 12;                 // 4096 one-byte registers, about 1.6% standard error
+const int EXACT_DISTINCT_LIMIT = 1024;        // distinct values counted exactly before relying on the sketch
+const int HISTOGRAM_SAMPLE_SIZE = 4096;       // values sampled per column to build the histogram
+const int DEFAULT_HISTOGRAM_BUCKETS = 32;
+
+/**
+ * @brief HyperLogLog distinct-count sketch over int values. Uses a fixed
+ * 2^HLL_PRECISION bytes however many values are added; small counts fall
+ * back to linear counting and are close to exact. Sketches of the same
+ * column can be merged.
+ */
+class HyperLogLog
+{
+    std::vector<uint8_t> registers;
+
+public:
+    HyperLogLog();
+
+    void add(int value)
+    {
+        // splitmix64 finaliser: spreads consecutive keys over all bits
+        uint64_t hash = (uint64_t)(uint32_t)value + 0x9e3779b97f4a7c15ULL;
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+        size_t index = hash >> (64 - HLL_PRECISION);
+        uint64_t rest = hash << HLL_PRECISION;
+        uint8_t rank = rest == 0 ? 64 - HLL_PRECISION + 1 : __builtin_clzll(rest) + 1;
+        if (rank > this->registers[index])
+        {
+            this->registers[index] = rank;
+        }
+    }
+    void merge(const HyperLogLog &other);
+    double estimate() const;
+    void clear();
+};
+
+/**
+ * @brief Bounded-memory statistics of one column, collected while its rows
+ * are written: value count, zeros, min/max, a HyperLogLog distinct count and
+ * an equi-depth histogram. Up to EXACT_DISTINCT_LIMIT distinct values are
+ * also kept in a sorted vector, so low-cardinality columns get an exact
+ * count; the vector is dropped as soon as it would grow past the limit. The
+ * histogram is built from a fixed-size uniform sample of the values
+ * (reservoir sampling), so memory does not grow with the table.
+ *<p>
+ * histogramBounds holds bucketCount + 1 ascending values; about the same
+ * number of rows falls into each bucket (bounds[i], bounds[i + 1]], the
+ * first bucket also holding bounds[0] itself (the column minimum).
+ *</p>
+ */
+class ColumnStatistics
+{
+    std::vector<int> sample;
+    uint64_t sampleState;
+    std::vector<int> exactValues;
+    bool exact = true;
+
+public:
+    long long valueCount = 0;
+    long long zeroCount = 0;
+    int minValue = 0;
+    int maxValue = 0;
+    HyperLogLog distinctValues;
+    std::vector<int> histogramBounds;
+    // Set once the column changes after LOAD (INSERT, UPDATE, DELETE): the
+    // other fields then only describe the rows as they were loaded
+    bool stale = false;
+
+    ColumnStatistics();
+
+    void add(int value)
+    {
+        if (this->valueCount == 0 || value < this->minValue)
+        {
+            this->minValue = value;
+        }
+        if (this->valueCount == 0 || value > this->maxValue)
+        {
+            this->maxValue = value;
+        }
+        this->zeroCount += value == 0;
+        this->valueCount++;
+        this->distinctValues.add(value);
+        if (this->exact)
+        {
+            this->addExact(value);
+        }
+        this->addToSample(value);
+    }
+    void addExact(int value);
+    void addToSample(int value);
+    void buildHistogram(int bucketCount);
+    long long getDistinctCount() const;
+    double estimateSelectivity(int low, int high) const;
+};
+
+#endif // COLUMNSTATISTICS_H
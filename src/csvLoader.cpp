@@ -0,0 +1,297 @@
+#include "csvLoader.h"
+#include <fcntl.h>    // For open(), posix_fadvise()
+#include <unistd.h>   // For pread(), close()
+#include <sys/stat.h> // For fstat()
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+using namespace std;
+
+CsvLoader::CsvLoader(const string &fileName, int columnCount) : fileName(fileName), columnCount(columnCount), fileDescriptor(-1)
+{
+}
+
+CsvLoader::~CsvLoader()
+{
+    this->stop();
+    if (this->fileDescriptor >= 0)
+    {
+        close(this->fileDescriptor);
+    }
+}
+
+void CsvLoader::stop()
+{
+    {
+        lock_guard<std::mutex> lock(this->chunkMutex);
+        this->stopping = true;
+    }
+    this->windowOpened.notify_all();
+    for (thread &worker : this->workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+/**
+ * @brief Start of the first line that begins at or after offset, i.e. one
+ * past the first newline at offset - 1 or later.
+ *
+ * @param offset
+ * @param fileSize
+ * @return off_t fileSize if there is no such line
+ */
+off_t CsvLoader::findLineStart(off_t offset, off_t fileSize) const
+{
+    char buffer[65536];
+    off_t position = offset - 1;
+    while (position < fileSize)
+    {
+        ssize_t bytesRead = pread(this->fileDescriptor, buffer, sizeof(buffer), position);
+        if (bytesRead <= 0)
+        {
+            break;
+        }
+        const char *newline = (const char *)memchr(buffer, '\n', bytesRead);
+        if (newline != nullptr)
+        {
+            return position + (newline - buffer) + 1;
+        }
+        position += bytesRead;
+    }
+    return fileSize;
+}
+
+/**
+ * @brief Opens the file, skips the header line, splits the rest into byte
+ * ranges on line boundaries and starts the parsing threads.
+ *
+ * @param threadCount upper bound on the threads used; fewer are started for
+ * a file with fewer ranges
+ * @param error
+ * @return true if parsing started
+ */
+bool CsvLoader::start(int threadCount, string &error)
+{
+    this->fileDescriptor = open(this->fileName.c_str(), O_RDONLY);
+    if (this->fileDescriptor < 0)
+    {
+        error = "could not open " + this->fileName + ": " + strerror(errno);
+        return false;
+    }
+    struct stat fileStatus;
+    if (fstat(this->fileDescriptor, &fileStatus) != 0)
+    {
+        error = "could not stat " + this->fileName + ": " + strerror(errno);
+        return false;
+    }
+    off_t fileSize = fileStatus.st_size;
+    posix_fadvise(this->fileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    off_t begin = this->findLineStart(1, fileSize);
+    while (begin < fileSize)
+    {
+        off_t end = begin + (off_t)CSV_CHUNK_BYTES >= fileSize ? fileSize : this->findLineStart(begin + CSV_CHUNK_BYTES, fileSize);
+        this->ranges.emplace_back(begin, end);
+        begin = end;
+    }
+
+    int workerCount = max(1, min(threadCount, (int)this->ranges.size()));
+    if (this->ranges.empty())
+    {
+        return true;
+    }
+    this->maxAhead = workerCount * 2;
+    for (int workerIndex = 0; workerIndex < workerCount; workerIndex++)
+    {
+        this->workers.emplace_back(&CsvLoader::run, this);
+    }
+    return true;
+}
+
+/**
+ * @brief Body of a parsing thread: takes the next range while the caller is
+ * less than maxAhead chunks behind, and parses it with the lock released.
+ *
+ */
+void CsvLoader::run()
+{
+    unique_lock<std::mutex> lock(this->chunkMutex);
+    while (true)
+    {
+        this->windowOpened.wait(lock, [this]() {
+            return this->stopping || this->nextRange >= this->ranges.size() || this->nextRange < this->nextChunk + this->maxAhead;
+        });
+        if (this->stopping || this->nextRange >= this->ranges.size())
+        {
+            return;
+        }
+        size_t rangeIndex = this->nextRange++;
+        this->window.emplace_back();
+        this->parsed.push_back(false);
+        lock.unlock();
+
+        CsvChunk chunk;
+        chunk.begin = this->ranges[rangeIndex].first;
+        chunk.end = this->ranges[rangeIndex].second;
+        this->parseChunk(chunk);
+
+        lock.lock();
+        // The caller waits for this slot before it moves past it
+        size_t slot = rangeIndex - this->nextChunk;
+        this->window[slot] = std::move(chunk);
+        this->parsed[slot] = true;
+        this->chunkParsed.notify_all();
+    }
+}
+
+/**
+ * @brief Hands back the next chunk in file order, waiting until it is
+ * parsed. A chunk that could not be read has valid set to false.
+ *
+ * @param chunk
+ * @return false once every chunk was handed out
+ */
+bool CsvLoader::next(CsvChunk &chunk)
+{
+    unique_lock<std::mutex> lock(this->chunkMutex);
+    if (this->nextChunk >= this->ranges.size())
+    {
+        return false;
+    }
+    this->chunkParsed.wait(lock, [this]() { return !this->parsed.empty() && this->parsed.front(); });
+    chunk = std::move(this->window.front());
+    this->window.pop_front();
+    this->parsed.pop_front();
+    this->nextChunk++;
+    lock.unlock();
+    this->windowOpened.notify_all();
+    return true;
+}
+
+/**
+ * @brief Reads one range with pread and parses every line in it.
+ *
+ * @param chunk begin and end are set; everything else is filled in
+ */
+void CsvLoader::parseChunk(CsvChunk &chunk) const
+{
+    size_t bytes = chunk.end - chunk.begin;
+    vector<char> buffer(bytes);
+    size_t bytesRead = 0;
+    while (bytesRead < bytes)
+    {
+        ssize_t result = pread(this->fileDescriptor, buffer.data() + bytesRead, bytes - bytesRead, chunk.begin + bytesRead);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            chunk.error = "could not read " + this->fileName + " at byte " + to_string(chunk.begin + bytesRead) + (result < 0 ? string(": ") + strerror(errno) : string(": unexpected end of file"));
+            return;
+        }
+        bytesRead += result;
+    }
+
+    // About as many rows as the first line suggests, to avoid regrowing
+    const char *firstNewline = (const char *)memchr(buffer.data(), '\n', bytes);
+    if (firstNewline != nullptr)
+    {
+        chunk.values.reserve(bytes / (firstNewline - buffer.data() + 1) * this->columnCount);
+    }
+
+    CsvTokenizer tokenizer(buffer.data(), buffer.data() + bytes);
+    vector<int> row(this->columnCount);
+    while (tokenizer.nextLine())
+    {
+        this->parseLine(tokenizer, chunk, row);
+        chunk.lineCount++;
+    }
+    chunk.valid = true;
+}
+
+/**
+ * @brief Parses the tokenizer's current line with the same rules as reading
+ * it with getline and stoi: fields are split on ',', trimmed, an empty field
+ * is 0, a line needs exactly columnCount fields (trailing blanks after the
+ * last one are allowed) and an invalid or out-of-range integer rejects the
+ * line. Valid rows are appended to the chunk.
+ */
+void CsvLoader::parseLine(CsvTokenizer &tokenizer, CsvChunk &chunk, vector<int> &row) const
+{
+    bool rowReadSuccess = true;
+    const char *first;
+    const char *last;
+    for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+    {
+        if (!tokenizer.nextField(first, last))
+        {
+            CsvIssue issue;
+            issue.lineIndex = chunk.lineCount;
+            issue.level = "WARNING";
+            issue.detail = ": Not enough columns. Expected " + to_string(this->columnCount) + ". Line: " + string(tokenizer.getLineBegin(), tokenizer.getLineEnd());
+            chunk.issues.push_back(std::move(issue));
+            rowReadSuccess = false;
+            break;
+        }
+        trimCsvField(first, last);
+
+        if (first == last)
+        {
+            CsvIssue issue;
+            issue.lineIndex = chunk.lineCount;
+            issue.level = "WARNING";
+            issue.detail = ", Column " + to_string(columnCounter) + ": Empty value after trim. Treating as 0.";
+            chunk.issues.push_back(std::move(issue));
+            row[columnCounter] = 0;
+            continue;
+        }
+        CsvParseStatus status = parseCsvInteger(first, last, row[columnCounter]);
+        if (status != CSV_PARSE_OK)
+        {
+            CsvIssue issue;
+            issue.lineIndex = chunk.lineCount;
+            issue.level = "ERROR";
+            issue.detail = (status == CSV_PARSE_INVALID ? ": Invalid integer '" : ": Integer out of range '") + string(first, last) + "'.";
+            chunk.issues.push_back(std::move(issue));
+            rowReadSuccess = false;
+            break;
+        }
+    }
+
+    // Check for too many columns
+    if (rowReadSuccess)
+    {
+        const char *extra = tokenizer.getPosition();
+        const char *lineEnd = tokenizer.getLineEnd();
+        first = extra;
+        last = lineEnd;
+        trimCsvField(first, last);
+        if (first < last)
+        {
+            CsvIssue issue;
+            issue.lineIndex = chunk.lineCount;
+            issue.level = "WARNING";
+            issue.detail = ": Too many columns. Extra content: '" + string(extra, lineEnd) + "'. Line: " + string(tokenizer.getLineBegin(), lineEnd);
+            chunk.issues.push_back(std::move(issue));
+            rowReadSuccess = false;
+        }
+    }
+
+    if (!rowReadSuccess)
+    {
+        CsvIssue issue;
+        issue.lineIndex = chunk.lineCount;
+        issue.skipped = true;
+        issue.line = string(tokenizer.getLineBegin(), tokenizer.getLineEnd());
+        chunk.issues.push_back(std::move(issue));
+        return;
+    }
+    chunk.values.insert(chunk.values.end(), row.begin(), row.end());
+    chunk.rowCount++;
+}
@@ -0,0 +1,93 @@
+#ifndef CSVLOADER_H
+#define CSVLOADER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sys/types.h>
+#include "csvTokenizer.h"
+
+// DO NOT USE "using namespace std;" in header files
+
+const size_t CSV_CHUNK_BYTES = 8 << 20; // Target size of one parsed byte range
+
+/**
+ * @brief Something the parser has to report about one line of a chunk: a
+ * log message, and for a rejected row the raw line for the "Skipping invalid
+ * row" notice. Lines are counted from the start of the chunk; the loader's
+ * caller knows where the chunk starts and numbers them.
+ */
+struct CsvIssue
+{
+    long long lineIndex = 0;
+    std::string level;  // "WARNING" or "ERROR"
+    std::string detail; // log text following "Line <n>"
+    bool skipped = false;
+    std::string line;   // the rejected line when skipped
+};
+
+/**
+ * @brief The parsed rows of one byte range of the CSV file, row-major.
+ */
+struct CsvChunk
+{
+    off_t begin = 0;
+    off_t end = 0;
+    std::vector<int> values;
+    long long rowCount = 0;
+    long long lineCount = 0; // every line of the range, including rejected ones
+    std::vector<CsvIssue> issues;
+    bool valid = false;
+    std::string error;
+};
+
+/**
+ * @brief Parses the data lines of a CSV file on a pool of threads. The file
+ * after the header is split into byte ranges of about CSV_CHUNK_BYTES that
+ * start and end on line boundaries; each thread reads a range with pread and
+ * parses it into a CsvChunk with a CsvTokenizer. next() hands the chunks back
+ * in file order, so the caller can build pages exactly as a single reader
+ * would. At most two chunks per thread are parsed ahead of the caller, which
+ * bounds memory for files of any size. Threads only touch their own chunk;
+ * the logger, catalogue and buffer pool stay with the caller.
+ */
+class CsvLoader
+{
+    std::string fileName;
+    int columnCount;
+    int fileDescriptor;
+    std::vector<std::pair<off_t, off_t>> ranges;
+
+    std::mutex chunkMutex;
+    std::condition_variable chunkParsed;
+    std::condition_variable windowOpened;
+    std::deque<CsvChunk> window; // chunks nextChunk .. nextChunk + window.size() - 1
+    std::deque<bool> parsed;     // per window slot
+    size_t nextChunk = 0;        // next chunk handed to the caller
+    size_t nextRange = 0;        // next range a thread picks up
+    size_t maxAhead = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    off_t findLineStart(off_t offset, off_t fileSize) const;
+    void run();
+    void parseChunk(CsvChunk &chunk) const;
+    void parseLine(CsvTokenizer &tokenizer, CsvChunk &chunk, std::vector<int> &row) const;
+    void stop();
+
+public:
+    CsvLoader(const std::string &fileName, int columnCount);
+    ~CsvLoader();
+    CsvLoader(const CsvLoader &) = delete;
+    CsvLoader &operator=(const CsvLoader &) = delete;
+
+    bool start(int threadCount, std::string &error);
+    bool next(CsvChunk &chunk);
+    size_t getChunkCount() const { return this->ranges.size(); }
+    int getThreadCount() const { return this->workers.size(); }
+};
+
+#endif // CSVLOADER_H
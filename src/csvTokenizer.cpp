@@ -0,0 +1,244 @@
+#include "csvTokenizer.h"
+#include <climits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CSV_SCAN_X86
+#endif
+
+using namespace std;
+
+static uint64_t findDelimitersScalar(const char *block)
+{
+    uint64_t mask = 0;
+    for (int byte = 0; byte < 64; byte++)
+    {
+        if (block[byte] == ',' || block[byte] == '\n')
+        {
+            mask |= (uint64_t)1 << byte;
+        }
+    }
+    return mask;
+}
+
+#ifdef CSV_SCAN_X86
+__attribute__((target("sse2"))) static uint64_t findDelimitersSse2(const char *block)
+{
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    uint64_t mask = 0;
+    for (int offset = 0; offset < 64; offset += 16)
+    {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(block + offset));
+        __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, newline));
+        mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(matches) << offset;
+    }
+    return mask;
+}
+
+__attribute__((target("avx2"))) static uint64_t findDelimitersAvx2(const char *block)
+{
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    __m256i low = _mm256_loadu_si256((const __m256i *)block);
+    __m256i high = _mm256_loadu_si256((const __m256i *)(block + 32));
+    uint32_t lowMask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(low, comma), _mm256_cmpeq_epi8(low, newline)));
+    uint32_t highMask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(high, comma), _mm256_cmpeq_epi8(high, newline)));
+    return (uint64_t)lowMask | (uint64_t)highMask << 32;
+}
+#endif
+
+static bool isSupported(CsvScanLevel level)
+{
+    switch (level)
+    {
+    case CSV_SCAN_SCALAR:
+        return true;
+#ifdef CSV_SCAN_X86
+    case CSV_SCAN_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case CSV_SCAN_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+static CsvScanLevel detectScanLevel()
+{
+#ifdef CSV_SCAN_X86
+    // Runs during static initialisation, before the CPU model is known
+    __builtin_cpu_init();
+#endif
+    if (isSupported(CSV_SCAN_AVX2))
+    {
+        return CSV_SCAN_AVX2;
+    }
+    if (isSupported(CSV_SCAN_SSE2))
+    {
+        return CSV_SCAN_SSE2;
+    }
+    return CSV_SCAN_SCALAR;
+}
+
+static uint64_t (*selectScanner(CsvScanLevel level))(const char *)
+{
+#ifdef CSV_SCAN_X86
+    if (level == CSV_SCAN_AVX2)
+    {
+        return findDelimitersAvx2;
+    }
+    if (level == CSV_SCAN_SSE2)
+    {
+        return findDelimitersSse2;
+    }
+#endif
+    return findDelimitersScalar;
+}
+
+static CsvScanLevel scanLevel = detectScanLevel();
+static uint64_t (*scanner)(const char *) = selectScanner(scanLevel);
+
+CsvScanLevel getCsvScanLevel()
+{
+    return scanLevel;
+}
+
+/**
+ * @brief Switches the delimiter search to another instruction set. Must not
+ * be called while a load is running.
+ *
+ * @param level
+ * @return false if the CPU does not support it
+ */
+bool setCsvScanLevel(CsvScanLevel level)
+{
+    if (!isSupported(level))
+    {
+        return false;
+    }
+    scanLevel = level;
+    scanner = selectScanner(level);
+    return true;
+}
+
+const char *getCsvScanLevelName(CsvScanLevel level)
+{
+    switch (level)
+    {
+    case CSV_SCAN_SSE2:
+        return "SSE2";
+    case CSV_SCAN_AVX2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
+
+uint64_t findCsvDelimiters(const char *block)
+{
+    return scanner(block);
+}
+
+CsvParseStatus parseCsvInteger(const char *begin, const char *end, int &value)
+{
+    const char *position = begin;
+    while (position < end && isCsvBlank(*position))
+    {
+        position++;
+    }
+    bool negative = false;
+    if (position < end && (*position == '+' || *position == '-'))
+    {
+        negative = *position == '-';
+        position++;
+    }
+    if (position == end || *position < '0' || *position > '9')
+    {
+        return CSV_PARSE_INVALID;
+    }
+    long long magnitude = 0;
+    bool overflow = false;
+    for (; position < end && *position >= '0' && *position <= '9'; position++)
+    {
+        if (!overflow)
+        {
+            magnitude = magnitude * 10 + (*position - '0');
+            overflow = magnitude > (long long)INT_MAX + 1;
+        }
+    }
+    long long result = negative ? -magnitude : magnitude;
+    if (overflow || result > INT_MAX || result < INT_MIN)
+    {
+        return CSV_PARSE_OUT_OF_RANGE;
+    }
+    value = (int)result;
+    return CSV_PARSE_OK;
+}
+
+CsvTokenizer::CsvTokenizer(const char *begin, const char *end)
+    : bufferBegin(begin), bufferEnd(end), position(begin), lineBegin(begin), blockStart(begin), blockMask(0), started(false)
+{
+    if (begin < end)
+    {
+        this->loadBlock(begin);
+    }
+}
+
+/**
+ * @brief Computes the delimiter mask of the 64 bytes at block. The last block
+ * of the buffer is usually short; it is copied so the scanner never reads
+ * past the end.
+ *
+ * @param block
+ */
+void CsvTokenizer::loadBlock(const char *block)
+{
+    this->blockStart = block;
+    if (this->bufferEnd - block >= 64)
+    {
+        this->blockMask = scanner(block);
+        return;
+    }
+    char tail[64] = {0};
+    for (const char *byte = block; byte < this->bufferEnd; byte++)
+    {
+        tail[byte - block] = *byte;
+    }
+    this->blockMask = scanner(tail);
+}
+
+/**
+ * @brief Moves to the start of the next line, skipping whatever is left of
+ * the current one.
+ *
+ * @return false at the end of the buffer
+ */
+bool CsvTokenizer::nextLine()
+{
+    if (this->started)
+    {
+        const char *lineEnd = this->getLineEnd();
+        this->position = lineEnd < this->bufferEnd ? lineEnd + 1 : lineEnd;
+    }
+    if (this->position >= this->bufferEnd)
+    {
+        return false;
+    }
+    this->started = true;
+    this->lineBegin = this->position;
+    return true;
+}
+
+/**
+ * @brief End of the current line: its '\n' or the end of the buffer.
+ */
+const char *CsvTokenizer::getLineEnd()
+{
+    const char *delimiter = this->nextDelimiter(this->position);
+    while (delimiter < this->bufferEnd && *delimiter != '\n')
+    {
+        delimiter = this->nextDelimiter(delimiter + 1);
+    }
+    return delimiter;
+}
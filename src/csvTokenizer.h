@@ -0,0 +1,132 @@
+#ifndef CSVTOKENIZER_H
+#define CSVTOKENIZER_H
+
+#include <cstdint>
+#include <cstddef>
+
+// DO NOT USE "using namespace std;" in header files
+
+/**
+ * @brief Instruction set used to find delimiters. The best one the CPU
+ * supports is picked at startup; setCsvScanLevel overrides it (the
+ * microbenchmark uses this to compare them).
+ */
+enum CsvScanLevel
+{
+    CSV_SCAN_SCALAR,
+    CSV_SCAN_SSE2,
+    CSV_SCAN_AVX2
+};
+
+enum CsvParseStatus
+{
+    CSV_PARSE_OK,
+    CSV_PARSE_INVALID,     // no digits
+    CSV_PARSE_OUT_OF_RANGE // does not fit in an int
+};
+
+CsvScanLevel getCsvScanLevel();
+bool setCsvScanLevel(CsvScanLevel level);
+const char *getCsvScanLevelName(CsvScanLevel level);
+
+// Bit i is set if block[i] is ',' or '\n'. Reads exactly 64 bytes.
+uint64_t findCsvDelimiters(const char *block);
+
+/**
+ * @brief Converts a field the way stoi does: an optional sign followed by at
+ * least one decimal digit; anything after the digits is ignored. Never
+ * allocates or throws.
+ */
+CsvParseStatus parseCsvInteger(const char *begin, const char *end, int &value);
+
+inline bool isCsvBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+inline void trimCsvField(const char *&begin, const char *&end)
+{
+    while (begin < end && isCsvBlank(*begin))
+    {
+        begin++;
+    }
+    while (end > begin && isCsvBlank(*(end - 1)))
+    {
+        end--;
+    }
+}
+
+/**
+ * @brief Splits a buffer of CSV text into lines and fields without copying.
+ * Delimiters are found 64 bytes at a time: findCsvDelimiters turns a block
+ * into a bit mask of its ',' and '\n' positions, and each field end is then
+ * just the lowest set bit, so short fields cost a few instructions each.
+ * Fields are pointer ranges into the buffer.
+ *<p>
+ * Lines and fields follow getline: a line is the text up to '\n' (or the end
+ * of the buffer, if not empty), and a line has another field as long as
+ * something follows the previous ',' on that line. So "1,2," has two fields
+ * and an empty line has none.
+ *</p>
+ */
+class CsvTokenizer
+{
+    const char *bufferBegin;
+    const char *bufferEnd;
+    const char *position;  // next unread byte of the current line
+    const char *lineBegin;
+    const char *blockStart; // 64-byte block (from bufferBegin) blockMask describes
+    uint64_t blockMask;
+    bool started;
+
+    void loadBlock(const char *block);
+
+    /**
+     * @brief First ',' or '\n' at or after from, or the end of the buffer.
+     */
+    const char *nextDelimiter(const char *from)
+    {
+        while (from < this->bufferEnd)
+        {
+            if (from < this->blockStart || from >= this->blockStart + 64)
+            {
+                this->loadBlock(this->bufferBegin + ((from - this->bufferBegin) & ~(ptrdiff_t)63));
+            }
+            uint64_t mask = this->blockMask & (~(uint64_t)0 << (from - this->blockStart));
+            if (mask != 0)
+            {
+                return this->blockStart + __builtin_ctzll(mask);
+            }
+            from = this->blockStart + 64;
+        }
+        return this->bufferEnd;
+    }
+
+public:
+    CsvTokenizer(const char *begin, const char *end);
+
+    bool nextLine();
+    const char *getLineBegin() const { return this->lineBegin; }
+    const char *getLineEnd();
+    const char *getPosition() const { return this->position; }
+
+    /**
+     * @brief Next field of the current line.
+     *
+     * @return false if the line has no more fields
+     */
+    bool nextField(const char *&fieldBegin, const char *&fieldEnd)
+    {
+        if (this->position >= this->bufferEnd || *this->position == '\n')
+        {
+            return false;
+        }
+        const char *delimiter = this->nextDelimiter(this->position);
+        fieldBegin = this->position;
+        fieldEnd = delimiter;
+        this->position = delimiter < this->bufferEnd && *delimiter == ',' ? delimiter + 1 : delimiter;
+        return true;
+    }
+};
+
+#endif // CSVTOKENIZER_H
@@ -6,57 +6,138 @@
 
 using namespace std; // Make std namespace accessible
 
-Cursor::Cursor(string tableName, int pageIndex)
+/**
+ * @brief Opens a cursor on a page of a table. With a pageFilter the cursor
+ * only reads pages for which it returns true, typically because their zone
+ * map shows they may hold matching rows. The others, the first page
+ * included, are skipped without being read; skippedPages counts them.
+ *
+ * @param tableName
+ * @param pageIndex first page to read
+ * @param pageFilter called with a page index; empty to read every page
+ */
+Cursor::Cursor(string tableName, int pageIndex, const function<bool(int)> &pageFilter) : pageFilter(pageFilter)
 {
     logger.log("Cursor::Cursor");
-    this->page = bufferManager.getPage(tableName, pageIndex);
     this->pagePointer = 0;
     this->tableName = tableName;
     this->pageIndex = pageIndex;
+    this->table = tableCatalogue.getTable(tableName);
+    if (this->pageFilter && this->table != nullptr && pageIndex >= 0 && pageIndex < (int)this->table->blockCount && !this->pageFilter(pageIndex))
+    {
+        // Left without a page; nextRows() moves on from pageIndex
+        this->skippedPages++;
+        return;
+    }
+    this->page = bufferManager.getPage(tableName, pageIndex);
 }
 
 /**
- * @brief This function reads the next row from the page. The index of the
- * current row read from the page is indicated by the pagePointer(points to row
- * in page the cursor is pointing to).
+ * @brief Claims up to maxRows of the next unread rows of the current page,
+ * moving on to later pages (and skipping empty ones and those rejected by the
+ * page filter) as needed. The claimed
+ * rows start at pagePointer - the returned count.
  *
- * @return vector<int>
+ * @param maxRows
+ * @return int number of rows claimed, 0 at the end of the table
  */
-vector<int> Cursor::getNext()
+int Cursor::nextRows(int maxRows)
 {
-    logger.log("Cursor::geNext");
-    vector<int> result = this->page.getRow(this->pagePointer);
-    this->pagePointer++;
-    if (result.empty())
+    while (true)
     {
-        // Check if the table exists before trying to get it
-        Table *tablePtr = tableCatalogue.getTable(this->tableName);
-        if (tablePtr != nullptr)
+        long long int remainingRows = this->page.isValid() ? this->page->getRowCount() - this->pagePointer : 0;
+        if (remainingRows > 0)
         {
-            tablePtr->getNextPage(this);
-            // Check if pagePointer was reset AND a valid page was loaded
-            // Accessing page.pageIndex is now valid as it's public and int
-            if (!this->pagePointer && this->page.pageIndex != -1)
-            {
-                result = this->page.getRow(this->pagePointer);
-                this->pagePointer++;
-            }
-            else if (this->page.pageIndex == -1)
-            {
-                // Handle case where getNextPage failed to load a valid page
-                // result remains empty
-                logger.log("Cursor::getNext: getNextPage failed to load a valid next page.");
-            }
-            // If pagePointer was not reset, it means getNextPage didn't load a new page (likely end of table)
+            int batchRows = (int)min<long long int>(remainingRows, maxRows);
+            this->pagePointer += batchRows;
+            return batchRows;
         }
-        else
+        if (this->table == nullptr || this->pageIndex < 0)
         {
-            // Handle case where table doesn't exist
-            // result remains empty
-            logger.log("Cursor::getNext ERROR: Table " + this->tableName + " not found.");
+            return 0;
         }
+        int nextPageIndex = this->pageIndex + 1;
+        while (nextPageIndex < (int)this->table->blockCount && this->pageFilter && !this->pageFilter(nextPageIndex))
+        {
+            this->skippedPages++;
+            nextPageIndex++;
+        }
+        if (nextPageIndex >= (int)this->table->blockCount)
+        {
+            return 0;
+        }
+        this->nextPage(nextPageIndex);
+    }
+}
+
+/**
+ * @brief Hands out up to maxRows of the next unread rows as a view over the
+ * current page, moving on to later pages (and skipping empty ones) as needed.
+ * No rows are copied and nothing is logged per call.
+ *
+ * @param batch filled with the rows read; valid until the next call
+ * @param maxRows upper bound on batch.rowCount
+ * @return true if at least one row was returned, false at the end of the table
+ */
+bool Cursor::nextBatch(RowBatch &batch, int maxRows)
+{
+    int batchRows = this->nextRows(maxRows);
+    if (batchRows == 0)
+    {
+        batch.data = nullptr;
+        batch.rowCount = 0;
+        batch.columnCount = this->table != nullptr ? this->table->columnCount : 0;
+        return false;
     }
-    return result;
+    batch.data = this->page->getRowView(this->pagePointer - batchRows).data();
+    batch.rowCount = batchRows;
+    batch.columnCount = this->page->getColumnCount();
+    return true;
+}
+
+/**
+ * @brief Like nextBatch(), but hands the rows out column by column. Preferred
+ * for tables in the PAX layout, whose pages are stored that way; on row
+ * tables each page is transposed once when first read this way.
+ *
+ * @param batch filled with the rows read; valid until the next call
+ * @param maxRows upper bound on batch.rowCount
+ * @return true if at least one row was returned, false at the end of the table
+ */
+bool Cursor::nextColumnBatch(ColumnBatch &batch, int maxRows)
+{
+    int batchRows = this->nextRows(maxRows);
+    if (batchRows == 0)
+    {
+        batch.data = nullptr;
+        batch.columnStride = 0;
+        batch.rowCount = 0;
+        batch.columnCount = this->table != nullptr ? this->table->columnCount : 0;
+        return false;
+    }
+    batch.data = this->page->getColumn(0) + (this->pagePointer - batchRows);
+    batch.columnStride = this->page->getRowCount();
+    batch.rowCount = batchRows;
+    batch.columnCount = this->page->getColumnCount();
+    return true;
+}
+
+/**
+ * @brief This function reads the next row from the page. The index of the
+ * current row read from the page is indicated by the pagePointer(points to row
+ * in page the cursor is pointing to). Thin wrapper over nextBatch() for
+ * callers that still want one row at a time.
+ *
+ * @return vector<int> empty at the end of the table
+ */
+vector<int> Cursor::getNext()
+{
+    RowBatch batch;
+    if (!this->nextBatch(batch, 1))
+    {
+        return vector<int>();
+    }
+    return batch.row(0).toVector();
 }
 /**
  * @brief Function that loads Page indicated by pageIndex. Now the cursor starts
@@ -68,9 +149,10 @@ void Cursor::nextPage(int pageIndex)
 {
     logger.log("Cursor::nextPage");
     // Check if the pageIndex is valid before attempting to get the page
-    Table *tablePtr = tableCatalogue.getTable(this->tableName);
-    if (tablePtr != nullptr && pageIndex >= 0 && pageIndex < tablePtr->blockCount)
+    if (this->table != nullptr && pageIndex >= 0 && pageIndex < (int)this->table->blockCount)
     {
+        // Unpin the current page first so its frame can be reused for the next one
+        this->page.release();
         this->page = bufferManager.getPage(this->tableName, pageIndex);
         this->pageIndex = pageIndex;
         this->pagePointer = 0;
@@ -80,8 +162,8 @@ void Cursor::nextPage(int pageIndex)
         // Handle invalid pageIndex or table not found
         logger.log("Cursor::nextPage ERROR: Invalid page index or table not found.");
         // Optionally reset cursor state to indicate failure
-        this->page = Page(); // Reset to a default/empty page (which has pageIndex -1)
+        this->page.release(); // Leave the cursor without a page
         this->pageIndex = -1;
         this->pagePointer = 0;
     }
-}
\ No newline at end of file
+}
@@ -25,23 +25,78 @@
 #define CURSOR_H
 
 #include "bufferManager.h"
+#include <functional>
 #include <string>
 #include <vector>
 using namespace std;
 
+class Table;
+
+// Default number of rows handed out by one Cursor::nextBatch() call
+const int CURSOR_BATCH_SIZE = 1024;
+
+/**
+ * @brief A run of consecutive rows returned by Cursor::nextBatch(). The rows
+ * are not copied: data points into the cursor's current page, so a batch is
+ * only valid until the next call on the cursor that produced it.
+ */
+struct RowBatch
+{
+    const int *data = nullptr;
+    int rowCount = 0;
+    int columnCount = 0;
+
+    RowView row(int rowIndex) const { return RowView(data + (size_t)rowIndex * columnCount, columnCount); }
+    bool empty() const { return rowCount == 0; }
+};
+
+/**
+ * @brief A run of consecutive rows returned by Cursor::nextColumnBatch(), seen
+ * column by column: column(c) points at rowCount values of column c. Like
+ * RowBatch nothing is copied, and a batch is only valid until the next call
+ * on the cursor. On PAX tables the columns are read in place, so only the
+ * columns actually used are touched.
+ */
+struct ColumnBatch
+{
+    const int *data = nullptr; // first value of column 0
+    size_t columnStride = 0;   // distance from one column to the next
+    int rowCount = 0;
+    int columnCount = 0;
+
+    const int *column(int columnIndex) const { return data + (size_t)columnIndex * columnStride; }
+    int value(int rowIndex, int columnIndex) const { return column(columnIndex)[rowIndex]; }
+    bool empty() const { return rowCount == 0; }
+};
+
 /**
  * @brief The cursor is an important component of the system.
  * To read from a table, you need to initialize a cursor. 
- * The cursor reads rows from a page one at a time.
+ * The cursor hands out rows of the current page in batches and moves to the
+ * next page of the table when the current one is exhausted. The current page
+ * stays pinned in the buffer pool until the cursor moves off it.
  */
 class Cursor {
 public:
-    Page page;
+    // Pinned while the cursor is on it; invalid once the table is exhausted
+    PageHandle page;
     int pageIndex;
     string tableName;
     int pagePointer;
+    // Resolved once at construction so page changes need no catalogue lookup
+    Table *table;
+    // Pages for which this returns false are skipped without being read
+    std::function<bool(int)> pageFilter;
+    int skippedPages = 0;
+
+private:
+    int nextRows(int maxRows);
+
+public:
 
-    Cursor(string tableName, int pageIndex);
+    Cursor(string tableName, int pageIndex, const std::function<bool(int)> &pageFilter = nullptr);
+    bool nextBatch(RowBatch &batch, int maxRows = CURSOR_BATCH_SIZE);
+    bool nextColumnBatch(ColumnBatch &batch, int maxRows = CURSOR_BATCH_SIZE);
     vector<int> getNext();
     void nextPage(int pageIndex);
 };
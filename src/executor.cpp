@@ -31,6 +31,7 @@ void executeSEARCH();
 void executeINSERT();
 void executeUPDATE();
 void executeDELETE();
+void executeSETMEMORY();
 // Remove RENAME MATRIX related functions if they existed
 // void executeRENAMEMATRIX(); // Example if it existed
 
@@ -150,6 +151,9 @@ void executeCommand()
     case DELETE:
         executeDELETE();
         break;
+    case SET_MEMORY:
+        executeSETMEMORY();
+        break;
     default:
         cout << "PARSING ERROR" << endl;
     }
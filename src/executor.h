@@ -35,6 +35,9 @@ void executeCHECKANTISYMMATRIX();
 
 
 bool evaluateBinOp(int value1, int value2, BinaryOperator binaryOperator);
+bool pageMayMatch(const Table &table, int pageIndex, int columnIndex, BinaryOperator binaryOperator, int value);
+bool pageMayMatchColumns(const Table &table, int pageIndex, int firstColumnIndex, BinaryOperator binaryOperator, int secondColumnIndex);
+bool findIndexedPages(const Table &table, int columnIndex, int value, vector<bool> &pageHasMatch);
 void printRowCount(int rowCount);
 
 // #endif // EXECUTOR_H
\ No newline at end of file
@@ -67,8 +67,8 @@ void executeCROSS()
     }
 
     // Get table objects (now using full Table definition)
-    Table table1 = *(tableCatalogue.getTable(parsedQuery.crossFirstRelationName));
-    Table table2 = *(tableCatalogue.getTable(parsedQuery.crossSecondRelationName));
+    Table &table1 = *(tableCatalogue.getTable(parsedQuery.crossFirstRelationName));
+    Table &table2 = *(tableCatalogue.getTable(parsedQuery.crossSecondRelationName));
 
     // Prepare column names for the resultant table
     vector<string> columns;
@@ -91,28 +91,32 @@ void executeCROSS()
 
     // Prepare cursors (now Cursor is defined)
     Cursor cursor1 = table1.getCursor();
-    Cursor cursor2 = table2.getCursor(); // Corrected type
 
-    vector<int> row1, row2;
-    vector<int> resultantRow;
-    resultantRow.reserve(resultantTable->columnCount); // Use member access
+    vector<int> resultantRow(resultantTable->columnCount); // Use member access
+    RowView resultantView(resultantRow.data(), resultantRow.size());
+    ofstream fout(resultantTable->sourceFileName, ios::app);
 
     // Perform the cross product
-    row1 = cursor1.getNext();
-    while (!row1.empty())
+    RowBatch batch1, batch2;
+    while (cursor1.nextBatch(batch1))
     {
-        cursor2 = table2.getCursor(); // Reset cursor2 for each row1
-        row2 = cursor2.getNext();     // Use corrected cursor2
-        while (!row2.empty())
+        for (int rowCounter1 = 0; rowCounter1 < batch1.rowCount; rowCounter1++)
         {
-            resultantRow.clear();
-            resultantRow.insert(resultantRow.end(), row1.begin(), row1.end());
-            resultantRow.insert(resultantRow.end(), row2.begin(), row2.end());
-            resultantTable->writeRow<int>(resultantRow); // Use member access
-            row2 = cursor2.getNext();                    // Use corrected cursor2
+            RowView row1 = batch1.row(rowCounter1);
+            copy(row1.begin(), row1.end(), resultantRow.begin());
+            Cursor cursor2 = table2.getCursor(); // Reset cursor2 for each row1
+            while (cursor2.nextBatch(batch2))
+            {
+                for (int rowCounter2 = 0; rowCounter2 < batch2.rowCount; rowCounter2++)
+                {
+                    RowView row2 = batch2.row(rowCounter2);
+                    copy(row2.begin(), row2.end(), resultantRow.begin() + row1.size());
+                    resultantTable->writeRow(resultantView, fout);
+                }
+            }
         }
-        row1 = cursor1.getNext();
     }
+    fout.close();
 
     // Finalize the resultant table
     resultantTable->blockify(); // Use member access
@@ -1,4 +1,5 @@
 #include "global.h"
+#include "indexing.h"
 #include <vector>
 #include <string>
 #include <regex> // For parsing
@@ -94,12 +95,6 @@ void executeDELETE()
         return;
     }
 
-    // --- Index Invalidation ---
-    if (!table->multiColumnIndexData.empty()) {
-        logger.log("Invalidating all indices on table '" + table->tableName + "' due to DELETE operation.");
-        table->clearIndex(); // Clear all column indices
-    }
-
     // --- Prepare for Deletion ---
     int whereColIdx = table->getColumnIndex(parsedQuery.selectionFirstColumnName);
     int valueToCompare = parsedQuery.selectionIntLiteral;
@@ -110,63 +105,89 @@ void executeDELETE()
         return;
     }
 
+    // An equality condition on an indexed column names the pages to visit
+    vector<bool> indexedPages;
+    bool useIndex = op == EQUAL && findIndexedPages(*table, whereColIdx, valueToCompare, indexedPages);
+
+    // --- Index Maintenance ---
+    // Every index follows the rows: the entries of a deleted row are removed
+    // and a row that compaction slides down is repointed to its new slot
+    vector<string> indexedColumns;
+    vector<int> indexedColumnIndexes;
+    vector<ColumnIndex *> indexes;
+    for (auto &index : table->indexes) {
+        indexedColumns.push_back(index.first);
+        indexedColumnIndexes.push_back(table->getColumnIndex(index.first));
+        indexes.push_back(index.second.get());
+    }
+    vector<bool> indexLost(indexes.size(), false);
+
     logger.log("Starting physical delete scan...");
     long long totalRowsDeleted = 0;
     vector<uint> newRowsPerBlockCount; // Build the new count vector
     newRowsPerBlockCount.reserve(table->blockCount); // Reserve capacity
 
     // --- Iterate through Pages and Modify ---
+    int pagesSkipped = 0;
     for (int pageIdx = 0; pageIdx < table->blockCount; ++pageIdx) {
-        Page currentPage = bufferManager.getPage(table->tableName, pageIdx);
-        int originalRowsInPage = table->rowsPerBlockCount[pageIdx]; // Get original count
-        vector<vector<int>> rowsToKeep; // Store rows that *don't* match the condition
-
-        // Read all rows from the current page
-        vector<vector<int>> currentPageData;
-        currentPageData.reserve(originalRowsInPage);
-         for(int i=0; i<originalRowsInPage; ++i) {
-            vector<int> row = currentPage.getRow(i);
-            if (!row.empty()) {
-                currentPageData.push_back(row);
-            } else {
-                 logger.log("executeDELETE WARNING: Reading page " + to_string(pageIdx) + ", got empty row at index " + to_string(i));
-            }
+        // Pages the index or the zone shows hold no matching row are not read at all
+        if ((useIndex && !indexedPages[pageIdx]) || !pageMayMatch(*table, pageIdx, whereColIdx, op, valueToCompare)) {
+            newRowsPerBlockCount.push_back(table->rowsPerBlockCount[pageIdx]);
+            pagesSkipped++;
+            continue;
         }
+        // Pinned for the whole page pass; rows are compacted in the pooled page,
+        // which is only marked dirty once a row is actually removed
+        PageHandle pageHandle = bufferManager.getPage(table->tableName, pageIdx);
+        int originalRowsInPage = table->rowsPerBlockCount[pageIdx]; // Get original count
+
         // Validate read count
-        if (currentPageData.size() != originalRowsInPage) {
-             logger.log("executeDELETE ERROR: Read " + to_string(currentPageData.size()) + " rows from page " + to_string(pageIdx) + ", but expected " + to_string(originalRowsInPage) + ". Skipping page modification.");
+        if (!pageHandle.isValid() || pageHandle->getRowCount() != originalRowsInPage || whereColIdx >= pageHandle->getColumnCount()) {
+             logger.log("executeDELETE ERROR: Read " + to_string(pageHandle.isValid() ? pageHandle->getRowCount() : 0) + " rows from page " + to_string(pageIdx) + ", but expected " + to_string(originalRowsInPage) + ". Skipping page modification.");
              newRowsPerBlockCount.push_back(originalRowsInPage); // Keep original count for this page
              continue; // Skip to next page
          }
-
-        // Filter rows: Keep rows that DON'T match the condition
-        int rowsDeletedThisPage = 0;
-        rowsToKeep.reserve(originalRowsInPage); // Reserve space
-        for (const auto& row : currentPageData) {
-            // Ensure row has the column before checking condition
-            if (whereColIdx >= (int)row.size()) {
-                 logger.log("executeDELETE WARNING: Row on page " + to_string(pageIdx) + " has too few columns for WHERE condition. Keeping row.");
-                 rowsToKeep.push_back(row); // Keep potentially malformed rows? Or discard? Let's keep.
-                 continue;
+        const Page &currentPage = *pageHandle;
+
+        // Compact in place: rows that DON'T match the condition slide down
+        // over the deleted ones, keeping their relative order. Cells are read
+        // one at a time (Page::getCell) and rows moved with Page::moveRow, so
+        // a PAX page is never transposed again after a write
+        int rowsKept = 0;
+        for (int rowIdx = 0; rowIdx < originalRowsInPage; ++rowIdx) {
+            bool deleted = evaluateBinOp(currentPage.getCell(rowIdx, whereColIdx), valueToCompare, op);
+            if (deleted || rowsKept != rowIdx) {
+                RecordPointer location = {(unsigned int)pageIdx, (unsigned int)rowIdx};
+                RecordPointer newLocation = {(unsigned int)pageIdx, (unsigned int)rowsKept};
+                for (size_t indexCounter = 0; indexCounter < indexes.size(); indexCounter++) {
+                    if (indexLost[indexCounter])
+                        continue;
+                    int key = currentPage.getCell(rowIdx, indexedColumnIndexes[indexCounter]);
+                    // A kept row only slides down over deleted rows, so its entry is repointed in place
+                    indexLost[indexCounter] = deleted ? !indexes[indexCounter]->remove(key, location)
+                                                      : !indexes[indexCounter]->repoint(key, location, newLocation);
+                }
             }
-
-            // Evaluate condition
-            if (!evaluateBinOp(row[whereColIdx], valueToCompare, op)) {
+            if (!deleted) {
                 // Condition is FALSE -> Keep the row
-                rowsToKeep.push_back(row);
+                if (rowsKept != rowIdx) {
+                    pageHandle.modify().moveRow(rowIdx, rowsKept);
+                }
+                rowsKept++;
             } else {
-                // Condition is TRUE -> Delete the row (by not adding it to rowsToKeep)
-                rowsDeletedThisPage++;
-                logger.log("Deleting row at {" + to_string(pageIdx) + ", <original index unknown>} based on condition.");
+                logger.log("Deleting row at {" + to_string(pageIdx) + ", " + to_string(rowIdx) + "} based on condition.");
             }
         }
+        int rowsDeletedThisPage = originalRowsInPage - rowsKept;
 
         // Update page file and metadata *only if rows were deleted* from this page
         if (rowsDeletedThisPage > 0) {
-            logger.log("Page " + to_string(pageIdx) + ": Deleted " + to_string(rowsDeletedThisPage) + " rows. New row count: " + to_string(rowsToKeep.size()));
-            // Write the remaining rows back to the *same* page file
-            bufferManager.writePage(table->tableName, pageIdx, rowsToKeep, rowsToKeep.size());
-            newRowsPerBlockCount.push_back(rowsToKeep.size()); // Store the new count
+            logger.log("Page " + to_string(pageIdx) + ": Deleted " + to_string(rowsDeletedThisPage) + " rows. New row count: " + to_string(rowsKept));
+            // Drop the tail; the page is written back on eviction or flush
+            pageHandle.modify().truncate(rowsKept);
+            table->zoneMap.setPage(pageIdx, currentPage);
+            table->bloomFilters.setPage(pageIdx, currentPage);
+            newRowsPerBlockCount.push_back(rowsKept); // Store the new count
             totalRowsDeleted += rowsDeletedThisPage;
         } else {
             // No rows deleted on this page, keep original count
@@ -174,18 +195,24 @@ void executeDELETE()
             logger.log("Page " + to_string(pageIdx) + ": No rows matched condition. Page unchanged.");
         }
     } 
+    logger.log("executeDELETE: Skipped " + to_string(pagesSkipped) + " of " + to_string(table->blockCount) + " pages.");
+    for (size_t indexCounter = 0; indexCounter < indexes.size(); indexCounter++) {
+        if (indexLost[indexCounter]) {
+            // The index did not hold a row it should have, so it cannot be trusted
+            logger.log("executeDELETE WARNING: Dropping the index on '" + indexedColumns[indexCounter] + "', which lost track of a row.");
+            table->indexes.erase(indexedColumns[indexCounter]);
+        }
+    }
 
     // --- Update Table Metadata ---
     if (totalRowsDeleted > 0) {
         table->rowCount -= totalRowsDeleted;
+        table->invalidateStatistics();
         table->rowsPerBlockCount = newRowsPerBlockCount; // Assign the updated vector
+        table->invalidateDescriptor();
         logger.log("Total rows deleted: " + to_string(totalRowsDeleted) + ". New table row count: " + to_string(table->rowCount));
         cout << "DELETE completed successfully. " << totalRowsDeleted << " rows deleted." << endl;
 
-        // Clear the buffer pool for this table as page contents and counts have changed
-        logger.log("Clearing buffer pool cache for table: " + table->tableName + " after DELETE.");
-        bufferManager.clearPoolForTable(table->tableName);
-
     } else {
         cout << "DELETE completed. No rows matched the WHERE condition." << endl;
         logger.log("No rows were deleted.");
@@ -4,6 +4,7 @@
 #include "syntacticParser.h"
 #include "table.h"  // Include full Table definition
 #include "cursor.h" // Include Cursor definition
+#include "hashPartitioner.h"
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -221,6 +222,57 @@ bool evaluateCondition(long long aggregateValue, const string &op, int condition
     return false;
 }
 
+/**
+ * @brief Applies the HAVING condition to every group and appends a
+ * {group value, RETURN aggregate} row to resultRows for each group that
+ * satisfies it.
+ *
+ * @param groups GroupValue -> { {HavingValues}, {ReturnValues} }
+ * @param resultRows
+ */
+void aggregateGroups(const unordered_map<int, pair<vector<int>, vector<int>>> &groups, vector<vector<int>> &resultRows)
+{
+    logger.log("executeGROUPBY: Processing groups and applying conditions...");
+    // Replace C++17 structured binding with C++11 compatible loop
+    for (auto it = groups.begin(); it != groups.end(); ++it)
+    {
+        int groupValue = it->first;
+        const pair<vector<int>, vector<int>> &valuePairs = it->second;
+        // for (auto const &[groupValue, valuePairs] : groups) // Replaced C++17 feature
+
+        const vector<int> &havingValues = valuePairs.first;
+        const vector<int> &returnValues = valuePairs.second;
+
+        if (havingValues.empty() || returnValues.empty())
+        {
+            // Should not happen if data was inserted correctly
+            logger.log("executeGROUPBY: Warning - Group " + to_string(groupValue) + " has empty value lists. Skipping.");
+            continue;
+        }
+
+        // Apply aggregate function for HAVING clause
+        long long havingAggResult = applyAggregate(parsedQuery.havingFunction, havingValues); // Now declared/defined
+
+        // Evaluate HAVING condition
+        int havingConditionValue = stoi(parsedQuery.havingValue);
+        if (evaluateCondition(havingAggResult, parsedQuery.havingOperator, havingConditionValue)) // Now declared/defined
+        {
+            // Apply aggregate function for RETURN clause
+            long long returnAggResult = applyAggregate(parsedQuery.returnFunction, returnValues); // Now declared/defined
+
+            // Prepare the row for the result table: {GroupValue, ReturnAggregateValue}
+            // Cast returnAggResult safely to int if necessary, handle potential overflow/truncation
+            int returnAggInt = static_cast<int>(returnAggResult);
+            if (returnAggResult > numeric_limits<int>::max() || returnAggResult < numeric_limits<int>::min())
+            {
+                logger.log("executeGROUPBY: Warning - Return aggregate result " + to_string(returnAggResult) + " for group " + to_string(groupValue) + " overflows int. Truncating.");
+                // Decide how to handle overflow: clamp, error, etc. Using static_cast truncates.
+            }
+            resultRows.push_back({groupValue, returnAggInt});
+        }
+    }
+}
+
 void executeGROUPBY()
 {
     logger.log("executeGROUPBY");
@@ -246,74 +298,77 @@ void executeGROUPBY()
 
     // Map to store intermediate results: GroupValue -> { {HavingValues}, {ReturnValues} }
     unordered_map<int, pair<vector<int>, vector<int>>> groups;
+    vector<vector<int>> resultRows;
+    string returnHeader = parsedQuery.returnFunction + parsedQuery.returnAttribute; // Construct return column header
+
+    // The groups keep two values per input row plus per-group vector overhead;
+    // if that does not fit in the grant the input is spilled into partitions
+    // by group value and each partition is aggregated on its own.
+    MemoryGrant grant = memoryManager.requestGrant("GROUP BY", 1);
+    size_t groupBytes = (size_t)inputTable->rowCount * 2 * sizeof(int) * 2;
+    int partitionCount = groupBytes <= grant.bytes() ? 1 : (int)((groupBytes + grant.bytes() - 1) / grant.bytes());
 
     // Iterate through the input table using a cursor
     Cursor cursor = inputTable->getCursor(); // Use member access, Cursor is now defined
-    vector<int> row;
+    RowBatch batch;
 
-    logger.log("executeGROUPBY: Starting data scan and grouping...");
-    while (!(row = cursor.getNext()).empty())
+    if (partitionCount == 1)
     {
-        // Basic row validation
-        if (row.size() < (unsigned)inputTable->columnCount) // Use member access
+        logger.log("executeGROUPBY: Starting data scan and grouping...");
+        while (cursor.nextBatch(batch))
         {
-            logger.log("executeGROUPBY: Warning - Skipping malformed row with size " + to_string(row.size()));
-            continue;
-        }
-
-        int groupValue = row[groupByIndex];
-        int havingValue = row[havingIndex];
-        int returnValue = row[returnIndex];
+            // Basic batch validation
+            if (batch.columnCount < (int)inputTable->columnCount) // Use member access
+            {
+                logger.log("executeGROUPBY: Warning - Skipping malformed rows with size " + to_string(batch.columnCount));
+                continue;
+            }
 
-        // Add values to the corresponding group
-        groups[groupValue].first.push_back(havingValue);
-        groups[groupValue].second.push_back(returnValue);
+            for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
+            {
+                RowView row = batch.row(rowCounter);
+                // Add values to the corresponding group
+                pair<vector<int>, vector<int>> &group = groups[row[groupByIndex]];
+                group.first.push_back(row[havingIndex]);
+                group.second.push_back(row[returnIndex]);
+            }
+        }
+        logger.log("executeGROUPBY: Finished data scan. Found " + to_string(groups.size()) + " unique groups.");
+        aggregateGroups(groups, resultRows);
     }
-    logger.log("executeGROUPBY: Finished data scan. Found " + to_string(groups.size()) + " unique groups.");
-
-    // Process groups: apply aggregates, check HAVING condition, prepare result rows
-    vector<vector<int>> resultRows;
-    string returnHeader = parsedQuery.returnFunction + parsedQuery.returnAttribute; // Construct return column header
-
-    logger.log("executeGROUPBY: Processing groups and applying conditions...");
-    // Replace C++17 structured binding with C++11 compatible loop
-    for (auto it = groups.begin(); it != groups.end(); ++it)
+    else
     {
-        int groupValue = it->first;
-        const pair<vector<int>, vector<int>> &valuePairs = it->second;
-        // for (auto const &[groupValue, valuePairs] : groups) // Replaced C++17 feature
-
-        const vector<int> &havingValues = valuePairs.first;
-        const vector<int> &returnValues = valuePairs.second;
-
-        if (havingValues.empty() || returnValues.empty())
+        logger.log("executeGROUPBY: Groups need about " + to_string(groupBytes) + " bytes, grant is " + to_string(grant.bytes()) + ". Spilling into " + to_string(partitionCount) + " partitions.");
+        // Only {group, having, return} is spilled for every row
+        HashPartitioner partitions(parsedQuery.resultTableName + "_GroupBy", partitionCount, 3);
+        int spilledRow[3];
+        while (cursor.nextBatch(batch))
         {
-            // Should not happen if data was inserted correctly
-            logger.log("executeGROUPBY: Warning - Group " + to_string(groupValue) + " has empty value lists. Skipping.");
-            continue;
+            for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
+            {
+                RowView row = batch.row(rowCounter);
+                spilledRow[0] = row[groupByIndex];
+                spilledRow[1] = row[havingIndex];
+                spilledRow[2] = row[returnIndex];
+                partitions.add(spilledRow[0], RowView(spilledRow, 3));
+            }
         }
+        partitions.finish();
 
-        // Apply aggregate function for HAVING clause
-        long long havingAggResult = applyAggregate(parsedQuery.havingFunction, havingValues); // Now declared/defined
-
-        // Evaluate HAVING condition
-        int havingConditionValue = stoi(parsedQuery.havingValue);
-        if (evaluateCondition(havingAggResult, parsedQuery.havingOperator, havingConditionValue)) // Now declared/defined
+        for (int partitionIndex = 0; partitionIndex < partitionCount; partitionIndex++)
         {
-            // Apply aggregate function for RETURN clause
-            long long returnAggResult = applyAggregate(parsedQuery.returnFunction, returnValues); // Now declared/defined
-
-            // Prepare the row for the result table: {GroupValue, ReturnAggregateValue}
-            // Cast returnAggResult safely to int if necessary, handle potential overflow/truncation
-            int returnAggInt = static_cast<int>(returnAggResult);
-            if (returnAggResult > numeric_limits<int>::max() || returnAggResult < numeric_limits<int>::min())
+            vector<int> rows = partitions.readPartition(partitionIndex);
+            groups.clear();
+            for (size_t offset = 0; offset < rows.size(); offset += 3)
             {
-                logger.log("executeGROUPBY: Warning - Return aggregate result " + to_string(returnAggResult) + " for group " + to_string(groupValue) + " overflows int. Truncating.");
-                // Decide how to handle overflow: clamp, error, etc. Using static_cast truncates.
+                pair<vector<int>, vector<int>> &group = groups[rows[offset]];
+                group.first.push_back(rows[offset + 1]);
+                group.second.push_back(rows[offset + 2]);
             }
-            resultRows.push_back({groupValue, returnAggInt});
+            aggregateGroups(groups, resultRows);
         }
     }
+
     logger.log("executeGROUPBY: Finished processing groups. " + to_string(resultRows.size()) + " groups satisfy the HAVING condition.");
 
     // Create the result table
@@ -3,29 +3,50 @@
 #include "tableCatalogue.h"  // Include for tableCatalogue access
 #include "syntacticParser.h" // Include for parsedQuery access
 #include "table.h"           // Include full Table definition
-#include "indexing.h"        // Include BPTree definition
+#include "indexBuilder.h"    // Include IndexBuild definition
 
 using namespace std;
 
 /**
  * @brief
- * SYNTAX: INDEX ON column_name FROM relation_name USING indexing_strategy
- * NOTE: This command is DISABLED as indexing is now implicit on column 0.
+ * SYNTAX: INDEX ON column_name FROM relation_name USING indexing_strategy [BACKGROUND]
+ * indexing_strategy: BTREE | HASH | NOTHING
+ * BTREE and HASH build the index (see BPTree, HashIndex), replacing the
+ * column's current index; NOTHING drops it. BACKGROUND builds the index on
+ * a separate thread (see IndexBuild) and returns at once. LIST INDEXES shows
+ * the indexes.
  */
 bool syntacticParseINDEX()
 {
     logger.log("syntacticParseINDEX");
-    cout << "INDEX command is disabled; indexing is implicit on the first column during LOAD." << endl;
-    return false;
+    bool background = tokenizedQuery.size() == 8 && tokenizedQuery[7] == "BACKGROUND";
+    if ((tokenizedQuery.size() != 7 && !background) || tokenizedQuery[1] != "ON" || tokenizedQuery[3] != "FROM" || tokenizedQuery[5] != "USING")
+    {
+        cout << "SYNTAX ERROR: Expected INDEX ON <column_name> FROM <relation_name> USING BTREE|HASH|NOTHING [BACKGROUND]" << endl;
+        return false;
+    }
+    parsedQuery.queryType = INDEX;
+    parsedQuery.indexColumnName = tokenizedQuery[2];
+    parsedQuery.indexRelationName = tokenizedQuery[4];
+    string indexingStrategy = tokenizedQuery[6];
+    if (indexingStrategy == "BTREE")
+        parsedQuery.indexingStrategy = BTREE;
+    else if (indexingStrategy == "HASH")
+        parsedQuery.indexingStrategy = HASH;
+    else if (indexingStrategy == "NOTHING" && !background)
+        parsedQuery.indexingStrategy = NOTHING;
+    else
+    {
+        cout << "SYNTAX ERROR: Unknown indexing strategy '" << indexingStrategy << "'" << (background ? " for a background build" : "") << endl;
+        return false;
+    }
+    parsedQuery.indexInBackground = background;
+    return true;
 }
 
 bool semanticParseINDEX()
 {
     logger.log("semanticParseINDEX");
-    // Disable explicit INDEX command
-    cout << "SEMANTIC ERROR: INDEX command is disabled." << endl;
-    return false;
-    /* --- Original Code Disabled ---
     if (!tableCatalogue.isTable(parsedQuery.indexRelationName))
     {
         cout << "SEMANTIC ERROR: Relation '" << parsedQuery.indexRelationName << "' does not exist." << endl;
@@ -37,20 +58,38 @@ bool semanticParseINDEX()
         cout << "SEMANTIC ERROR: Column '" << parsedQuery.indexColumnName << "' does not exist in relation '" << parsedQuery.indexRelationName << "'." << endl;
         return false;
     }
-    Table* table = tableCatalogue.getTable(parsedQuery.indexRelationName);
-    // Allow removing index even if table->indexed is false (harmless)
-    // if(table->indexed && parsedQuery.indexingStrategy != NOTHING){ // Check if already indexed only if creating new
-    //     cout << "SEMANTIC ERROR: Table already indexed" << endl;
-    //     return false;
-    // }
+    Table *table = tableCatalogue.getTable(parsedQuery.indexRelationName);
+    if (parsedQuery.indexingStrategy == NOTHING && !table->isIndexed(parsedQuery.indexColumnName))
+    {
+        cout << "SEMANTIC ERROR: Column '" << parsedQuery.indexColumnName << "' of relation '" << parsedQuery.indexRelationName << "' is not indexed." << endl;
+        return false;
+    }
     return true;
-    */
 }
 
 void executeINDEX()
 {
     logger.log("executeINDEX");
-    // Command is disabled
-    cout << "LOGIC ERROR: executeINDEX called but command is disabled." << endl;
-    return;
-}
\ No newline at end of file
+    Table *table = tableCatalogue.getTable(parsedQuery.indexRelationName);
+    const string &columnName = parsedQuery.indexColumnName;
+    if (parsedQuery.indexingStrategy == NOTHING)
+    {
+        table->indexes.erase(columnName); // Deletes the index pages
+        cout << "Index on column '" << columnName << "' of '" << table->tableName << "' dropped." << endl;
+        return;
+    }
+
+    vector<string> hashColumnNames;
+    if (parsedQuery.indexingStrategy == HASH)
+        hashColumnNames.push_back(columnName);
+    if (!buildIndexes(*table, vector<string>(1, columnName), hashColumnNames, parsedQuery.indexInBackground))
+    {
+        cout << "ERROR: Failed to index column '" << columnName << "' of '" << table->tableName << "'." << endl;
+        return;
+    }
+    const char *strategyName = parsedQuery.indexingStrategy == HASH ? "HASH" : "BTREE";
+    if (parsedQuery.indexInBackground)
+        cout << strategyName << " index on column '" << columnName << "' of '" << table->tableName << "' is being built in the background." << endl;
+    else
+        cout << strategyName << " index on column '" << columnName << "' of '" << table->tableName << "' created." << endl;
+}
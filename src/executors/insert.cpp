@@ -1,4 +1,5 @@
 #include "global.h"
+#include "indexing.h"
 #include <vector> 
 #include <string> 
 #include <sstream> 
@@ -181,28 +182,24 @@ void executeINSERT()
             targetRowIdx = rowsInLastPage;
             logger.log("Appending row to existing page " + to_string(targetPageIdx) + " at row index " + to_string(targetRowIdx));
 
-            Page targetPage = bufferManager.getPage(table->tableName, targetPageIdx);
-            vector<vector<int>> pageData;
-            pageData.reserve(rowsInLastPage + 1);
-            for(int i=0; i < rowsInLastPage; ++i) {
-                 vector<int> existingRow = targetPage.getRow(i);
-                 if (!existingRow.empty()) { pageData.push_back(std::move(existingRow)); }
-                 else { logger.log("executeINSERT WARNING: Reading page " + to_string(targetPageIdx) + ", got empty row at " + to_string(i) + ". Skipping."); }
-            }
-            if (pageData.size() != rowsInLastPage) {
-                  logger.log("executeINSERT ERROR: Read " + to_string(pageData.size()) + " rows from page " + to_string(targetPageIdx) + ", expected " + to_string(rowsInLastPage) + ". Aborting.");
+            PageHandle pageHandle = bufferManager.getPage(table->tableName, targetPageIdx);
+            if (!pageHandle.isValid() || pageHandle->getRowCount() != rowsInLastPage) {
+                  logger.log("executeINSERT ERROR: Read " + to_string(pageHandle.isValid() ? pageHandle->getRowCount() : 0) + " rows from page " + to_string(targetPageIdx) + ", expected " + to_string(rowsInLastPage) + ". Aborting.");
                   return;
             }
-            pageData.push_back(rowToInsert);
-            bufferManager.writePage(table->tableName, targetPageIdx, pageData, pageData.size());
+            // Append to the pooled page itself; it is written back on eviction or flush
+            pageHandle.modify().appendRow(rowToInsert);
             table->rowsPerBlockCount[lastPageIndex]++;
+            // Filters sized for a short last page are rebuilt as it fills up
+            if (table->bloomFilters.isOverloaded(targetPageIdx))
+                table->bloomFilters.setPage(targetPageIdx, *pageHandle);
 
         } else { // Last page is full
             targetPageIdx = table->blockCount;
             targetRowIdx = 0;
             logger.log("Last page full. Creating new page " + to_string(targetPageIdx) + " for the row.");
             vector<vector<int>> newPageData = {rowToInsert}; // Initial data for new page
-            bufferManager.writePage(table->tableName, targetPageIdx, newPageData, 1);
+            bufferManager.writePage(table->tableName, targetPageIdx, newPageData, 1, table->layout);
             table->blockCount++;
             table->rowsPerBlockCount.push_back(1);
         }
@@ -211,37 +208,41 @@ void executeINSERT()
         targetRowIdx = 0;
         logger.log("Table empty. Creating first page (page 0) for the row.");
         vector<vector<int>> newPageData = {rowToInsert};
-        bufferManager.writePage(table->tableName, targetPageIdx, newPageData, 1);
+        bufferManager.writePage(table->tableName, targetPageIdx, newPageData, 1, table->layout);
         table->blockCount = 1;
         table->rowsPerBlockCount.push_back(1);
     }
 
     // 4. Update table total row count
     table->rowCount++;
+    table->invalidateDescriptor();
+    // Widen the zone and filters of the page the row went to (or start the new page's)
+    table->zoneMap.addRow(targetPageIdx, RowView(rowToInsert.data(), rowToInsert.size()));
+    table->bloomFilters.addRow(targetPageIdx, RowView(rowToInsert.data(), rowToInsert.size()));
+    table->invalidateStatistics();
 
-    // 5. Update the implicit indices for ALL columns
+    // 5. Add the row to every column index
     if (targetPageIdx != -1 && targetRowIdx != -1) {
         logger.log("Updating all column indices for inserted row...");
-        Table::RowLocation location = {targetPageIdx, targetRowIdx};
-        for(int colIdx = 0; colIdx < table->columnCount; ++colIdx) {
-            string colName = table->columns[colIdx];
-            int key = rowToInsert[colIdx]; // Get the key from the *final* inserted row vector
-            if (table->multiColumnIndexData.count(colName)) {
-                 table->multiColumnIndexData[colName][key] = location;
-                 // logger.log("Updated index for col '" + colName + "' key " + to_string(key)); // Verbose
-            } else {
-                logger.log("executeINSERT WARNING: No index map found for column '" + colName + "' to update.");
+        RecordPointer location = {(unsigned int)targetPageIdx, (unsigned int)targetRowIdx};
+        vector<string> lostIndexes;
+        for (auto &index : table->indexes) {
+            int key = rowToInsert[table->getColumnIndex(index.first)]; // Get the key from the *final* inserted row vector
+            if (!index.second->insert(key, location)) {
+                lostIndexes.push_back(index.first);
             }
         }
+        for (const string &columnName : lostIndexes) {
+            // An index missing the row would silently leave it out of searches
+            logger.log("executeINSERT WARNING: Dropping the index on '" + columnName + "', which could not add the row.");
+            table->indexes.erase(columnName);
+        }
         logger.log("Finished updating indices for insert at location {" + to_string(targetPageIdx) + "," + to_string(targetRowIdx) + "}");
     } else {
          logger.log("executeINSERT ERROR: targetPageIdx or targetRowIdx invalid after insert logic. Index not updated.");
     }
 
     cout << "Row inserted into " << table->tableName << ". New Row Count: " << table->rowCount << endl;
-    // Clear buffer pool pages for this table to  re-read with updated metadata next time
-    logger.log("Clearing buffer pool cache for table: " + table->tableName);
-    bufferManager.clearPoolForTable(table->tableName);
 
     return;
 }
\ No newline at end of file
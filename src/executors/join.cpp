@@ -4,6 +4,8 @@
 #include "syntacticParser.h"
 #include "table.h"  // Include full Table definition
 #include "cursor.h" // Include Cursor definition
+#include "hashPartitioner.h"
+#include "indexing.h"
 #include <vector>
 #include <string>
 #include <unordered_map> // For hash join
@@ -57,6 +59,185 @@ bool semanticParseJOIN()
     return true;
 }
 
+/**
+ * @brief Build side of a hash join held in memory: the rows of the smaller
+ * table back to back, and for every join key the offsets of its rows.
+ */
+struct JoinHashTable
+{
+    vector<int> rows;
+    int columnCount = 0;
+    unordered_map<int, vector<size_t>> rowsByKey;
+
+    void build(int keyIndex)
+    {
+        this->rowsByKey.clear();
+        for (size_t offset = 0; offset < this->rows.size(); offset += this->columnCount)
+        {
+            this->rowsByKey[this->rows[offset + keyIndex]].push_back(offset);
+        }
+    }
+};
+
+/**
+ * @brief Probes the hash table with one row of the larger table and writes
+ * every joined row, keeping the columns of the first relation first.
+ */
+static void probeJoinHashTable(const JoinHashTable &hashTable, const RowView &row, int keyIndex, bool buildIsFirst,
+                               Table *resultantTable, ofstream &fout, vector<int> &resultantRow)
+{
+    auto match = hashTable.rowsByKey.find(row[keyIndex]);
+    if (match == hashTable.rowsByKey.end())
+        return;
+
+    for (size_t offset : match->second)
+    {
+        const int *buildRow = hashTable.rows.data() + offset;
+        resultantRow.clear();
+        if (buildIsFirst)
+        {
+            resultantRow.insert(resultantRow.end(), buildRow, buildRow + hashTable.columnCount);
+            resultantRow.insert(resultantRow.end(), row.begin(), row.end());
+        }
+        else
+        {
+            resultantRow.insert(resultantRow.end(), row.begin(), row.end());
+            resultantRow.insert(resultantRow.end(), buildRow, buildRow + hashTable.columnCount);
+        }
+        resultantTable->writeRow(RowView(resultantRow.data(), resultantRow.size()), fout);
+    }
+}
+
+/**
+ * @brief Whether a page of the probe table may hold a row that joins with
+ * the build side, whose keys lie in [minKey, maxKey]: the page's zone must
+ * overlap that range and, if the probe column has Bloom filters, one of the
+ * keys must pass the page's filter. The keys are only tested when there are
+ * no more of them than rows in the page; otherwise probing the page is
+ * cheaper than testing them.
+ *
+ * @param keys the build side's distinct keys, nullptr to use the zone only
+ */
+static bool probePageMayMatch(const Table &probeTable, int pageIndex, int keyIndex, int minKey, int maxKey, const vector<int> *keys)
+{
+    if (!pageMayMatch(probeTable, pageIndex, keyIndex, GEQ, minKey) || !pageMayMatch(probeTable, pageIndex, keyIndex, LEQ, maxKey))
+        return false;
+    if (keys == nullptr || !probeTable.bloomFilters.hasColumn(keyIndex) || pageIndex >= (int)probeTable.rowsPerBlockCount.size() ||
+        keys->size() > probeTable.rowsPerBlockCount[pageIndex])
+        return true;
+    for (int key : *keys)
+    {
+        if (probeTable.bloomFilters.mayContain(pageIndex, keyIndex, key))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief The hash index on a join column, which can serve as the build side
+ * of the join as it is, or nullptr. B+ trees are not used here: probing one
+ * reads a path of nodes per row, more than building a hash table costs.
+ */
+static shared_ptr<ColumnIndex> getJoinHashIndex(Table *table, const string &columnName)
+{
+    auto index = table->indexes.find(columnName);
+    if (index == table->indexes.end() || index->second->isOrdered())
+        return nullptr;
+    return index->second;
+}
+
+/**
+ * @brief Range of a column over the whole table, from the zone map.
+ *
+ * @return false if a page has no zone for the column
+ */
+static bool getColumnRange(const Table &table, int columnIndex, int &minValue, int &maxValue, bool &isEmpty)
+{
+    isEmpty = true;
+    for (int pageIndex = 0; pageIndex < (int)table.blockCount; pageIndex++)
+    {
+        if (!table.zoneMap.covers(pageIndex, columnIndex))
+            return false;
+        if (table.zoneMap.isEmpty(pageIndex))
+            continue;
+        minValue = isEmpty ? table.zoneMap.getMin(pageIndex, columnIndex) : min(minValue, table.zoneMap.getMin(pageIndex, columnIndex));
+        maxValue = isEmpty ? table.zoneMap.getMax(pageIndex, columnIndex) : max(maxValue, table.zoneMap.getMax(pageIndex, columnIndex));
+        isEmpty = false;
+    }
+    return true;
+}
+
+/**
+ * @brief Index nested loop join: every row of the probe table is looked up
+ * in the hash index of the other table, whose matching rows are read from
+ * the pool, so the indexed table is neither scanned nor hashed. Pages of the
+ * probe table outside the indexed column's range are not read.
+ */
+static void indexJoin(Table *probeTable, int probeKeyIndex, Table *indexedTable, int indexedKeyIndex, ColumnIndex &index,
+                      bool indexedIsFirst, Table *resultantTable, ofstream &fout)
+{
+    logger.log("executeJOIN: Probing the " + string(index.getStrategyName()) + " index " + index.getIndexName() + " with " + probeTable->tableName);
+    int minKey = 0;
+    int maxKey = 0;
+    bool indexedIsEmpty = true;
+    bool hasRange = getColumnRange(*indexedTable, indexedKeyIndex, minKey, maxKey, indexedIsEmpty);
+    function<bool(int)> pageFilter;
+    if (hasRange)
+        pageFilter = [&](int pageIndex) { return !indexedIsEmpty && probePageMayMatch(*probeTable, pageIndex, probeKeyIndex, minKey, maxKey, nullptr); };
+    Cursor cursor = probeTable->getCursor(pageFilter);
+
+    RowBatch batch;
+    vector<int> resultantRow;
+    PageHandle pageHandle;
+    unsigned int pinnedPageIndex = INVALID_PAGE_ID;
+    while (cursor.nextBatch(batch))
+    {
+        for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
+        {
+            RowView row = batch.row(rowCounter);
+            for (const RecordPointer &pointer : index.search(row[probeKeyIndex]))
+            {
+                if (pointer.pageId != pinnedPageIndex)
+                {
+                    pageHandle.release();
+                    pinnedPageIndex = INVALID_PAGE_ID;
+                    pageHandle = bufferManager.getPage(indexedTable->tableName, pointer.pageId);
+                    if (!pageHandle.isValid())
+                    {
+                        logger.log("executeJOIN ERROR: Cannot read page " + to_string(pointer.pageId) + " of " + indexedTable->tableName);
+                        continue;
+                    }
+                    pinnedPageIndex = pointer.pageId;
+                }
+                RowView indexedRow = pageHandle->getRowView(pointer.rowIndex);
+                resultantRow.clear();
+                if (indexedIsFirst)
+                {
+                    resultantRow.insert(resultantRow.end(), indexedRow.begin(), indexedRow.end());
+                    resultantRow.insert(resultantRow.end(), row.begin(), row.end());
+                }
+                else
+                {
+                    resultantRow.insert(resultantRow.end(), row.begin(), row.end());
+                    resultantRow.insert(resultantRow.end(), indexedRow.begin(), indexedRow.end());
+                }
+                resultantTable->writeRow(RowView(resultantRow.data(), resultantRow.size()), fout);
+            }
+        }
+    }
+    logger.log("executeJOIN: Skipped " + to_string(cursor.skippedPages) + " of " + to_string(probeTable->blockCount) + " probe pages.");
+}
+
+/**
+ * @brief Hash join. If either join column has a hash index, that index is
+ * the build side (see indexJoin), the larger table's if both do. Otherwise
+ * the smaller table is the build side. If its hash table
+ * fits in the JOIN memory grant the join runs in memory in one pass;
+ * otherwise both tables are first hash partitioned on the join key into
+ * spill files (Grace hash join) and each partition pair is joined in memory.
+ * Pages of the larger table that cannot hold any build key (see
+ * probePageMayMatch) are not read.
+ */
 void executeJOIN()
 {
     logger.log("executeJOIN");
@@ -64,7 +245,7 @@ void executeJOIN()
     Table *table1 = tableCatalogue.getTable(parsedQuery.joinFirstRelationName);
     Table *table2 = tableCatalogue.getTable(parsedQuery.joinSecondRelationName);
 
-    // Determine which table is smaller for potential optimization (e.g., hash join)
+    // The smaller table is the build side of the hash join
     Table *smallerTable = (table1->rowCount <= table2->rowCount) ? table1 : table2; // Use member access
     Table *largerTable = (table1->rowCount > table2->rowCount) ? table1 : table2;   // Use member access
 
@@ -73,54 +254,119 @@ void executeJOIN()
 
     int smallerIndex = smallerTable->getColumnIndex(smallerColumn); // Use member access
     int largerIndex = largerTable->getColumnIndex(largerColumn);    // Use member access
+    bool buildIsFirst = (smallerTable == table1);
 
-    // --- Hash Join Implementation ---
-    unordered_map<int, vector<vector<int>>> hashTable;
-    Cursor cursor = smallerTable->getCursor(); // Cursor is now defined, use member access
-    vector<int> row;
-
-    // 1. Build Phase: Populate hash table with rows from the smaller table
-    logger.log("executeJOIN: Building hash table from smaller table: " + smallerTable->tableName);
-    while (!(row = cursor.getNext()).empty())
-    {
-        hashTable[row[smallerIndex]].push_back(row);
-    }
-    logger.log("executeJOIN: Hash table built with " + to_string(hashTable.size()) + " unique keys.");
+    // The hash table needs about twice the raw size of the build rows
+    MemoryGrant grant = memoryManager.requestGrant("JOIN", 1);
+    size_t buildBlocks = (size_t)smallerTable->blockCount * 2;
+    int partitionCount = buildBlocks <= grant.blocks() ? 1 : (int)((buildBlocks + grant.blocks() - 1) / grant.blocks());
 
     // Prepare resultant table
     vector<string> resultantColumns = table1->columns;                                               // Use member access
     resultantColumns.insert(resultantColumns.end(), table2->columns.begin(), table2->columns.end()); // Use member access
     Table *resultantTable = new Table(parsedQuery.joinResultRelationName, resultantColumns);         // Table is now defined
-
-    // 2. Probe Phase: Iterate through the larger table and probe the hash table
-    logger.log("executeJOIN: Probing hash table with larger table: " + largerTable->tableName);
-    cursor = largerTable->getCursor(); // Use member access
+    ofstream fout(resultantTable->sourceFileName, ios::app);
     vector<int> resultantRow;
 
-    while (!(row = cursor.getNext()).empty())
+    JoinHashTable hashTable;
+    hashTable.columnCount = smallerTable->columnCount;
+    RowBatch batch;
+
+    shared_ptr<ColumnIndex> firstIndex = getJoinHashIndex(table1, parsedQuery.joinFirstColumnName);
+    shared_ptr<ColumnIndex> secondIndex = getJoinHashIndex(table2, parsedQuery.joinSecondColumnName);
+    if (firstIndex != nullptr || secondIndex != nullptr)
     {
-        int key = row[largerIndex];
-        if (hashTable.count(key))
+        bool indexedIsFirst = firstIndex != nullptr && (secondIndex == nullptr || table1->rowCount >= table2->rowCount);
+        int firstKeyIndex = table1->getColumnIndex(parsedQuery.joinFirstColumnName);
+        int secondKeyIndex = table2->getColumnIndex(parsedQuery.joinSecondColumnName);
+        if (indexedIsFirst)
+            indexJoin(table2, secondKeyIndex, table1, firstKeyIndex, *firstIndex, true, resultantTable, fout);
+        else
+            indexJoin(table1, firstKeyIndex, table2, secondKeyIndex, *secondIndex, false, resultantTable, fout);
+    }
+    else if (partitionCount == 1)
+    {
+        // 1. Build Phase: Populate hash table with rows from the smaller table
+        logger.log("executeJOIN: Building hash table from smaller table: " + smallerTable->tableName);
+        Cursor cursor = smallerTable->getCursor();
+        while (cursor.nextBatch(batch))
+        {
+            hashTable.rows.insert(hashTable.rows.end(), batch.data, batch.data + (size_t)batch.rowCount * batch.columnCount);
+        }
+        hashTable.build(smallerIndex);
+        logger.log("executeJOIN: Hash table built with " + to_string(hashTable.rowsByKey.size()) + " unique keys.");
+        vector<int> buildKeys;
+        buildKeys.reserve(hashTable.rowsByKey.size());
+        for (const auto &entry : hashTable.rowsByKey)
         {
-            // Found matching keys in the hash table
-            for (const auto &smallerTableRow : hashTable[key])
+            buildKeys.push_back(entry.first);
+        }
+        int minKey = buildKeys.empty() ? 0 : *min_element(buildKeys.begin(), buildKeys.end());
+        int maxKey = buildKeys.empty() ? 0 : *max_element(buildKeys.begin(), buildKeys.end());
+
+        // 2. Probe Phase: Iterate through the larger table and probe the hash table
+        logger.log("executeJOIN: Probing hash table with larger table: " + largerTable->tableName);
+        cursor = largerTable->getCursor([&](int pageIndex) { return !buildKeys.empty() && probePageMayMatch(*largerTable, pageIndex, largerIndex, minKey, maxKey, &buildKeys); });
+        while (cursor.nextBatch(batch))
+        {
+            for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
             {
-                resultantRow.clear();
-                // Combine rows based on which table was smaller/larger
-                if (smallerTable == table1)
-                {
-                    resultantRow.insert(resultantRow.end(), smallerTableRow.begin(), smallerTableRow.end());
-                    resultantRow.insert(resultantRow.end(), row.begin(), row.end());
-                }
-                else
-                {
-                    resultantRow.insert(resultantRow.end(), row.begin(), row.end());
-                    resultantRow.insert(resultantRow.end(), smallerTableRow.begin(), smallerTableRow.end());
-                }
-                resultantTable->writeRow<int>(resultantRow); // Use member access
+                probeJoinHashTable(hashTable, batch.row(rowCounter), largerIndex, buildIsFirst, resultantTable, fout, resultantRow);
+            }
+        }
+        logger.log("executeJOIN: Skipped " + to_string(cursor.skippedPages) + " of " + to_string(largerTable->blockCount) + " probe pages.");
+    }
+    else
+    {
+        // 1. Partition Phase: spill both tables by the hash of the join key
+        logger.log("executeJOIN: Build side needs " + to_string(buildBlocks) + " blocks, grant is " + to_string(grant.blocks()) + ". Partitioning into " + to_string(partitionCount) + " partitions.");
+        HashPartitioner buildPartitions(resultantTable->tableName + "_JoinBuild", partitionCount, smallerTable->columnCount);
+        HashPartitioner probePartitions(resultantTable->tableName + "_JoinProbe", partitionCount, largerTable->columnCount);
+        Cursor cursor = smallerTable->getCursor();
+        long long buildRowCount = 0;
+        int minKey = 0;
+        int maxKey = 0;
+        while (cursor.nextBatch(batch))
+        {
+            for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
+            {
+                RowView row = batch.row(rowCounter);
+                buildPartitions.add(row[smallerIndex], row);
+                minKey = buildRowCount == 0 ? row[smallerIndex] : min(minKey, row[smallerIndex]);
+                maxKey = buildRowCount == 0 ? row[smallerIndex] : max(maxKey, row[smallerIndex]);
+                buildRowCount++;
+            }
+        }
+        // The build keys are not all in memory here, so only their range is used
+        cursor = largerTable->getCursor([&](int pageIndex) { return buildRowCount > 0 && probePageMayMatch(*largerTable, pageIndex, largerIndex, minKey, maxKey, nullptr); });
+        while (cursor.nextBatch(batch))
+        {
+            for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
+            {
+                RowView row = batch.row(rowCounter);
+                probePartitions.add(row[largerIndex], row);
+            }
+        }
+        logger.log("executeJOIN: Skipped " + to_string(cursor.skippedPages) + " of " + to_string(largerTable->blockCount) + " probe pages.");
+        buildPartitions.finish();
+        probePartitions.finish();
+
+        // 2. Build and probe each partition pair in memory
+        for (int partitionIndex = 0; partitionIndex < partitionCount; partitionIndex++)
+        {
+            if (buildPartitions.getRowCount(partitionIndex) == 0 || probePartitions.getRowCount(partitionIndex) == 0)
+                continue;
+            hashTable.rows = buildPartitions.readPartition(partitionIndex);
+            hashTable.build(smallerIndex);
+            vector<int> probeRows = probePartitions.readPartition(partitionIndex);
+            for (size_t offset = 0; offset < probeRows.size(); offset += largerTable->columnCount)
+            {
+                RowView row(probeRows.data() + offset, largerTable->columnCount);
+                probeJoinHashTable(hashTable, row, largerIndex, buildIsFirst, resultantTable, fout, resultantRow);
             }
         }
     }
+    fout.close();
     logger.log("executeJOIN: Probe phase complete.");
 
     // Finalize the resultant table
@@ -1,17 +1,21 @@
 #include "global.h"
+#include <iomanip>
 /**
  * @brief 
  * SYNTAX: LIST TABLES
+ *         LIST INDEXES
+ *         LIST BUFFER
  */
 bool syntacticParseLIST()
 {
     logger.log("syntacticParseLIST");
-    if (tokenizedQuery.size() != 2 || tokenizedQuery[1] != "TABLES")
+    if (tokenizedQuery.size() != 2 || (tokenizedQuery[1] != "TABLES" && tokenizedQuery[1] != "INDEXES" && tokenizedQuery[1] != "BUFFER"))
     {
         cout << "SYNTAX ERROR" << endl;
         return false;
     }
     parsedQuery.queryType = LIST;
+    parsedQuery.listObject = tokenizedQuery[1];
     return true;
 }
 
@@ -21,8 +25,43 @@ bool semanticParseLIST()
     return true;
 }
 
+/**
+ * @brief Prints the replacement policy of the buffer pool with its hit, miss
+ * and eviction counters, and how many read-ahead pages were used.
+ */
+static void printBufferStatistics()
+{
+    const ReplacementPolicy &policy = bufferManager.getReplacementPolicy();
+    long long requests = policy.hits + policy.misses;
+    cout << "Replacement policy: " << policy.getName() << endl;
+    cout << "Frames in use: " << bufferManager.getResidentCount() << "/" << bufferManager.getCapacity() << endl;
+    cout << "Hits: " << policy.hits << endl;
+    cout << "Misses: " << policy.misses << endl;
+    cout << "Evictions: " << policy.evictions << endl;
+    cout << "Page access: " << (bufferManager.getMappedReads() ? "memory-mapped" : "buffered reads") << endl;
+    cout << "Page compression: " << (bufferManager.getPageCompression() ? "on" : "off") << endl;
+    if (bufferManager.rawBytesWritten > 0)
+    {
+        cout << "Pages written: " << bufferManager.pagesWritten << " (" << bufferManager.storedBytesWritten << " of "
+             << bufferManager.rawBytesWritten << " bytes, " << fixed << setprecision(2)
+             << 100.0 * bufferManager.storedBytesWritten / bufferManager.rawBytesWritten << "%)" << defaultfloat << endl;
+    }
+    cout << "Read-ahead depth: " << bufferManager.getPrefetchDepth() << " pages ("
+         << bufferManager.getPrefetcher().usedCount << " used, "
+         << bufferManager.getPrefetcher().droppedCount << " dropped)" << endl;
+    if (requests > 0)
+    {
+        cout << "Hit ratio: " << fixed << setprecision(2) << 100.0 * policy.hits / requests << "%" << defaultfloat << endl;
+    }
+}
+
 void executeLIST()
 {
     logger.log("executeLIST");
-    tableCatalogue.print();
-}
\ No newline at end of file
+    if (parsedQuery.listObject == "BUFFER")
+        printBufferStatistics();
+    else if (parsedQuery.listObject == "INDEXES")
+        tableCatalogue.printIndexes();
+    else
+        tableCatalogue.print();
+}
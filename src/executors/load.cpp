@@ -1,20 +1,75 @@
 #include "global.h"
+#include "ingestSink.h"
+#include "indexBuilder.h"
+#include <algorithm>
 #include <string> // For string
 
+/**
+ * @brief Collects the column names after the keyword at tokenIndex, up to
+ * the next LOAD keyword or the end of the query.
+ *
+ * @param keyword
+ * @param tokenIndex advanced past the keyword and its columns
+ * @param columnNames
+ * @return true if the keyword is present
+ */
+static bool parseColumnList(const string &keyword, size_t &tokenIndex, vector<string> &columnNames)
+{
+    static const vector<string> keywords = {"BTREE", "HASH", "BLOOM", "BACKGROUND"};
+    if (tokenIndex >= tokenizedQuery.size() || tokenizedQuery[tokenIndex] != keyword)
+        return false;
+    for (tokenIndex++; tokenIndex < tokenizedQuery.size() && find(keywords.begin(), keywords.end(), tokenizedQuery[tokenIndex]) == keywords.end(); tokenIndex++)
+        columnNames.push_back(tokenizedQuery[tokenIndex]);
+    return true;
+}
+
 /**
  * @brief
- * SYNTAX: LOAD relation_name
+ * SYNTAX: LOAD relation_name [COLUMNAR] [BTREE column_name ...] [HASH column_name ...] [BLOOM column_name ...] [BACKGROUND]
+ * COLUMNAR stores the table's pages in the PAX layout (see PageLayout).
+ * No column is indexed unless it is named: BTREE indexes the named columns
+ * with a B+ tree (see BPTree), HASH with a hash index (see HashIndex) for
+ * columns that are only looked up by equality. INDEX ON adds or drops
+ * indexes later. BACKGROUND builds these indexes on a separate thread after
+ * the table is loaded (see IndexBuild) instead of while it loads.
+ * BLOOM keeps per-page Bloom filters on the named columns, so equality
+ * conditions and joins on them skip the pages without the key.
  */
 bool syntacticParseLOAD()
 {
     logger.log("syntacticParseLOAD");
-    if (tokenizedQuery.size() != 2)
+    size_t tokenIndex = 2;
+    bool columnar = tokenIndex < tokenizedQuery.size() && tokenizedQuery[tokenIndex] == "COLUMNAR";
+    if (columnar)
+        tokenIndex++;
+    vector<string> indexColumns, hashColumns, bloomColumns;
+    bool btree = parseColumnList("BTREE", tokenIndex, indexColumns);
+    bool hash = parseColumnList("HASH", tokenIndex, hashColumns);
+    bool bloom = parseColumnList("BLOOM", tokenIndex, bloomColumns);
+    bool background = tokenIndex < tokenizedQuery.size() && tokenizedQuery[tokenIndex] == "BACKGROUND";
+    if (background)
+        tokenIndex++;
+    for (const string &columnName : hashColumns)
+    {
+        if (find(indexColumns.begin(), indexColumns.end(), columnName) != indexColumns.end())
+        {
+            cout << "SYNTAX ERROR: Column '" << columnName << "' is named for both a BTREE and a HASH index" << endl;
+            return false;
+        }
+    }
+    if (tokenizedQuery.size() < 2 || tokenIndex != tokenizedQuery.size() || (btree && indexColumns.empty()) || (hash && hashColumns.empty()) ||
+        (bloom && bloomColumns.empty()) || (background && !btree && !hash))
     {
-        cout << "SYNTAX ERROR: Expected LOAD <relation_name>" << endl;
+        cout << "SYNTAX ERROR: Expected LOAD <relation_name> [COLUMNAR] [BTREE <column_name> ...] [HASH <column_name> ...] [BLOOM <column_name> ...] [BACKGROUND]" << endl;
         return false;
     }
     parsedQuery.queryType = LOAD;
     parsedQuery.loadRelationName = tokenizedQuery[1];
+    parsedQuery.loadColumnar = columnar;
+    parsedQuery.loadIndexColumns = indexColumns;
+    parsedQuery.loadHashColumns = hashColumns;
+    parsedQuery.loadBloomColumns = bloomColumns;
+    parsedQuery.loadIndexInBackground = background;
     return true;
 }
 
@@ -42,68 +97,40 @@ void executeLOAD()
     logger.log("executeLOAD for " + parsedQuery.loadRelationName);
 
     Table *table = new Table(parsedQuery.loadRelationName);
+    table->layout = parsedQuery.loadColumnar ? PAX_LAYOUT : ROW_LAYOUT;
+
+    // Only the requested columns are indexed. In the foreground the indexes
+    // are built from the rows as blockify writes them, in the same pass that
+    // writes the pages and collects the statistics
+    vector<string> indexColumns = parsedQuery.loadIndexColumns;
+    indexColumns.insert(indexColumns.end(), parsedQuery.loadHashColumns.begin(), parsedQuery.loadHashColumns.end());
+    IndexBuilderSink indexBuilder(indexColumns, parsedQuery.loadHashColumns);
+    BloomFilterSink bloomFilterBuilder(parsedQuery.loadBloomColumns);
+    vector<IngestSink *> sinks;
+    if (!indexColumns.empty() && !parsedQuery.loadIndexInBackground)
+        sinks.push_back(&indexBuilder);
+    if (!parsedQuery.loadBloomColumns.empty())
+        sinks.push_back(&bloomFilterBuilder);
 
     // The load() method now reads the header and calls blockify()
-    if (table->load())
+    if (table->load(sinks))
     {
-        // Build indices after successful load
-        table->buildIndices(); // Use member access
-
         // Insert the newly loaded table into the catalogue
         tableCatalogue.insertTable(table);
         cout << "Loaded Table. Column Count: " << table->columnCount << " Row Count: " << table->rowCount << endl;
 
-        // --- Implicit Index Creation on ALL Columns ---
-        table->clearIndex(); // Clear any previous indices just in case
-        if (table->columnCount > 0) {
-            logger.log("Implicitly building indices for all columns in table: " + table->tableName);
-
-            // Iterate through all columns to create an index for each
-            for (int columnIndex = 0; columnIndex < table->columnCount; ++columnIndex) {
-                string colName = table->columns[columnIndex];
-                logger.log("Building index for column: '" + colName + "' (Index " + to_string(columnIndex) + ")");
-                // Create a new empty map for this column's index in the main index structure
-                std::map<int, Table::RowLocation> currentColumnIndex;
-
-                // Iterate through all data pages/rows again to populate this column's index
-                for (int pageIdx = 0; pageIdx < table->blockCount; ++pageIdx) {
-                    // Check if page index is valid for rowsPerBlockCount
-                    if (pageIdx >= table->rowsPerBlockCount.size()) {
-                        logger.log("executeLOAD index build ERROR: pageIdx " + to_string(pageIdx) + " >= rowsPerBlockCount size " + to_string(table->rowsPerBlockCount.size()));
-                        continue; // Skip this potentially invalid page index
-                    }
-
-                    Page page = bufferManager.getPage(table->tableName, pageIdx);
-                    int rowsInPage = table->rowsPerBlockCount[pageIdx];
-
-                    for (int rowIdx = 0; rowIdx < rowsInPage; ++rowIdx) {
-                        vector<int> rowData = page.getRow(rowIdx);
-                        // Ensure rowData is not empty and has the indexed column
-                        if (!rowData.empty() && columnIndex < (int)rowData.size()) { // Cast size() to int for comparison
-                            int key = rowData[columnIndex];
-                            // ASSUMPTION: Key is unique per column. If not, this overwrites, storing only the last location.
-                            // If duplicates needed storing: table->multiColumnIndexData[colName][key].push_back({pageIdx, rowIdx});
-                            currentColumnIndex[key] = {pageIdx, rowIdx}; // Add/update location in this column's specific map
-                        } else if (rowData.empty()) {
-                            logger.log("executeLOAD index build WARNING: Got empty row from page " + to_string(pageIdx) + " row " + to_string(rowIdx));
-                        } else {
-                            logger.log("executeLOAD index build WARNING: Row on page " + to_string(pageIdx) + " row " + to_string(rowIdx) + " has too few columns (needs index " + to_string(columnIndex) + ").");
-                        }
-                    }
-                }
-                // Store the completed map for this column in the main structure
-                table->multiColumnIndexData[colName] = currentColumnIndex;
-                logger.log("Index for column '" + colName + "' created. Size: " + to_string(currentColumnIndex.size()));
-            } // End for each column
-            cout << "Implicit indices created for all columns." << endl;
-        } else {
-             logger.log("Table has no columns. Skipping implicit index creation.");
-        }
-
+        if (indexColumns.empty())
+            return;
+        if (!parsedQuery.loadIndexInBackground)
+            cout << "Indexes created on " << indexColumns.size() << " column(s)." << endl;
+        else if (buildIndexes(*table, indexColumns, parsedQuery.loadHashColumns, true))
+            cout << "Indexes on " << indexColumns.size() << " column(s) are being built in the background." << endl;
+        else
+            cout << "ERROR: Failed to start building the indexes of '" << table->tableName << "'." << endl;
     } else {
          // load() failed, delete the partially created table object
          cout << "ERROR: Failed to load table '" << parsedQuery.loadRelationName << "'." << endl;
          delete table; // Clean up memory
     }
     return;
-}
\ No newline at end of file
+}
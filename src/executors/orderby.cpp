@@ -20,9 +20,10 @@ using namespace std;
  *
  * Implementation: External Sorting using a K-way Merge Sort Algorithm.
  * The algorithm works in two phases:
- *   1. Sorting Phase: Read at most 10 blocks at a time, sort the records in memory,
- *      and write each sorted run as a temporary subfile.
- *   2. Merging Phase: Merge subfiles (up to 9 at a time) until only one sorted file remains.
+ *   1. Sorting Phase: Read as many blocks as the ORDER BY memory grant holds,
+ *      sort the records in memory, and write each sorted run as a temporary subfile.
+ *   2. Merging Phase: Merge subfiles (one less than the granted blocks at a
+ *      time) until only one sorted file remains.
  *   3. Store the sorted result in a new table (Result_table)
  */
 
@@ -189,10 +190,10 @@ vector<vector<int>> mergeMultipleRunsOrderBy(const vector<vector<vector<int>>> &
  * Executes the ORDER BY command using an external sort algorithm.
  *
  * This implementation uses:
- *   - A sorting phase that reads groups of up to 10 blocks (the allowed buffer size),
- *     sorts them in-memory, and stores each sorted run.
- *   - A merging phase that repeatedly merges groups of runs (up to 9 runs at a time)
- *     until only one remains.
+ *   - A sorting phase that reads groups of as many blocks as the memory grant
+ *     holds, sorts them in-memory, and stores each sorted run.
+ *   - A merging phase that repeatedly merges groups of runs (one less than the
+ *     granted blocks at a time) until only one remains.
  *   - Finally, the sorted data is written to a new table.
  */
 
@@ -206,7 +207,10 @@ void executeORDERBY()
     // Phase 1: Create sorted runs
     vector<vector<vector<int>>> sortedRuns;
     int numBlocks = sourceTable->blockCount;
-    int blocksPerRun = 10; // Maximum blocks allowed in memory
+    // Run size and merge fan-in follow the working memory granted to ORDER BY
+    MemoryGrant grant = memoryManager.requestGrant("ORDER BY", MIN_WORKING_MEMORY_BLOCKS);
+    int blocksPerRun = grant.blocks();
+    size_t mergeFanIn = grant.blocks() - 1; // One block is kept for output
 
     for (int startBlock = 0; startBlock < numBlocks; startBlock += blocksPerRun)
     {
@@ -232,10 +236,10 @@ void executeORDERBY()
     {
         vector<vector<vector<int>>> newRuns;
 
-        // Merge groups of up to 9 runs at a time
-        for (size_t i = 0; i < sortedRuns.size(); i += 9)
+        // Merge groups of up to mergeFanIn runs at a time
+        for (size_t i = 0; i < sortedRuns.size(); i += mergeFanIn)
         {
-            size_t end = min(i + (size_t)9, sortedRuns.size());
+            size_t end = min(i + mergeFanIn, sortedRuns.size());
             vector<vector<vector<int>>> runsToMerge(sortedRuns.begin() + i, sortedRuns.begin() + end);
 
             // Update mergeMultipleRuns to use the ORDER_BY comparison
@@ -258,6 +262,7 @@ void executeORDERBY()
     // Re-blockify the data into the new table
     int rowCounter = 0;
     int pageCounter = 0;
+    resultTable->zoneMap.reset(resultTable->columnCount);
 
     while (rowCounter < sortedData.size())
     {
@@ -275,6 +280,7 @@ void executeORDERBY()
         // Write the page to disk using the Page class
         Page resultPage(resultTable->tableName, pageCounter, pageRows, rowsInBlock); // Create Page object
         resultPage.writePage();                                                      // Write the page
+        resultTable->zoneMap.setPage(pageCounter, resultPage);
 
         resultTable->rowsPerBlockCount.push_back(rowsInBlock);
         pageCounter++;
@@ -282,23 +288,15 @@ void executeORDERBY()
 
     // Update the table's block count
     resultTable->blockCount = pageCounter;
+    resultTable->invalidateDescriptor();
 
     // Compute statistics for the new table (distinct values, etc.)
-    resultTable->distinctValuesInColumns.clear();
-    resultTable->distinctValuesInColumns.resize(resultTable->columnCount);
-    resultTable->distinctValuesPerColumnCount.assign(resultTable->columnCount, 0);
-
+    resultTable->resetStatistics();
     for (const auto &row : sortedData)
     {
-        for (int col = 0; col < resultTable->columnCount; col++)
-        {
-            if (!resultTable->distinctValuesInColumns[col].count(row[col]))
-            {
-                resultTable->distinctValuesInColumns[col].insert(row[col]);
-                resultTable->distinctValuesPerColumnCount[col]++;
-            }
-        }
+        resultTable->updateStatistics(RowView(row.data(), resultTable->columnCount));
     }
+    resultTable->finishStatistics();
 
     // Insert the new table into the catalogue
     tableCatalogue.insertTable(resultTable);
@@ -41,7 +41,7 @@ bool semanticParsePROJECTION()
         return false;
     }
 
-    Table table = *tableCatalogue.getTable(parsedQuery.projectionRelationName);
+    const Table &table = *tableCatalogue.getTable(parsedQuery.projectionRelationName);
     for (auto col : parsedQuery.projectionColumnList)
     {
         if (!table.isColumn(col))
@@ -57,26 +57,52 @@ void executePROJECTION()
 {
     logger.log("executePROJECTION");
     Table* resultantTable = new Table(parsedQuery.projectionResultRelationName, parsedQuery.projectionColumnList);
-    Table table = *tableCatalogue.getTable(parsedQuery.projectionRelationName);
-    Cursor cursor = table.getCursor();
+    Table *table = tableCatalogue.getTable(parsedQuery.projectionRelationName);
+    Cursor cursor = table->getCursor();
     vector<int> columnIndices;
     for (int columnCounter = 0; columnCounter < parsedQuery.projectionColumnList.size(); columnCounter++)
     {
-        columnIndices.emplace_back(table.getColumnIndex(parsedQuery.projectionColumnList[columnCounter]));
+        columnIndices.emplace_back(table->getColumnIndex(parsedQuery.projectionColumnList[columnCounter]));
     }
-    vector<int> row = cursor.getNext();
     vector<int> resultantRow(columnIndices.size(), 0);
+    RowView resultantView(resultantRow.data(), resultantRow.size());
 
-    while (!row.empty())
+    ofstream fout(resultantTable->sourceFileName, ios::app);
+    if (table->layout == PAX_LAYOUT)
     {
-
-        for (int columnCounter = 0; columnCounter < columnIndices.size(); columnCounter++)
+        // Only the projected columns of each page are touched
+        vector<const int *> projectedColumns(columnIndices.size());
+        ColumnBatch batch;
+        while (cursor.nextColumnBatch(batch))
+        {
+            for (int columnCounter = 0; columnCounter < columnIndices.size(); columnCounter++)
+            {
+                projectedColumns[columnCounter] = batch.column(columnIndices[columnCounter]);
+            }
+            for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
+            {
+                for (int columnCounter = 0; columnCounter < columnIndices.size(); columnCounter++)
+                {
+                    resultantRow[columnCounter] = projectedColumns[columnCounter][rowCounter];
+                }
+                resultantTable->writeRow(resultantView, fout);
+            }
+        }
+    }
+    RowBatch batch;
+    while (table->layout == ROW_LAYOUT && cursor.nextBatch(batch))
+    {
+        for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
         {
-            resultantRow[columnCounter] = row[columnIndices[columnCounter]];
+            RowView row = batch.row(rowCounter);
+            for (int columnCounter = 0; columnCounter < columnIndices.size(); columnCounter++)
+            {
+                resultantRow[columnCounter] = row[columnIndices[columnCounter]];
+            }
+            resultantTable->writeRow(resultantView, fout);
         }
-        resultantTable->writeRow<int>(resultantRow);
-        row = cursor.getNext();
     }
+    fout.close();
     resultantTable->blockify();
     tableCatalogue.insertTable(resultantTable);
     return;
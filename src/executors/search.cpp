@@ -1,8 +1,16 @@
 #include "global.h"
+#include "indexing.h"
 #include <vector>
-#include <map>
-#include <set> // For the mini page cache optimization
 #include <iostream> // For cout/cerr
+#include <climits>  // INT_MIN/INT_MAX bounds of index ranges
+#include <cmath>    // pow for the page estimate
+
+// Planner costs, in units of reading one value of a page: finding a row
+// through the index and marking it in the bitmap, and copying a row out of a
+// row-layout page, which a scan does for every row it tests. Refit them by
+// timing the same SEARCHes under ./server --search-plan index and scan
+const double INDEX_MATCH_COST = 16.0;
+const double ROW_COPY_COST = 8.0;
 
 /**
  * @brief Placeholder for SEARCH command execution.
@@ -117,59 +125,130 @@ bool syntacticParseSEARCH()
 
 
 /**
- * @brief Helper function to fetch specific rows using their locations.
+ * @brief Writes the rows an index lookup found to the result table as a
+ * bitmap heap scan. The lookup returns rows in key order, which would visit
+ * the pages in random order and revisit them; instead every pointer first
+ * sets its row's bit in a bitmap per page, then the pages with a bit set are
+ * fetched through the buffer pool in page order, each exactly once, and
+ * their marked rows are written in row order to the result file, which is
+ * opened once.
  *
  * @param resultTable The table to write fetched rows into.
  * @param sourceTable The table from which to fetch rows.
- * @param locations A vector of RowLocation pairs {pageIndex, rowIndexInPage}.
+ * @param pointers Rows found by the index.
  */
-void fetchRows(Table* resultTable, Table* sourceTable, const std::vector<Table::RowLocation>& locations) {
-    // Cache pages locally for this fetch operation to reduce buffer manager calls
-    std::map<int, Page> pageCache;
-
-    logger.log("fetchRows: Fetching " + to_string(locations.size()) + " rows based on index locations.");
-
-    for (const auto& loc : locations) {
-        int pageIdx = loc.first;
-        int rowIdx = loc.second;
-        Page page;
-
-        // Simple caching approach
-        if (pageCache.find(pageIdx) == pageCache.end()) {
-             // Page not in cache, fetch it
-             logger.log("fetchRows: Fetching page " + to_string(pageIdx) + " for table " + sourceTable->tableName);
-             page = bufferManager.getPage(sourceTable->tableName, pageIdx);
-             if (page.pageName.empty()) { // Basic check if getPage failed somehow
-                 logger.log("fetchRows ERROR: Failed to get page " + to_string(pageIdx) + ". Skipping location.");
-                 continue;
-             }
-             pageCache[pageIdx] = page; // Store fetched page
-         } else {
-             // Page already in cache
-             // logger.log("fetchRows: Using cached page " + to_string(pageIdx)); // Can be verbose
-             page = pageCache[pageIdx];
-         }
+void fetchRows(Table* resultTable, Table* sourceTable, const std::vector<RecordPointer>& pointers) {
+    logger.log("fetchRows: Fetching " + to_string(pointers.size()) + " rows based on index locations.");
+
+    // Only pages with a match get a bitmap
+    vector<vector<bool>> rowBitmaps(sourceTable->blockCount);
+    for (const RecordPointer &pointer : pointers) {
+        if (pointer.pageId >= rowBitmaps.size() || pointer.rowIndex >= sourceTable->rowsPerBlockCount[pointer.pageId]) {
+            logger.log("fetchRows WARNING: Index points past the rows of the table at page " + to_string(pointer.pageId) + ", row " + to_string(pointer.rowIndex));
+            continue;
+        }
+        vector<bool> &rowBitmap = rowBitmaps[pointer.pageId];
+        if (rowBitmap.empty())
+            rowBitmap.resize(sourceTable->rowsPerBlockCount[pointer.pageId]);
+        rowBitmap[pointer.rowIndex] = true;
+    }
 
+    ofstream fout(resultTable->sourceFileName, ios::app);
+    // A PAX row is gathered value by value, so a page with a few matches is
+    // not transposed whole for getRowView
+    vector<int> gatheredRow(sourceTable->columnCount, 0);
+    RowView gatheredView(gatheredRow.data(), gatheredRow.size());
+    int pagesFetched = 0;
+    for (int pageIdx = 0; pageIdx < (int)rowBitmaps.size(); pageIdx++) {
+        const vector<bool> &rowBitmap = rowBitmaps[pageIdx];
+        if (rowBitmap.empty())
+            continue;
+        PageHandle pageHandle = bufferManager.getPage(sourceTable->tableName, pageIdx);
+        if (!pageHandle.isValid()) {
+            logger.log("fetchRows ERROR: Failed to get page " + to_string(pageIdx) + ". Skipping its rows.");
+            continue;
+        }
+        pagesFetched++;
+        const Page &page = *pageHandle;
+        for (int rowIdx = 0; rowIdx < (int)rowBitmap.size(); rowIdx++) {
+            if (!rowBitmap[rowIdx])
+                continue;
+            if (page.getLayout() == ROW_LAYOUT) {
+                // Viewed in place inside the pinned page
+                resultTable->writeRow(page.getRowView(rowIdx), fout);
+                continue;
+            }
+            for (int columnIdx = 0; columnIdx < (int)gatheredRow.size(); columnIdx++)
+                gatheredRow[columnIdx] = page.getCell(rowIdx, columnIdx);
+            resultTable->writeRow(gatheredView, fout);
+        }
+    }
+    fout.close();
+    logger.log("fetchRows: Finished fetching rows from " + to_string(pagesFetched) + " of " + to_string(sourceTable->blockCount) + " pages.");
+}
 
-        // Get the specific row from the page object
-        vector<int> rowData = page.getRow(rowIdx);
-        if (!rowData.empty()) {
-            // logger.log("fetchRows: Writing row from page " + to_string(pageIdx) + " row " + to_string(rowIdx));
-            resultTable->writeRow<int>(rowData); // Write to the result table's temporary file/buffer
-        } else {
-             logger.log("fetchRows WARNING: Tried to get invalid or empty row at page " + to_string(pageIdx) + ", row " + to_string(rowIdx));
-             // This might happen if Page::getRow has strict bounds checking and rowIdx is invalid,
-             // or if the page data is somehow corrupted, or if the location from index is stale.
+/**
+ * @brief Decides between the index and a full scan for a key range, by
+ * their estimated cost in value reads. Both read the pages the zone map
+ * cannot rule out, each page costing as much as reading all its values, but
+ * the bitmap path only the pages holding a match: for k matches spread over
+ * P candidate pages, about P * (1 - (1 - 1/P)^k) of them. The scan then
+ * tests every row of those pages, reading only the searched column of a PAX
+ * page but copying whole rows of a row-layout page; the bitmap path pays for
+ * the index pages holding the matches and INDEX_MATCH_COST per match.
+ *<p>
+ * The matches are estimated from the column's histogram (see
+ * ColumnStatistics::estimateSelectivity) while it still describes the
+ * column. Once INSERT, UPDATE or DELETE changed the column the estimate
+ * comes from the zone map instead, which those commands keep up to date:
+ * the values of each candidate page are taken as spread evenly over the
+ * page's [min, max].
+ *</p>
+ *
+ * @return true if the full scan is expected to be cheaper
+ */
+static bool isFullScanCheaper(const Table &table, ColumnIndex &index, int columnIndex, BinaryOperator op, int value, int low, int high)
+{
+    if (columnIndex < 0 || columnIndex >= (int)table.columnStatistics.size() || table.rowCount == 0)
+        return false;
+    const ColumnStatistics &statistics = table.columnStatistics[columnIndex];
+    long long scanPages = 0;
+    long long scanRows = 0;
+    double zoneMatches = 0;
+    for (int pageIdx = 0; pageIdx < (int)table.blockCount; pageIdx++) {
+        if (table.rowsPerBlockCount[pageIdx] == 0 || !pageMayMatch(table, pageIdx, columnIndex, op, value))
+            continue;
+        scanPages++;
+        scanRows += table.rowsPerBlockCount[pageIdx];
+        double pageSelectivity = 1;
+        if (table.zoneMap.covers(pageIdx, columnIndex)) {
+            double zoneMin = table.zoneMap.getMin(pageIdx, columnIndex);
+            double zoneMax = table.zoneMap.getMax(pageIdx, columnIndex);
+            double overlap = min((double)high, zoneMax) - max((double)low, zoneMin) + 1;
+            pageSelectivity = max(0.0, min(1.0, overlap / (zoneMax - zoneMin + 1)));
         }
+        zoneMatches += pageSelectivity * table.rowsPerBlockCount[pageIdx];
     }
-    logger.log("fetchRows: Finished fetching rows.");
+    double selectivity = statistics.stale ? zoneMatches / table.rowCount : statistics.estimateSelectivity(low, high);
+    double pageCost = (double)table.maxRowsPerBlock * table.columnCount;
+    double rowTestCost = table.layout == PAX_LAYOUT ? 1 : table.columnCount + ROW_COPY_COST;
+    double scanCost = scanPages * pageCost + scanRows * rowTestCost;
+
+    double matches = min(selectivity * table.rowCount, (double)scanRows);
+    double bitmapPages = scanPages == 0 ? 0 : scanPages * (1 - pow(1 - 1.0 / scanPages, matches));
+    double bitmapCost = bitmapPages * pageCost + matches * INDEX_MATCH_COST + selectivity * index.getPageCount() * NODE_INT_COUNT;
+    logger.log("isFullScanCheaper: Selectivity " + to_string(selectivity) + (statistics.stale ? " (zone map)" : " (histogram)") + ", about " +
+               to_string((long long)matches) + " rows on " + to_string((long long)bitmapPages) + " of " + to_string(scanPages) +
+               " pages; bitmap cost " + to_string(bitmapCost) + ", scan cost " + to_string(scanCost));
+    return scanCost < bitmapCost;
 }
 
 
 /**
  * @brief Executes the SEARCH command.
  * Syntax: <res_table> <- SEARCH FROM <table_name> WHERE <col_name> <bin_op> <value>
- * Uses the implicitly created index on the queried column if available.
+ * Uses the index on the queried column if there is one and the condition
+ * is selective enough, a full scan otherwise.
  */
 void executeSEARCH() {
     logger.log("executeSEARCH starting...");
@@ -191,93 +270,69 @@ void executeSEARCH() {
     // and if the query involves comparing with an integer literal
     if (table->isIndexed(queryColumnName) && parsedQuery.selectType == INT_LITERAL)
     {
-        logger.log("Attempting to use implicit index (std::map) for SEARCH on column: '" + queryColumnName + "'");
+        ColumnIndex &index = *table->indexes[queryColumnName];
+        logger.log("Attempting to use " + string(index.getStrategyName()) + " index for SEARCH on column: '" + queryColumnName + "'");
 
         int value = parsedQuery.selectionIntLiteral;
         BinaryOperator op = parsedQuery.selectionBinaryOperator;
 
-        // Get the specific index map for the queried column
-        // Use .at() which throws if key not found (shouldn't happen if isIndexed passed)
-        // Or use find() and check iterator for more safety.
-        auto map_iter = table->multiColumnIndexData.find(queryColumnName);
-        if (map_iter == table->multiColumnIndexData.end()) {
-             logger.log("executeSEARCH ERROR: Index map not found for column '" + queryColumnName + "' even though isIndexed returned true. Falling back.");
-             // This indicates an internal logic error. Fallback to scan.
-        } else {
-             auto& index = map_iter->second; // Reference to the inner std::map<int, RowLocation>
-             std::vector<Table::RowLocation> locationsToFetch;
-
-
-             try { // Use try-catch for map operations (like lower_bound, upper_bound)
-                 switch (op) {
-                     case EQUAL: {
-                         auto it = index.find(value);
-                         if (it != index.end()) {
-                             locationsToFetch.push_back(it->second); // Add the single location (unique key assumption)
-                             index_used = true;
-                         }
-                         // If not found, index_used remains false, locationsToFetch is empty
-                         break;
-                     }
-                     case LESS_THAN: { // All keys < value
-                         auto end_it = index.lower_bound(value); // First element NOT less than value
-                         for (auto it = index.begin(); it != end_it; ++it) {
-                             locationsToFetch.push_back(it->second);
-                         }
-                          index_used = true; // Index was consulted, even if result is empty
-                         break;
-                     }
-                     case LEQ: { // All keys <= value
-                         auto end_it = index.upper_bound(value); // First element GREATER than value
-                         for (auto it = index.begin(); it != end_it; ++it) {
-                             locationsToFetch.push_back(it->second);
-                         }
-                          index_used = true; // Index was consulted
-                         break;
-                     }
-                     case GREATER_THAN: { // All keys > value
-                          auto start_it = index.upper_bound(value); // First element GREATER than value
-                          for (auto it = start_it; it != index.end(); ++it) {
-                              locationsToFetch.push_back(it->second);
-                          }
-                           index_used = true; // Index was consulted
-                          break;
-                     }
-                     case GEQ: { // All keys >= value
-                          auto start_it = index.lower_bound(value); // First element NOT LESS than value
-                          for (auto it = start_it; it != index.end(); ++it) {
-                              locationsToFetch.push_back(it->second);
-                          }
-                           index_used = true; // Index was consulted
-                          break;
-                     }
-                     case NOT_EQUAL: {
-                         // Fetch ALL locations and skip the one matching 'value' if found.
-                         // This is often slower than a full scan, so we fallback.
-                         logger.log("Index usage for '!=' is inefficient; falling back to full scan.");
-                         index_used = false; // Decide *not* to use the index here
-                         break;
-                     }
-                     default:
-                         logger.log("Unknown operator for index search; falling back.");
-                         index_used = false; // Decide *not* to use the index
-                 }
-             } catch (const std::exception& e) {
-                  logger.log("Exception during index map access for column '" + queryColumnName + "': " + string(e.what()) + ". Falling back to full scan.");
-                  index_used = false; // Fallback if map operation fails
-             }
-
-
-             // Fetch rows if index was successfully used and locations were found
-             if(index_used && !locationsToFetch.empty()) {
-                  logger.log("Index lookup identified " + to_string(locationsToFetch.size()) + " potential rows. Fetching...");
-                  fetchRows(resultantTable, table, locationsToFetch);
-                  logger.log("Finished fetching rows using index.");
-             } else if (index_used) {
-                  logger.log("Index lookup completed, but found no matching rows.");
-                  // No rows to fetch, resultantTable will remain empty (correct)
-             }
-         } // end else (index map found)
+        // Every operator but != is one key range of the tree
+        int low = INT_MIN;
+        int high = INT_MAX;
+        index_used = true;
+        switch (op) {
+            case EQUAL:
+                low = high = value;
+                break;
+            case LESS_THAN: // All keys < value
+                if (value == INT_MIN) { low = 1; high = 0; } // empty range
+                else high = value - 1;
+                break;
+            case LEQ: // All keys <= value
+                high = value;
+                break;
+            case GREATER_THAN: // All keys > value
+                if (value == INT_MAX) { low = 1; high = 0; } // empty range
+                else low = value + 1;
+                break;
+            case GEQ: // All keys >= value
+                low = value;
+                break;
+            case NOT_EQUAL:
+                // Matches almost every row, a full scan is cheaper
+                logger.log("Index usage for '!=' is inefficient; falling back to full scan.");
+                index_used = false;
+                break;
+            default:
+                logger.log("Unknown operator for index search; falling back.");
+                index_used = false;
+        }
+        // A hash index only finds single keys
+        if (index_used && !index.isOrdered() && low != high) {
+            logger.log("Index on '" + queryColumnName + "' cannot answer ranges; falling back to full scan.");
+            index_used = false;
+        }
+
+        // A wide range reads most pages anyway, and faster as a scan
+        if (index_used && searchPlan == SCAN_PLAN) {
+            logger.log("Full scan forced by --search-plan scan.");
+            index_used = false;
+        } else if (index_used && searchPlan == AUTO_PLAN && isFullScanCheaper(*table, index, table->getColumnIndex(queryColumnName), op, value, low, high)) {
+            logger.log("Condition on '" + queryColumnName + "' is not selective enough for the index; falling back to full scan.");
+            index_used = false;
+        }
+
+        if (index_used) {
+            vector<RecordPointer> pointers = low == high ? index.search(low) : index.searchRange(low, high);
+            if (!pointers.empty()) {
+                logger.log("Index lookup identified " + to_string(pointers.size()) + " potential rows. Fetching...");
+                fetchRows(resultantTable, table, pointers);
+                logger.log("Finished fetching rows using index.");
+            } else {
+                logger.log("Index lookup completed, but found no matching rows.");
+                // No rows to fetch, resultantTable will remain empty (correct)
+            }
+        }
 
 
     } else { // Index not available ( will never happen but just in case ?)
@@ -295,7 +350,6 @@ void executeSEARCH() {
     // --- Fallback to Full Table Scan / Only happens due to data is lost ---
     if (!index_used) {
         logger.log("Performing full table scan for SEARCH.");
-        Cursor cursor = table->getCursor();
         vector<int> row;
         int searchColumnIndex = table->getColumnIndex(queryColumnName); // Use parsed queryColumnName
 
@@ -311,9 +365,28 @@ void executeSEARCH() {
 
         int comparisonValue = parsedQuery.selectionIntLiteral;
         BinaryOperator comparisonOp = parsedQuery.selectionBinaryOperator;
+        Cursor cursor = table->getCursor([=](int pageIndex) { return pageMayMatch(*table, pageIndex, searchColumnIndex, comparisonOp, comparisonValue); });
+
+        ofstream fout(resultantTable->sourceFileName, ios::app);
+        if (table->layout == PAX_LAYOUT) {
+            // Scan only the searched column; gather the rest of a row on a match
+            ColumnBatch batch;
+            row.assign(table->columnCount, 0);
+            RowView rowView(row.data(), row.size());
+            while (cursor.nextColumnBatch(batch)) {
+                const int *searchColumn = batch.column(searchColumnIndex);
+                for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++) {
+                    if (!evaluateBinOp(searchColumn[rowCounter], comparisonValue, comparisonOp))
+                        continue;
+                    for (int columnCounter = 0; columnCounter < batch.columnCount; columnCounter++)
+                        row[columnCounter] = batch.value(rowCounter, columnCounter);
+                    resultantTable->writeRow(rowView, fout);
+                }
+            }
+            row.clear();
+        }
 
-
-        while (!(row = cursor.getNext()).empty()) {
+        while (table->layout == ROW_LAYOUT && !(row = cursor.getNext()).empty()) {
             // Ensure row has enough columns before accessing
             if (searchColumnIndex >= (int)row.size()) { // Safe cast
                 logger.log("Full scan WARNING: Row encountered with fewer columns (" + to_string(row.size()) + ") than expected index " + to_string(searchColumnIndex) + ".");
@@ -323,10 +396,11 @@ void executeSEARCH() {
 
 
             if (evaluateBinOp(columnValue, comparisonValue, comparisonOp)) {
-                resultantTable->writeRow<int>(row);
+                resultantTable->writeRow(RowView(row.data(), row.size()), fout);
             }
         }
-        logger.log("Full table scan completed.");
+        fout.close();
+        logger.log("Full table scan completed. Skipped " + to_string(cursor.skippedPages) + " of " + to_string(table->blockCount) + " pages.");
     }
 
 
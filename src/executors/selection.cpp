@@ -1,5 +1,6 @@
 #include "global.h"
 #include "table.h"
+#include "indexing.h"
 /**
  * @brief 
  * SYNTAX: R <- SELECT column_name bin_op [column_name | int_literal] FROM relation_name
@@ -104,31 +105,147 @@ bool evaluateBinOp(int value1, int value2, BinaryOperator binaryOperator)
     }
 }
 
+/**
+ * @brief Whether some value1 in [minValue1, maxValue1] and some value2 in
+ * [minValue2, maxValue2] can satisfy value1 binaryOperator value2.
+ */
+static bool rangesMayMatch(int minValue1, int maxValue1, BinaryOperator binaryOperator, int minValue2, int maxValue2)
+{
+    switch (binaryOperator)
+    {
+    case LESS_THAN:
+        return (minValue1 < maxValue2);
+    case GREATER_THAN:
+        return (maxValue1 > minValue2);
+    case LEQ:
+        return (minValue1 <= maxValue2);
+    case GEQ:
+        return (maxValue1 >= minValue2);
+    case EQUAL:
+        return (minValue1 <= maxValue2 && minValue2 <= maxValue1);
+    case NOT_EQUAL:
+        return !(minValue1 == maxValue1 && minValue2 == maxValue2 && minValue1 == minValue2);
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Uses the table's zone map, and for equality its Bloom filters, to
+ * decide whether a page can hold a row with (column binaryOperator value).
+ * Pages without a zone or filter may always match.
+ *
+ * @return false if the page can be skipped
+ */
+bool pageMayMatch(const Table &table, int pageIndex, int columnIndex, BinaryOperator binaryOperator, int value)
+{
+    if (binaryOperator == EQUAL && !table.bloomFilters.mayContain(pageIndex, columnIndex, value))
+        return false;
+    const ZoneMap &zoneMap = table.zoneMap;
+    if (!zoneMap.covers(pageIndex, columnIndex))
+        return true;
+    if (zoneMap.isEmpty(pageIndex))
+        return false;
+    return rangesMayMatch(zoneMap.getMin(pageIndex, columnIndex), zoneMap.getMax(pageIndex, columnIndex), binaryOperator, value, value);
+}
+
+/**
+ * @brief Like pageMayMatch(), for a comparison of two columns of the row.
+ */
+bool pageMayMatchColumns(const Table &table, int pageIndex, int firstColumnIndex, BinaryOperator binaryOperator, int secondColumnIndex)
+{
+    const ZoneMap &zoneMap = table.zoneMap;
+    if (!zoneMap.covers(pageIndex, firstColumnIndex) || !zoneMap.covers(pageIndex, secondColumnIndex))
+        return true;
+    if (zoneMap.isEmpty(pageIndex))
+        return false;
+    return rangesMayMatch(zoneMap.getMin(pageIndex, firstColumnIndex), zoneMap.getMax(pageIndex, firstColumnIndex), binaryOperator,
+                          zoneMap.getMin(pageIndex, secondColumnIndex), zoneMap.getMax(pageIndex, secondColumnIndex));
+}
+
+/**
+ * @brief Marks the pages holding a row whose column equals value, found
+ * through the column's index (one bucket read for a hash index), so an
+ * equality condition only visits those pages.
+ *
+ * @return false if the column has no index; pageHasMatch is then unchanged
+ */
+bool findIndexedPages(const Table &table, int columnIndex, int value, vector<bool> &pageHasMatch)
+{
+    auto index = table.indexes.find(table.columns[columnIndex]);
+    if (index == table.indexes.end())
+        return false;
+    pageHasMatch.assign(table.blockCount, false);
+    for (const RecordPointer &pointer : index->second->search(value))
+    {
+        if (pointer.pageId < pageHasMatch.size())
+            pageHasMatch[pointer.pageId] = true;
+    }
+    return true;
+}
+
 void executeSELECTION()
 {
     logger.log("executeSELECTION");
 
-    Table table = *tableCatalogue.getTable(parsedQuery.selectionRelationName);
-    Table* resultantTable = new Table(parsedQuery.selectionResultRelationName, table.columns);
-    Cursor cursor = table.getCursor();
-    vector<int> row = cursor.getNext();
-    int firstColumnIndex = table.getColumnIndex(parsedQuery.selectionFirstColumnName);
+    Table *table = tableCatalogue.getTable(parsedQuery.selectionRelationName);
+    Table* resultantTable = new Table(parsedQuery.selectionResultRelationName, table->columns);
+    int firstColumnIndex = table->getColumnIndex(parsedQuery.selectionFirstColumnName);
     int secondColumnIndex;
     if (parsedQuery.selectType == COLUMN)
-        secondColumnIndex = table.getColumnIndex(parsedQuery.selectionSecondColumnName);
-    while (!row.empty())
+        secondColumnIndex = table->getColumnIndex(parsedQuery.selectionSecondColumnName);
+    BinaryOperator binaryOperator = parsedQuery.selectionBinaryOperator;
+    function<bool(int)> pageFilter;
+    if (parsedQuery.selectType == COLUMN)
+        pageFilter = [=](int pageIndex) { return pageMayMatchColumns(*table, pageIndex, firstColumnIndex, binaryOperator, secondColumnIndex); };
+    else
     {
+        int literal = parsedQuery.selectionIntLiteral;
+        pageFilter = [=](int pageIndex) { return pageMayMatch(*table, pageIndex, firstColumnIndex, binaryOperator, literal); };
+    }
+    Cursor cursor = table->getCursor(pageFilter);
 
-        int value1 = row[firstColumnIndex];
-        int value2;
-        if (parsedQuery.selectType == INT_LITERAL)
-            value2 = parsedQuery.selectionIntLiteral;
-        else
-            value2 = row[secondColumnIndex];
-        if (evaluateBinOp(value1, value2, parsedQuery.selectionBinaryOperator))
-            resultantTable->writeRow<int>(row);
-        row = cursor.getNext();
+    ofstream fout(resultantTable->sourceFileName, ios::app);
+    if (table->layout == PAX_LAYOUT)
+    {
+        // Only the compared columns are read; the rest of a row is gathered
+        // once it matches
+        vector<int> resultantRow(table->columnCount, 0);
+        RowView resultantView(resultantRow.data(), resultantRow.size());
+        ColumnBatch batch;
+        while (cursor.nextColumnBatch(batch))
+        {
+            const int *firstColumn = batch.column(firstColumnIndex);
+            const int *secondColumn = parsedQuery.selectType == COLUMN ? batch.column(secondColumnIndex) : nullptr;
+            for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
+            {
+                int value2 = secondColumn != nullptr ? secondColumn[rowCounter] : parsedQuery.selectionIntLiteral;
+                if (!evaluateBinOp(firstColumn[rowCounter], value2, parsedQuery.selectionBinaryOperator))
+                    continue;
+                for (int columnCounter = 0; columnCounter < batch.columnCount; columnCounter++)
+                    resultantRow[columnCounter] = batch.value(rowCounter, columnCounter);
+                resultantTable->writeRow(resultantView, fout);
+            }
+        }
+    }
+    RowBatch batch;
+    while (table->layout == ROW_LAYOUT && cursor.nextBatch(batch))
+    {
+        for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
+        {
+            RowView row = batch.row(rowCounter);
+            int value1 = row[firstColumnIndex];
+            int value2;
+            if (parsedQuery.selectType == INT_LITERAL)
+                value2 = parsedQuery.selectionIntLiteral;
+            else
+                value2 = row[secondColumnIndex];
+            if (evaluateBinOp(value1, value2, parsedQuery.selectionBinaryOperator))
+                resultantTable->writeRow(row, fout);
+        }
     }
+    fout.close();
+    logger.log("executeSELECTION: Skipped " + to_string(cursor.skippedPages) + " of " + to_string(table->blockCount) + " pages");
     if(resultantTable->blockify())
         tableCatalogue.insertTable(resultantTable);
     else{
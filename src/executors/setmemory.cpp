@@ -0,0 +1,50 @@
+#include "global.h"
+/**
+ * @brief
+ * SYNTAX: SET MEMORY memory_in_MB
+ */
+bool syntacticParseSETMEMORY()
+{
+    logger.log("syntacticParseSETMEMORY");
+    regex numeric("[0-9]+");
+    if (tokenizedQuery.size() != 3 || tokenizedQuery[1] != "MEMORY" || !regex_match(tokenizedQuery[2], numeric))
+    {
+        cout << "SYNTAX ERROR: Expected SET MEMORY <MB>" << endl;
+        return false;
+    }
+    parsedQuery.queryType = SET_MEMORY;
+    try
+    {
+        parsedQuery.memoryBudgetMB = stoul(tokenizedQuery[2]);
+    }
+    catch (...)
+    {
+        cout << "SYNTAX ERROR: Memory budget '" << tokenizedQuery[2] << "' is out of range." << endl;
+        return false;
+    }
+    return true;
+}
+
+bool semanticParseSETMEMORY()
+{
+    logger.log("semanticParseSETMEMORY");
+    if (parsedQuery.memoryBudgetMB < MemoryManager::minimumBudgetMB())
+    {
+        cout << "SEMANTIC ERROR: Memory budget must be at least " << MemoryManager::minimumBudgetMB() << " MB" << endl;
+        return false;
+    }
+    return true;
+}
+
+void executeSETMEMORY()
+{
+    logger.log("executeSETMEMORY");
+    if (!memoryManager.setBudget(parsedQuery.memoryBudgetMB))
+    {
+        cout << "ERROR: Could not apply memory budget" << endl;
+        return;
+    }
+    cout << "Memory budget set to " << memoryManager.getBudgetMB() << " MB: "
+         << memoryManager.getPoolBlocks() << " buffer pool blocks, "
+         << memoryManager.getWorkingBlocks() << " blocks of working memory" << endl;
+}
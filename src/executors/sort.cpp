@@ -5,6 +5,7 @@
 #include <sstream>
 #include "table.h"
 #include "page.h" // Include Page definition for writing
+#include "indexBuilder.h" // Rebuilds the indexes of the sorted table
 #include <vector>
 #include <string>
 #include <algorithm> // For std::sort, std::stable_sort
@@ -20,9 +21,10 @@ using namespace std;
  *
  * Implementation: External Sorting using a K-way Merge Sort Algorithm.
  * The algorithm works in two phases:
- *   1. Sorting Phase: Read at most 10 blocks at a time, sort the records in memory,
- *      and write each sorted run as a temporary subfile.
- *   2. Merging Phase: Merge subfiles (up to 9 at a time) until only one sorted file remains.
+ *   1. Sorting Phase: Read as many blocks as the SORT memory grant holds, sort
+ *      the records in memory, and write each sorted run as a temporary subfile.
+ *   2. Merging Phase: Merge subfiles (one less than the granted blocks at a
+ *      time) until only one sorted file remains.
  */
 
 bool syntacticParseSORT()
@@ -308,10 +310,10 @@ struct MergeElementSort
  * Executes the SORT command using an external sort algorithm.
  *
  * This implementation uses:
- *   - A sorting phase that reads groups of up to 10 blocks (the allowed buffer size),
- *     sorts them in-memory using multi-key sort, and stores each sorted run.
- *   - A merging phase that repeatedly merges groups of runs (up to 9 runs at a time)
- *     until only one remains.
+ *   - A sorting phase that reads groups of as many blocks as the memory grant
+ *     holds, sorts them in-memory using multi-key sort, and stores each sorted run.
+ *   - A merging phase that merges the runs, one input block per run plus one
+ *     output block.
  *   - Finally, the sorted data is written back to the table's page files in place.
  * After writing to the pages, the table is refreshed in main memory so that
  * subsequent operations use the updated context.
@@ -330,8 +332,12 @@ void executeSORT()
     // --- Phase 1: Create sorted runs ---
     logger.log("executeSORT: Phase 1 - Creating sorted runs...");
     vector<string> runPageNames; // Store names of temporary run pages
+    vector<pair<string, int>> runPages; // {run table name, page index} of each run page
     int numBlocks = table->blockCount;
-    int blocksPerRun = BLOCK_COUNT; // Use available buffer blocks for run size
+    // Run size and merge fan-in follow the working memory granted to SORT
+    MemoryGrant grant = memoryManager.requestGrant("SORT", MIN_WORKING_MEMORY_BLOCKS);
+    int blocksPerRun = grant.blocks();
+    size_t mergeFanIn = grant.blocks() - 1; // One block is kept for output
 
     for (int startBlock = 0; startBlock < numBlocks; startBlock += blocksPerRun)
     {
@@ -369,11 +375,15 @@ void executeSORT()
             Page tempPage(tempRunTableName, runBlockCounter, pageRows, rowsInBlock);
             tempPage.writePage();
             runPageNames.push_back(tempPage.getPageName()); // Store the name of the created page
+            runPages.push_back({tempRunTableName, runBlockCounter});
             runBlockCounter++;
         }
         logger.log("executeSORT: Created sorted run " + to_string(startBlock / blocksPerRun) + " with " + to_string(runBlockCounter) + " pages.");
     }
     logger.log("executeSORT: Phase 1 complete. Created " + to_string(runPageNames.size()) + " temporary run pages in total.");
+    // The runs now hold every row, including those of dirty frames; drop the
+    // table's frames so none is written back over the sorted pages
+    bufferManager.discardTablePages(table->tableName);
 
     if (runPageNames.empty())
     {
@@ -384,23 +394,19 @@ void executeSORT()
     }
 
     // --- Phase 2: Merge sorted runs ---
-    // This implementation merges all runs at once if they fit in memory (BLOCK_COUNT-1 runs).
-    // A multi-pass merge is needed if numRuns > BLOCK_COUNT-1.
+    // This implementation merges all runs at once if they fit in the grant (mergeFanIn runs).
+    // A multi-pass merge is needed if numRuns > mergeFanIn.
     // For simplicity, assuming single merge pass for now.
     // TODO: Implement multi-pass merge if necessary.
     logger.log("executeSORT: Phase 2 - Merging sorted runs...");
-    if (runPageNames.size() > (size_t)(BLOCK_COUNT - 1))
+    if (runPageNames.size() > mergeFanIn)
     {
-        cout << "EXECUTION ERROR: Too many runs (" << runPageNames.size() << ") to merge in a single pass with available buffers (" << BLOCK_COUNT - 1 << "). Multi-pass merge not implemented." << endl;
+        cout << "EXECUTION ERROR: Too many runs (" << runPageNames.size() << ") to merge in a single pass with available buffers (" << mergeFanIn << "). Multi-pass merge not implemented." << endl;
         // Cleanup temporary files before exiting
         for (size_t i = 0; i < runPageNames.size(); ++i)
         {
-            // Need to parse page name to get table name prefix and page index
-            // Assuming format TableName_run_X_PageY
-            // This cleanup logic needs refinement based on actual page naming.
-            // For now, using a placeholder logic.
-            string runTableNamePrefix = table->tableName + "_run_" + to_string(i / (numBlocks / blocksPerRun)); // Approximate run prefix
-            int pageIndexInRun = i % (numBlocks / blocksPerRun);                                                // Approximate page index
+            string runTableNamePrefix = runPages[i].first;
+            int pageIndexInRun = runPages[i].second;
             bufferManager.deletePage(runTableNamePrefix, pageIndexInRun);                                       // Corrected method name
         }
         return;
@@ -414,11 +420,8 @@ void executeSORT()
     // Initialize cursors and heap
     for (size_t i = 0; i < runPageNames.size(); ++i)
     {
-        // Assuming runPageNames correctly correspond to the pages created.
-        // Need to parse page name to get table name prefix and page index.
-        // Placeholder logic:
-        string runTableNamePrefix = table->tableName + "_run_" + to_string(i / (numBlocks / blocksPerRun)); // Approximate run prefix
-        int pageIndexInRun = i % (numBlocks / blocksPerRun);                                                // Approximate page index
+        string runTableNamePrefix = runPages[i].first;
+        int pageIndexInRun = runPages[i].second;
         runCursors.emplace_back(runTableNamePrefix, pageIndexInRun);
 
         vector<int> row = runCursors[i].getNext();
@@ -434,6 +437,9 @@ void executeSORT()
     int pageCounter = 0;
     int rowCounter = 0;
     vector<vector<int>> pageRows;
+    // Rows move between pages, so the zones and filters are rebuilt page by page
+    table->zoneMap.reset(table->columnCount);
+    table->bloomFilters.clearPages();
 
     while (!minHeap.empty())
     {
@@ -454,8 +460,10 @@ void executeSORT()
         if (rowCounter == table->maxRowsPerBlock)
         {
             // Write the page using Page class
-            Page resultPage(table->tableName, pageCounter, pageRows, rowCounter);
-            resultPage.writePage(); // Write the page
+            Page resultPage(table->tableName, pageCounter, pageRows, rowCounter, table->layout);
+            bufferManager.writePage(resultPage); // Write the page and refresh its frame
+            table->zoneMap.setPage(pageCounter, resultPage);
+            table->bloomFilters.setPage(pageCounter, resultPage);
 
             table->rowsPerBlockCount[pageCounter] = rowCounter; // Update row count for this block
             pageCounter++;
@@ -468,8 +476,10 @@ void executeSORT()
     if (rowCounter > 0)
     {
         // Write the page using Page class
-        Page resultPage(table->tableName, pageCounter, pageRows, rowCounter);
-        resultPage.writePage(); // Write the page
+        Page resultPage(table->tableName, pageCounter, pageRows, rowCounter, table->layout);
+        bufferManager.writePage(resultPage); // Write the page and refresh its frame
+        table->zoneMap.setPage(pageCounter, resultPage);
+        table->bloomFilters.setPage(pageCounter, resultPage);
 
         // Update row count for the last block
         if (pageCounter < table->rowsPerBlockCount.size())
@@ -488,6 +498,7 @@ void executeSORT()
     table->blockCount = pageCounter;
     // Adjust rowsPerBlockCount vector size if necessary
     table->rowsPerBlockCount.resize(table->blockCount);
+    table->invalidateDescriptor();
 
     logger.log("executeSORT: Phase 3 complete. Table data overwritten with sorted data.");
 
@@ -495,17 +506,32 @@ void executeSORT()
     logger.log("executeSORT: Phase 4 - Cleaning up temporary run pages...");
     for (size_t i = 0; i < runPageNames.size(); ++i)
     {
-        // Placeholder logic for deleting temp pages:
-        string runTableNamePrefix = table->tableName + "_run_" + to_string(i / (numBlocks / blocksPerRun)); // Approximate run prefix
-        int pageIndexInRun = i % (numBlocks / blocksPerRun);                                                // Approximate page index
+        string runTableNamePrefix = runPages[i].first;
+        int pageIndexInRun = runPages[i].second;
         bufferManager.deletePage(runTableNamePrefix, pageIndexInRun);                                       // Corrected method name
     }
     logger.log("executeSORT: Cleanup complete.");
 
-    // Rebuild indices as the data pointers are now invalid
-    logger.log("executeSORT: Rebuilding indices after sort...");
-    table->buildIndices();
-    logger.log("executeSORT: Indices rebuilt.");
+    // Every row moved, so the record pointers of the indexes are stale;
+    // rebuild each index with the same strategy from the sorted pages
+    vector<string> indexedColumns;
+    vector<string> hashColumns;
+    for (auto &index : table->indexes)
+    {
+        indexedColumns.push_back(index.first);
+        if (!index.second->isOrdered())
+            hashColumns.push_back(index.first);
+    }
+    if (!indexedColumns.empty())
+    {
+        logger.log("executeSORT: Rebuilding " + to_string(indexedColumns.size()) + " indexes after sort...");
+        if (!buildIndexes(*table, indexedColumns, hashColumns, false))
+        {
+            // No index may keep pointing at the rows' old places
+            table->indexes.clear();
+            cout << "WARNING: Could not rebuild the indexes of '" << table->tableName << "'; they were dropped." << endl;
+        }
+    }
 
     cout << "Sort operation completed successfully on table '" << parsedQuery.sortRelationName << "'." << endl;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "global.h"
 #include "table.h"
+#include "indexBuilder.h"
 /**
  * @brief 
  * SYNTAX: SOURCE filename
@@ -63,6 +64,7 @@ void executeSOURCE()
             continue;
 
         // Parse and execute query
+        finishIndexBuilds(tokenizedQuery);
         if (syntacticParse() && semanticParse())
         {
             executeCommand();
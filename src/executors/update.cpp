@@ -1,4 +1,5 @@
 #include "global.h"
+#include "indexing.h"
 
 /**
  * @brief Placeholder for UPDATE command execution.
@@ -116,11 +117,6 @@ void executeUPDATE()
         return;
     }
 
-    if (!table->multiColumnIndexData.empty()) {
-        logger.log("Invalidating all indices on table '" + table->tableName + "' due to UPDATE operation.");
-        table->clearIndex(); // Clear all column indices
-    }
-
     // Get column indices based on *correct* parsed query structure
     int whereColIdx = table->getColumnIndex(parsedQuery.selectionFirstColumnName); // WHERE column index
     int targetColIdx = table->getColumnIndex(parsedQuery.renameFromColumnName);    // SET column index
@@ -156,78 +152,95 @@ void executeUPDATE()
          return;
      }
 
+    // An equality condition on an indexed column names the pages to visit
+    vector<bool> indexedPages;
+    bool useIndex = opEnum == EQUAL && findIndexedPages(*table, whereColIdx, condVal, indexedPages);
+
+    // Only the index on the SET column changes: each updated row's entry
+    // moves from its old key to the new one. The other indexes stay as they are
+    auto targetIndexEntry = table->indexes.find(table->columns[targetColIdx]);
+    ColumnIndex *targetIndex = targetIndexEntry != table->indexes.end() ? targetIndexEntry->second.get() : nullptr;
+    bool targetIndexLost = false;
+
     logger.log("Starting physical update scan for: UPDATE " + table->tableName +
                " WHERE " + table->columns[whereColIdx] + " " + opStr + " " + to_string(condVal) +
                " SET " + table->columns[targetColIdx] + " = " + to_string(newVal));
 
     long long totalRowsUpdated = 0;
+    int pagesSkipped = 0;
 
     for (int pageIdx = 0; pageIdx < table->blockCount; ++pageIdx) {
+        // Pages the index or the zone shows hold no matching row are not read at all
+        if ((useIndex && !indexedPages[pageIdx]) || !pageMayMatch(*table, pageIdx, whereColIdx, opEnum, condVal)) {
+            pagesSkipped++;
+            continue;
+        }
         bool pageModified = false;
-        Page currentPage = bufferManager.getPage(table->tableName, pageIdx);
+        // Pinned for the whole page pass; cells are updated in the pooled page
+        PageHandle pageHandle = bufferManager.getPage(table->tableName, pageIdx);
+        if (!pageHandle.isValid()) {
+             logger.log("executeUPDATE ERROR: Could not read page " + to_string(pageIdx) + ". Skipping page.");
+             continue;
+        }
+        const Page &currentPage = *pageHandle;
         // Ensure rowsPerBlockCount has an entry for this page index
         if (pageIdx >= (int)table->rowsPerBlockCount.size()) {
              logger.log("executeUPDATE ERROR: Metadata inconsistency - page index " + to_string(pageIdx) + " out of bounds for rowsPerBlockCount. Skipping page.");
              continue;
          }
         int rowsInPage = table->rowsPerBlockCount[pageIdx];
-
-        // Read all rows into a mutable buffer
-        vector<vector<int>> pageData;
-        pageData.reserve(rowsInPage);
-        int rowsReadFromPage = 0;
-        for(int i=0; i<rowsInPage; ++i) {
-            vector<int> row = currentPage.getRow(i);
-            if (!row.empty()) {
-                pageData.push_back(row);
-                rowsReadFromPage++;
-            } else {
-                 logger.log("executeUPDATE WARNING: Reading page " + to_string(pageIdx) + ", got empty row at index " + to_string(i));
-            }
-        }
          // Validate read count
-         if (rowsReadFromPage != rowsInPage) {
-             logger.log("executeUPDATE ERROR: Read " + to_string(rowsReadFromPage) + " rows from page " + to_string(pageIdx) + ", but expected " + to_string(rowsInPage) + ". Skipping page modification.");
+         if (currentPage.getRowCount() != rowsInPage) {
+             logger.log("executeUPDATE ERROR: Read " + to_string(currentPage.getRowCount()) + " rows from page " + to_string(pageIdx) + ", but expected " + to_string(rowsInPage) + ". Skipping page modification.");
              continue;
          }
+        if (whereColIdx >= currentPage.getColumnCount() || targetColIdx >= currentPage.getColumnCount()) {
+            logger.log("executeUPDATE WARNING: Rows on page " + to_string(pageIdx) + " too short. Skipping update check.");
+            continue;
+        }
 
-        // Iterate through the buffered rows and modify if condition met
+        // Modify the page in place wherever the condition is met. Cells are
+        // read one at a time (Page::getCell) rather than through a RowView,
+        // which on a PAX page would transpose the page again after every write
         for (int rowIdx = 0; rowIdx < rowsInPage; ++rowIdx) {
-            // Check bounds
-            if (whereColIdx >= (int)pageData[rowIdx].size() || targetColIdx >= (int)pageData[rowIdx].size()) {
-                logger.log("executeUPDATE WARNING: Row " + to_string(rowIdx) + " on page " + to_string(pageIdx) + " too short. Skipping update check.");
-                 continue;
-            }
-
             // Evaluate WHERE condition using evaluateBinOp
-            if (evaluateBinOp(pageData[rowIdx][whereColIdx], condVal, opEnum))
+            if (evaluateBinOp(currentPage.getCell(rowIdx, whereColIdx), condVal, opEnum))
             {
                 // Condition met, update the target column *if needed*
-                if (pageData[rowIdx][targetColIdx] != newVal) {
-                    logger.log("Updating row at {" + to_string(pageIdx) + "," + to_string(rowIdx) + "}: Setting column '" + table->columns[targetColIdx] + "' from " + to_string(pageData[rowIdx][targetColIdx]) + " to " + to_string(newVal));
-                    pageData[rowIdx][targetColIdx] = newVal;
-                    pageModified = true; // Mark page for writing back
+                int oldVal = currentPage.getCell(rowIdx, targetColIdx);
+                if (oldVal != newVal) {
+                    logger.log("Updating row at {" + to_string(pageIdx) + "," + to_string(rowIdx) + "}: Setting column '" + table->columns[targetColIdx] + "' from " + to_string(oldVal) + " to " + to_string(newVal));
+                    if (targetIndex != nullptr && !targetIndexLost) {
+                        RecordPointer location = {(unsigned int)pageIdx, (unsigned int)rowIdx};
+                        targetIndexLost = !targetIndex->remove(oldVal, location) || !targetIndex->insert(newVal, location);
+                    }
+                    pageHandle.modify().setCell(rowIdx, targetColIdx, newVal); // Marks the frame dirty
+                    pageModified = true;
                     totalRowsUpdated++;
                 }
             }
         }
 
-        // If any row in this page was modified, write the entire modified page back
+        // A modified page stays dirty in the pool and is written back on eviction or flush
         if (pageModified) {
-            logger.log("Writing modified page " + to_string(pageIdx) + " back to disk.");
-            // Use the row count currently in the pageData (which shouldn't change during UPDATE)
-            bufferManager.writePage(table->tableName, pageIdx, pageData, rowsInPage);
+            logger.log("Page " + to_string(pageIdx) + " modified in the buffer pool.");
+            table->zoneMap.setPage(pageIdx, currentPage);
+            if (table->bloomFilters.hasColumn(targetColIdx))
+                table->bloomFilters.setPage(pageIdx, currentPage);
         }
     } 
+    logger.log("executeUPDATE: Skipped " + to_string(pagesSkipped) + " of " + to_string(table->blockCount) + " pages.");
+    if (targetIndexLost) {
+        // The index did not hold a row it should have, so it cannot be trusted
+        logger.log("executeUPDATE WARNING: Dropping the index on '" + table->columns[targetColIdx] + "', which lost track of a row.");
+        table->indexes.erase(table->columns[targetColIdx]);
+    }
 
     if (totalRowsUpdated > 0) {
+        table->invalidateStatistics(targetColIdx);
         cout << "UPDATE completed successfully. " << totalRowsUpdated << " rows updated." << endl;
         logger.log("Total rows updated: " + to_string(totalRowsUpdated));
 
-        // Clear the buffer pool for this table for consistency
-        logger.log("Clearing buffer pool cache for table: " + table->tableName + " after UPDATE.");
-        bufferManager.clearPoolForTable(table->tableName);
-
     } else {
         cout << "UPDATE completed. No rows matched the WHERE condition." << endl;
         logger.log("No rows were updated.");
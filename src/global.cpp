@@ -10,6 +10,8 @@ const unsigned int BLOCK_SIZE = 32768; // Definition for BLOCK_SIZE
 std::vector<std::string> tokenizedQuery;
 ParsedQuery parsedQuery; // Requires full definition from syntacticParser.h
 BufferManager bufferManager;
+MemoryManager memoryManager;
 TableCatalogue tableCatalogue;
 MatrixCatalogue matrixCatalogue;
 Logger logger; // Assuming Logger has a constructor defined in logger.cpp
+SearchPlan searchPlan = AUTO_PLAN;
@@ -6,24 +6,35 @@
 // #include "executor.h" // Forward declare ParsedQuery instead
 #include "logger.h"
 #include "bufferManager.h"
+#include "memoryManager.h"
 #include "tableCatalogue.h"
 #include "matrixCatalogue.h"
 
 // Forward declare ParsedQuery instead of including the full header
 class ParsedQuery;
 
+// How SEARCH picks between an index and a full scan (./server --search-plan)
+enum SearchPlan
+{
+    AUTO_PLAN,  // cheaper of the two by the planner's estimate
+    INDEX_PLAN, // the index whenever it can answer the condition
+    SCAN_PLAN   // always a full scan
+};
+
 // Define constants used globally
 extern const unsigned int BLOCK_SIZE;     // Size of a data block/page in bytes (e.g., 32KB) - Declared extern
-const unsigned int BLOCK_COUNT = 2;       // Number of blocks available in the buffer pool
+const unsigned int BLOCK_COUNT = 2;       // Minimum number of blocks in the buffer pool (see MemoryManager)
 const unsigned int PRINT_COUNT = 20;      // Default number of rows to print
 const unsigned int MATRIX_BLOCK_DIM = 32; // Dimension of a square matrix block (e.g., 32x32) - Adjust as needed
 
 extern std::vector<std::string> tokenizedQuery; // Added extern declaration
 extern ParsedQuery parsedQuery;                 // Global object to hold parsed query details
 extern BufferManager bufferManager;             // Global buffer manager instance
+extern MemoryManager memoryManager;             // Global memory budget, shared by the pool and operators
 extern TableCatalogue tableCatalogue;           // Global table catalogue instance
 extern MatrixCatalogue matrixCatalogue;         // Global matrix catalogue instance
 extern Logger logger;                           // Global logger instance
+extern SearchPlan searchPlan;                   // Plan choice for SEARCH, AUTO_PLAN unless forced at startup
 
 // Function declarations for file checks (definitions in executor.cpp)
 bool isFileExists(const std::string &filename);
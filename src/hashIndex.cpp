@@ -0,0 +1,516 @@
+#include "hashIndex.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * @brief Creates an empty index; its first bucket is written with the first
+ * entry.
+ *
+ * @param tblName
+ * @param colName
+ * @param bufMgr
+ */
+HashIndex::HashIndex(const string &tblName, const string &colName, BufferManager *bufMgr)
+    : ColumnIndex(tblName, colName, bufMgr)
+{
+}
+
+/**
+ * @brief Scrambles the key (the MurmurHash3 finalizer) so that the low bits
+ * the directory uses depend on every bit of the key.
+ */
+unsigned int HashIndex::hashKey(int key)
+{
+    uint32_t hash = (uint32_t)key;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+unsigned int HashIndex::getSlot(int key) const
+{
+    return hashKey(key) & ((1u << this->globalDepth) - 1);
+}
+
+/**
+ * @brief Reuses a page released by a split before growing the segment.
+ */
+unsigned int HashIndex::allocatePage()
+{
+    if (this->freePageIds.empty())
+    {
+        return this->getNewPageId();
+    }
+    unsigned int pageId = this->freePageIds.back();
+    this->freePageIds.pop_back();
+    return pageId;
+}
+
+/**
+ * @brief Reads a bucket page, leaving it pinned in bucket.page.
+ *
+ * @return false if the page cannot be read or does not hold a bucket
+ */
+bool HashIndex::readBucket(unsigned int pageId, HashBucket &bucket)
+{
+    PageHandle handle = this->fetchPage(pageId);
+    if (!handle.isValid())
+    {
+        logger.log("HashIndex::readBucket ERROR: Cannot read page " + to_string(pageId) + " of " + this->indexName);
+        return false;
+    }
+    RowView data = handle->getRowView(0);
+    int count = data.size() < (int)BUCKET_HEADER_INTS ? -1 : data[1];
+    if (count < 0 || count > (int)BUCKET_CAPACITY)
+    {
+        logger.log("HashIndex::readBucket ERROR: Page " + to_string(pageId) + " of " + this->indexName + " does not hold a bucket.");
+        return false;
+    }
+    bucket.pageId = pageId;
+    bucket.localDepth = data[0];
+    bucket.overflowPageId = (unsigned int)data[2];
+    const int *position = data.data() + BUCKET_HEADER_INTS;
+    bucket.keys.assign(position, position + count);
+    position += count;
+    bucket.pointers.resize(count);
+    memcpy(bucket.pointers.data(), position, count * sizeof(RecordPointer));
+    bucket.page = std::move(handle);
+    return true;
+}
+
+/**
+ * @brief Writes a bucket back: in place if it was read from the pool,
+ * straight to its slot otherwise.
+ */
+void HashIndex::writeBucket(HashBucket &bucket)
+{
+    size_t count = bucket.keys.size();
+    vector<int> pageData(NODE_INT_COUNT, 0);
+    pageData[0] = bucket.localDepth;
+    pageData[1] = count;
+    pageData[2] = (int)bucket.overflowPageId;
+    int *position = pageData.data() + BUCKET_HEADER_INTS;
+    copy(bucket.keys.begin(), bucket.keys.end(), position);
+    position += count;
+    memcpy(position, bucket.pointers.data(), count * sizeof(RecordPointer));
+    if (bucket.page.isValid())
+    {
+        bucket.page.modify().setRow(0, RowView(pageData.data(), pageData.size()));
+        return;
+    }
+    this->writeNewPage(bucket.pageId, std::move(pageData));
+}
+
+/**
+ * @brief Collects every entry of the bucket starting at pageId, and the
+ * pages of its chain in order.
+ *
+ * @return false if a page of the chain cannot be read
+ */
+bool HashIndex::readChain(unsigned int pageId, vector<IndexEntry> &entries, vector<unsigned int> &pageIds)
+{
+    while (pageId != INVALID_PAGE_ID)
+    {
+        HashBucket bucket;
+        if (pageIds.size() >= this->pageCount || !this->readBucket(pageId, bucket))
+        {
+            return false;
+        }
+        pageIds.push_back(pageId);
+        for (size_t entryCounter = 0; entryCounter < bucket.keys.size(); entryCounter++)
+        {
+            entries.push_back(IndexEntry{bucket.keys[entryCounter], bucket.pointers[entryCounter]});
+        }
+        pageId = bucket.overflowPageId;
+    }
+    return true;
+}
+
+/**
+ * @brief Rewrites a bucket with the given entries, reusing the pages of its
+ * old chain (the first page stays first), allocating more if the entries do
+ * not fit and releasing the ones no longer needed.
+ *
+ * @param pageIds chain to reuse, updated to the new chain
+ * @param entries
+ * @param localDepth
+ */
+void HashIndex::writeChain(vector<unsigned int> &pageIds, const vector<IndexEntry> &entries, unsigned int localDepth)
+{
+    size_t neededPages = max((size_t)1, (entries.size() + BUCKET_CAPACITY - 1) / BUCKET_CAPACITY);
+    while (pageIds.size() < neededPages)
+    {
+        pageIds.push_back(this->allocatePage());
+    }
+    while (pageIds.size() > neededPages)
+    {
+        this->freePageIds.push_back(pageIds.back());
+        pageIds.pop_back();
+    }
+    size_t entryIndex = 0;
+    for (size_t pageCounter = 0; pageCounter < neededPages; pageCounter++)
+    {
+        HashBucket bucket;
+        bucket.pageId = pageIds[pageCounter];
+        bucket.localDepth = localDepth;
+        bucket.overflowPageId = pageCounter + 1 < neededPages ? pageIds[pageCounter + 1] : INVALID_PAGE_ID;
+        for (; entryIndex < entries.size() && bucket.keys.size() < BUCKET_CAPACITY; entryIndex++)
+        {
+            bucket.keys.push_back(entries[entryIndex].key);
+            bucket.pointers.push_back(entries[entryIndex].pointer);
+        }
+        this->writeBucket(bucket);
+    }
+}
+
+/**
+ * @brief Splits the bucket starting at pageId on the next bit of the hash:
+ * the entries with the bit set move to a new bucket, which takes over the
+ * directory slots with that bit set. The directory doubles first if the
+ * bucket is as deep as the directory.
+ *
+ * @return false if a page of the bucket cannot be read
+ */
+bool HashIndex::splitBucket(unsigned int pageId)
+{
+    vector<IndexEntry> entries;
+    vector<unsigned int> lowPageIds;
+    HashBucket head;
+    if (!this->readBucket(pageId, head))
+    {
+        return false;
+    }
+    unsigned int localDepth = head.localDepth;
+    head.page.release();
+    if (!this->readChain(pageId, entries, lowPageIds))
+    {
+        return false;
+    }
+    if (localDepth == this->globalDepth)
+    {
+        size_t slotCount = this->directory.size();
+        this->directory.resize(2 * slotCount);
+        copy(this->directory.begin(), this->directory.begin() + slotCount, this->directory.begin() + slotCount);
+        this->globalDepth++;
+        logger.log("HashIndex::splitBucket: Directory of " + this->indexName + " now has " + to_string(this->directory.size()) + " slots");
+    }
+
+    vector<IndexEntry> lowEntries, highEntries;
+    for (const IndexEntry &entry : entries)
+    {
+        ((hashKey(entry.key) >> localDepth) & 1 ? highEntries : lowEntries).push_back(entry);
+    }
+    vector<unsigned int> highPageIds;
+    this->writeChain(lowPageIds, lowEntries, localDepth + 1);
+    this->writeChain(highPageIds, highEntries, localDepth + 1);
+    for (size_t slot = 0; slot < this->directory.size(); slot++)
+    {
+        if (this->directory[slot] == pageId && (slot >> localDepth) & 1)
+        {
+            this->directory[slot] = highPageIds[0];
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Whether splitting a full bucket makes room: enough of its entries
+ * (with the new one) must have a different hash from the most common one.
+ * A bucket that mostly holds one key's rows would otherwise split again and
+ * again, doubling the directory each time, only to shed a few other keys; it
+ * grows an overflow page instead.
+ *
+ * @param head first page of the bucket, still pinned
+ * @param key key of the new entry
+ */
+bool HashIndex::isWorthSplitting(const HashBucket &head, int key)
+{
+    unsigned int hash = hashKey(key);
+    bool sameHash = true;
+    for (int headKey : head.keys)
+    {
+        if (hashKey(headKey) != hash)
+        {
+            sameHash = false;
+            break;
+        }
+    }
+    if (sameHash)
+    {
+        return false;
+    }
+    vector<IndexEntry> entries;
+    vector<unsigned int> pageIds;
+    if (!this->readChain(head.pageId, entries, pageIds))
+    {
+        return false;
+    }
+    vector<unsigned int> hashes(1, hash);
+    for (const IndexEntry &entry : entries)
+    {
+        hashes.push_back(hashKey(entry.key));
+    }
+    sort(hashes.begin(), hashes.end());
+    size_t mostCommon = 0;
+    for (size_t runStart = 0, position = 0; position <= hashes.size(); position++)
+    {
+        if (position == hashes.size() || hashes[position] != hashes[runStart])
+        {
+            mostCommon = max(mostCommon, position - runStart);
+            runStart = position;
+        }
+    }
+    return hashes.size() - mostCommon >= BUCKET_CAPACITY / 2;
+}
+
+/**
+ * @brief Adds an entry to its bucket. The entry goes into the bucket's first
+ * page or, failing that, the second; if both are full the bucket splits,
+ * unless splitting would not make room (see isWorthSplitting) or the bucket
+ * is as deep as the directory may grow, in which case a new overflow page is
+ * linked in after the first page. Apart from that decision at most two pages
+ * are read.
+ *
+ * @param checkDuplicate whether to look for the entry first
+ * @return false if the entry is already indexed or a page cannot be read
+ */
+bool HashIndex::addEntry(int key, RecordPointer pointer, bool checkDuplicate)
+{
+    if (checkDuplicate)
+    {
+        vector<RecordPointer> pointers = this->search(key);
+        if (binary_search(pointers.begin(), pointers.end(), pointer))
+        {
+            logger.log("HashIndex::insert: Entry for key " + to_string(key) + " already indexed.");
+            return false;
+        }
+    }
+    if (this->directory.empty())
+    {
+        HashBucket bucket;
+        bucket.pageId = this->allocatePage();
+        this->writeBucket(bucket);
+        this->directory.assign(1, bucket.pageId);
+        this->globalDepth = 0;
+    }
+    while (true)
+    {
+        unsigned int headPageId = this->directory[this->getSlot(key)];
+        HashBucket head;
+        if (!this->readBucket(headPageId, head))
+        {
+            return false;
+        }
+        if (head.keys.size() < BUCKET_CAPACITY)
+        {
+            head.keys.push_back(key);
+            head.pointers.push_back(pointer);
+            this->writeBucket(head);
+            this->entryCount++;
+            return true;
+        }
+        if (head.overflowPageId != INVALID_PAGE_ID)
+        {
+            HashBucket next;
+            if (!this->readBucket(head.overflowPageId, next))
+            {
+                return false;
+            }
+            if (next.keys.size() < BUCKET_CAPACITY)
+            {
+                next.keys.push_back(key);
+                next.pointers.push_back(pointer);
+                this->writeBucket(next);
+                this->entryCount++;
+                return true;
+            }
+        }
+
+        if (head.localDepth < MAX_GLOBAL_DEPTH && this->isWorthSplitting(head, key))
+        {
+            head.page.release();
+            if (!this->splitBucket(headPageId))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        HashBucket overflow;
+        overflow.pageId = this->allocatePage();
+        overflow.localDepth = head.localDepth;
+        overflow.overflowPageId = head.overflowPageId;
+        overflow.keys.push_back(key);
+        overflow.pointers.push_back(pointer);
+        this->writeBucket(overflow);
+        head.overflowPageId = overflow.pageId;
+        this->writeBucket(head);
+        this->entryCount++;
+        return true;
+    }
+}
+
+/**
+ * @brief Inserts the entry (key, pointer) unless it is already indexed.
+ *
+ * @param key
+ * @param pointer
+ * @return false if the entry was already indexed or a page could not be read
+ */
+bool HashIndex::insert(int key, RecordPointer pointer)
+{
+    return this->addEntry(key, pointer, true);
+}
+
+/**
+ * @brief Inserts an entry the caller knows is new, without looking for it
+ * first. Used when building the index from a table's rows.
+ *
+ * @param key
+ * @param pointer
+ * @return false if a page could not be read
+ */
+bool HashIndex::append(int key, RecordPointer pointer)
+{
+    return this->addEntry(key, pointer, false);
+}
+
+/**
+ * @brief Finds the page of the key's bucket chain that holds the entry
+ * (key, pointer).
+ *
+ * @param bucket receives that page, pinned
+ * @param position receives the entry's index in the page
+ * @return false if the entry is not in the index or a page cannot be read
+ */
+bool HashIndex::findEntry(int key, RecordPointer pointer, HashBucket &bucket, size_t &position)
+{
+    if (this->directory.empty())
+    {
+        return false;
+    }
+    unsigned int pageId = this->directory[this->getSlot(key)];
+    for (unsigned int pagesRead = 0; pageId != INVALID_PAGE_ID && pagesRead < this->pageCount; pagesRead++)
+    {
+        if (!this->readBucket(pageId, bucket))
+        {
+            return false;
+        }
+        for (position = 0; position < bucket.keys.size(); position++)
+        {
+            if (bucket.keys[position] == key && bucket.pointers[position] == pointer)
+            {
+                return true;
+            }
+        }
+        pageId = bucket.overflowPageId;
+    }
+    return false;
+}
+
+/**
+ * @brief Removes the entry (key, pointer) from its bucket.
+ *
+ * @param key
+ * @param pointer
+ * @return false if the entry is not in the index
+ */
+bool HashIndex::remove(int key, RecordPointer pointer)
+{
+    HashBucket bucket;
+    size_t position = 0;
+    if (!this->findEntry(key, pointer, bucket, position))
+    {
+        return false;
+    }
+    bucket.keys[position] = bucket.keys.back();
+    bucket.pointers[position] = bucket.pointers.back();
+    bucket.keys.pop_back();
+    bucket.pointers.pop_back();
+    this->writeBucket(bucket);
+    this->entryCount--;
+    return true;
+}
+
+/**
+ * @brief Points the entry (key, from) at to where it is stored. Entries in a
+ * bucket are unordered, so the entry never has to move.
+ *
+ * @param key
+ * @param from
+ * @param to
+ * @return false if the entry is not in the index
+ */
+bool HashIndex::repoint(int key, RecordPointer from, RecordPointer to)
+{
+    HashBucket bucket;
+    size_t position = 0;
+    if (!this->findEntry(key, from, bucket, position))
+    {
+        return false;
+    }
+    bucket.pointers[position] = to;
+    this->writeBucket(bucket);
+    return true;
+}
+
+/**
+ * @brief Every row whose key equals key, ordered by location. The keys are
+ * compared in the pinned bucket pages without copying them out.
+ */
+vector<RecordPointer> HashIndex::search(int key)
+{
+    vector<RecordPointer> result;
+    if (this->directory.empty())
+    {
+        return result;
+    }
+    unsigned int pageId = this->directory[this->getSlot(key)];
+    for (unsigned int pagesRead = 0; pageId != INVALID_PAGE_ID && pagesRead < this->pageCount; pagesRead++)
+    {
+        PageHandle handle = this->fetchPage(pageId);
+        if (!handle.isValid())
+        {
+            logger.log("HashIndex::search ERROR: Cannot read page " + to_string(pageId) + " of " + this->indexName);
+            break;
+        }
+        RowView data = handle->getRowView(0);
+        int count = data.size() < (int)BUCKET_HEADER_INTS ? -1 : data[1];
+        if (count < 0 || count > (int)BUCKET_CAPACITY)
+        {
+            logger.log("HashIndex::search ERROR: Page " + to_string(pageId) + " of " + this->indexName + " does not hold a bucket.");
+            break;
+        }
+        const int *keys = data.data() + BUCKET_HEADER_INTS;
+        const int *pointers = keys + count;
+        for (int entryCounter = 0; entryCounter < count; entryCounter++)
+        {
+            if (keys[entryCounter] == key)
+            {
+                result.push_back(RecordPointer{(unsigned int)pointers[2 * entryCounter], (unsigned int)pointers[2 * entryCounter + 1]});
+            }
+        }
+        pageId = (unsigned int)data[2];
+    }
+    sort(result.begin(), result.end());
+    return result;
+}
+
+/**
+ * @brief A hash index only answers single keys; callers check isOrdered()
+ * before asking for a range.
+ */
+vector<RecordPointer> HashIndex::searchRange(int low, int high)
+{
+    if (low == high)
+    {
+        return this->search(low);
+    }
+    logger.log("HashIndex::searchRange ERROR: " + this->indexName + " cannot answer key ranges.");
+    return vector<RecordPointer>();
+}
@@ -0,0 +1,74 @@
+#ifndef HASHINDEX_H
+#define HASHINDEX_H
+
+#include "indexing.h"
+#include <vector>
+#include <string>
+
+// DO NOT USE "using namespace std;" in header files
+
+// Bucket layout (all ints, k = entry count), one page per bucket:
+//   localDepth | k | overflowPageId | k keys | k (pageId, rowIndex) pairs
+const unsigned int BUCKET_HEADER_INTS = 3;
+const unsigned int BUCKET_CAPACITY = (NODE_INT_COUNT - BUCKET_HEADER_INTS) / ENTRY_INTS;
+// The directory stops doubling here; fuller buckets grow overflow pages
+const unsigned int MAX_GLOBAL_DEPTH = 20;
+
+/**
+ * @brief Deserialized copy of one bucket page. A bucket read from the pool
+ * keeps its page pinned and is written back in place.
+ */
+struct HashBucket
+{
+    unsigned int pageId = INVALID_PAGE_ID;
+    unsigned int localDepth = 0;
+    unsigned int overflowPageId = INVALID_PAGE_ID; // next page of the bucket's chain
+    std::vector<int> keys;
+    std::vector<RecordPointer> pointers;
+    PageHandle page; // invalid for a bucket that is not in the pool
+};
+
+/**
+ * @brief Extendible hash index on one column of a table, for equality
+ * lookups. The directory (2^globalDepth slots, each the first page of a
+ * bucket) is small and kept in memory; the buckets are pages of the index
+ * segment. A full bucket splits on the next bit of the key hash, doubling
+ * the directory when its local depth reaches the global depth, so a lookup
+ * reads one page unless the bucket has overflow pages. Those only appear for
+ * buckets that splitting would not relieve, i.e. that mostly hold the rows
+ * of one key. Buckets are not merged when they empty.
+ */
+class HashIndex : public ColumnIndex
+{
+    std::vector<unsigned int> directory; // slot -> first page of its bucket
+    unsigned int globalDepth = 0;
+    std::vector<unsigned int> freePageIds; // overflow pages released by splits
+
+    static unsigned int hashKey(int key);
+    unsigned int getSlot(int key) const;
+    unsigned int allocatePage();
+    bool readBucket(unsigned int pageId, HashBucket &bucket);
+    void writeBucket(HashBucket &bucket);
+    bool readChain(unsigned int pageId, std::vector<IndexEntry> &entries, std::vector<unsigned int> &pageIds);
+    void writeChain(std::vector<unsigned int> &pageIds, const std::vector<IndexEntry> &entries, unsigned int localDepth);
+    bool isWorthSplitting(const HashBucket &head, int key);
+    bool splitBucket(unsigned int pageId);
+    bool addEntry(int key, RecordPointer pointer, bool checkDuplicate);
+    bool findEntry(int key, RecordPointer pointer, HashBucket &bucket, size_t &position);
+
+public:
+    HashIndex(const std::string &tblName, const std::string &colName, BufferManager *bufMgr);
+
+    const char *getStrategyName() const { return "HASH"; }
+    bool isOrdered() const { return false; }
+    bool insert(int key, RecordPointer pointer);
+    bool append(int key, RecordPointer pointer);
+    bool remove(int key, RecordPointer pointer);
+    bool repoint(int key, RecordPointer from, RecordPointer to);
+    std::vector<RecordPointer> search(int key);
+    std::vector<RecordPointer> searchRange(int low, int high);
+
+    unsigned int getGlobalDepth() const { return globalDepth; }
+};
+
+#endif // HASHINDEX_H
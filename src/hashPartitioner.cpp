@@ -0,0 +1,107 @@
+#include "global.h"
+#include "hashPartitioner.h"
+#include <iostream>
+#include <cstdio>
+
+using namespace std;
+
+/**
+ * @brief Opens one spill file per partition, named
+ * "../data/temp/<name>_Part<index>".
+ *
+ * @param name unique prefix, usually derived from the result table name
+ * @param partitionCount
+ * @param columnCount width of every row passed to add()
+ */
+HashPartitioner::HashPartitioner(const string &name, int partitionCount, int columnCount)
+{
+    logger.log("HashPartitioner::HashPartitioner");
+    this->filePrefix = "../data/temp/" + name + "_Part";
+    this->partitionCount = max(1, partitionCount);
+    this->columnCount = columnCount;
+    this->rowCounts.assign(this->partitionCount, 0);
+    for (int partitionIndex = 0; partitionIndex < this->partitionCount; partitionIndex++)
+    {
+        this->writers.emplace_back(new ofstream(this->getPartitionFileName(partitionIndex), ios::binary | ios::trunc));
+        if (!*this->writers.back())
+        {
+            cerr << "HashPartitioner ERROR: Cannot open " << this->getPartitionFileName(partitionIndex) << endl;
+        }
+    }
+}
+
+HashPartitioner::~HashPartitioner()
+{
+    this->finish();
+    for (int partitionIndex = 0; partitionIndex < this->partitionCount; partitionIndex++)
+    {
+        remove(this->getPartitionFileName(partitionIndex).c_str());
+    }
+}
+
+string HashPartitioner::getPartitionFileName(int partitionIndex) const
+{
+    return this->filePrefix + to_string(partitionIndex);
+}
+
+/**
+ * @brief Maps a key to its partition. The key is scrambled first so runs of
+ * consecutive keys still spread over all partitions.
+ *
+ * @param key
+ * @return int
+ */
+int HashPartitioner::partitionOf(int key) const
+{
+    uint32_t hash = (uint32_t)key * 2654435761u;
+    return (int)((hash ^ (hash >> 16)) % (uint32_t)this->partitionCount);
+}
+
+/**
+ * @brief Appends a row to the partition of key.
+ *
+ * @param key
+ * @param row must have exactly columnCount values
+ */
+void HashPartitioner::add(int key, const RowView &row)
+{
+    int partitionIndex = this->partitionOf(key);
+    this->writers[partitionIndex]->write(reinterpret_cast<const char *>(row.data()), sizeof(int) * this->columnCount);
+    this->rowCounts[partitionIndex]++;
+}
+
+/**
+ * @brief Closes the writers. Must be called after the last add() and before
+ * any readPartition().
+ *
+ */
+void HashPartitioner::finish()
+{
+    for (auto &writer : this->writers)
+    {
+        if (writer && writer->is_open())
+        {
+            writer->close();
+        }
+    }
+}
+
+/**
+ * @brief Reads a whole partition back into memory.
+ *
+ * @param partitionIndex
+ * @return vector<int> rows back to back in row-major order
+ */
+vector<int> HashPartitioner::readPartition(int partitionIndex) const
+{
+    logger.log("HashPartitioner::readPartition");
+    vector<int> rows((size_t)this->rowCounts[partitionIndex] * this->columnCount);
+    ifstream fin(this->getPartitionFileName(partitionIndex), ios::binary);
+    fin.read(reinterpret_cast<char *>(rows.data()), rows.size() * sizeof(int));
+    if ((size_t)fin.gcount() != rows.size() * sizeof(int))
+    {
+        cerr << "HashPartitioner ERROR: Short read from " << this->getPartitionFileName(partitionIndex) << endl;
+        rows.resize(fin.gcount() / sizeof(int) / this->columnCount * this->columnCount);
+    }
+    return rows;
+}
@@ -0,0 +1,42 @@
+#ifndef HASHPARTITIONER_H
+#define HASHPARTITIONER_H
+
+#include "page.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+
+// DO NOT USE "using namespace std;" in header files
+
+/**
+ * @brief Spills rows to a fixed number of temporary partition files by the
+ * hash of a key, so that an operator whose input does not fit in its memory
+ * grant (hash join, GROUP BY) can process one partition at a time. Rows with
+ * the same key always land in the same partition. Partition files hold raw
+ * native ints, row after row, and are deleted when the partitioner is
+ * destroyed.
+ */
+class HashPartitioner
+{
+    std::string filePrefix;
+    int partitionCount;
+    int columnCount;
+    std::vector<std::unique_ptr<std::ofstream>> writers;
+    std::vector<long long> rowCounts;
+
+    std::string getPartitionFileName(int partitionIndex) const;
+
+public:
+    HashPartitioner(const std::string &name, int partitionCount, int columnCount);
+    ~HashPartitioner();
+
+    int partitionOf(int key) const;
+    void add(int key, const RowView &row);
+    void finish();
+    std::vector<int> readPartition(int partitionIndex) const;
+    int getPartitionCount() const { return this->partitionCount; }
+    long long getRowCount(int partitionIndex) const { return this->rowCounts[partitionIndex]; }
+};
+
+#endif // HASHPARTITIONER_H
@@ -0,0 +1,221 @@
+#include "global.h"
+#include "indexBuilder.h"
+#include "table.h"
+#include <algorithm>
+
+using namespace std;
+
+// Background builds the query thread has not finished yet, oldest first
+static vector<unique_ptr<IndexBuild>> pendingBuilds;
+
+/**
+ * @brief Prepares a build of indexes on the named columns (see
+ * IndexBuilderSink); start() runs it.
+ *
+ * @param table
+ * @param columnNames columns to index
+ * @param hashColumnNames those of columnNames that get a HashIndex
+ * @param background read and sort on a separate thread
+ */
+IndexBuild::IndexBuild(Table &table, const vector<string> &columnNames, const vector<string> &hashColumnNames, bool background)
+    : table(&table), sink(columnNames, hashColumnNames, DEFAULT_INDEX_FILL_FACTOR, background), background(background)
+{
+}
+
+IndexBuild::~IndexBuild()
+{
+    if (this->worker.joinable())
+    {
+        this->worker.join();
+    }
+}
+
+/**
+ * @brief Feeds every non-empty page of the table to the sink, then sorts
+ * the entries. Runs on the worker thread of a background build, so it only
+ * reports failures through error.
+ */
+void IndexBuild::collect()
+{
+    vector<int> data;
+    vector<int> rows;
+    for (int pageIndex = 0; pageIndex < (int)this->descriptor->blockCount; pageIndex++)
+    {
+        if (this->descriptor->getRowCount(pageIndex) == 0)
+        {
+            continue;
+        }
+        long long int rowCount = 0;
+        string pageName = Page::getPageName(this->descriptor->tableName, pageIndex);
+        if (!Page::readPageData(this->segment->locate(pageIndex), pageName, this->descriptor->columnCount, this->descriptor->layout, data, rowCount, this->error))
+        {
+            return;
+        }
+        RowBatch batch;
+        batch.rowCount = rowCount;
+        batch.columnCount = this->descriptor->columnCount;
+        batch.data = data.data();
+        if (this->descriptor->layout == PAX_LAYOUT)
+        {
+            // Back to row order, which is what the sink reads
+            rows.resize(data.size());
+            for (int rowCounter = 0; rowCounter < batch.rowCount; rowCounter++)
+            {
+                for (int columnCounter = 0; columnCounter < batch.columnCount; columnCounter++)
+                {
+                    rows[(size_t)rowCounter * batch.columnCount + columnCounter] = data[(size_t)columnCounter * batch.rowCount + rowCounter];
+                }
+            }
+            batch.data = rows.data();
+        }
+        if (!this->sink.consume(*this->table, pageIndex, batch))
+        {
+            this->error = "Cannot index the rows of " + pageName + ".";
+            return;
+        }
+    }
+    if (!this->sink.sortEntries())
+    {
+        this->error = "Cannot sort the index entries.";
+        return;
+    }
+    this->collected = true;
+}
+
+/**
+ * @brief Starts the indexes and collects their entries, here or on the
+ * worker thread.
+ *
+ * @return false if a column does not exist
+ */
+bool IndexBuild::start()
+{
+    logger.log("IndexBuild::start for " + this->table->tableName + (this->background ? " in the background" : ""));
+    if (!this->sink.begin(*this->table))
+    {
+        return false;
+    }
+    bufferManager.flushTable(this->table->tableName);
+    this->descriptor = this->table->getDescriptor();
+    this->segment = bufferManager.getSegment(this->table->tableName);
+    if (this->background)
+    {
+        this->worker = thread(&IndexBuild::collect, this);
+    }
+    else
+    {
+        this->collect();
+    }
+    return true;
+}
+
+/**
+ * @brief Waits for the worker, then writes the index pages and installs the
+ * indexes in the table.
+ *
+ * @return false if the pages could not be read or an index not be built
+ */
+bool IndexBuild::finish()
+{
+    if (this->worker.joinable())
+    {
+        this->worker.join();
+    }
+    if (!this->collected)
+    {
+        cout << "ERROR: Cannot build the indexes of '" << this->table->tableName << "': " << this->error << endl;
+        logger.log("IndexBuild::finish ERROR: " + this->error);
+        return false;
+    }
+    logger.log("IndexBuild::finish for " + this->table->tableName);
+    if (!this->sink.finish(*this->table))
+    {
+        cout << "ERROR: Cannot build the indexes of '" << this->table->tableName << "'." << endl;
+        return false;
+    }
+    return true;
+}
+
+const string &IndexBuild::getTableName() const
+{
+    return this->table->tableName;
+}
+
+bool IndexBuild::isBuilding(const string &columnName) const
+{
+    const vector<string> &columnNames = this->sink.getColumnNames();
+    return find(columnNames.begin(), columnNames.end(), columnName) != columnNames.end();
+}
+
+/**
+ * @brief Builds indexes on the named columns of a table, replacing the
+ * existing indexes on them. A background build returns as soon as its
+ * worker has started; the indexes appear once it is finished.
+ *
+ * @param table
+ * @param columnNames columns to index
+ * @param hashColumnNames those of columnNames that get a HashIndex
+ * @param background
+ * @return false if the build could not start or (in the foreground) failed
+ */
+bool buildIndexes(Table &table, const vector<string> &columnNames, const vector<string> &hashColumnNames, bool background)
+{
+    logger.log("buildIndexes");
+    // A build still running on the same table would read pages this one replaces
+    finishIndexBuilds(vector<string>(1, table.tableName));
+    unique_ptr<IndexBuild> build(new IndexBuild(table, columnNames, hashColumnNames, background));
+    if (!build->start())
+    {
+        return false;
+    }
+    if (!background)
+    {
+        return build->finish();
+    }
+    pendingBuilds.push_back(std::move(build));
+    return true;
+}
+
+/**
+ * @brief Finishes the background builds on every table named among the
+ * tokens of a query, before the query reads or changes the table.
+ *
+ * @param tokens
+ */
+void finishIndexBuilds(const vector<string> &tokens)
+{
+    for (size_t buildIndex = 0; buildIndex < pendingBuilds.size();)
+    {
+        const string &tableName = pendingBuilds[buildIndex]->getTableName();
+        if (find(tokens.begin(), tokens.end(), tableName) == tokens.end())
+        {
+            buildIndex++;
+            continue;
+        }
+        unique_ptr<IndexBuild> build = std::move(pendingBuilds[buildIndex]);
+        pendingBuilds.erase(pendingBuilds.begin() + buildIndex);
+        build->finish();
+    }
+}
+
+void finishAllIndexBuilds()
+{
+    while (!pendingBuilds.empty())
+    {
+        unique_ptr<IndexBuild> build = std::move(pendingBuilds.front());
+        pendingBuilds.erase(pendingBuilds.begin());
+        build->finish();
+    }
+}
+
+bool isIndexBuildPending(const string &tableName, const string &columnName)
+{
+    for (const unique_ptr<IndexBuild> &build : pendingBuilds)
+    {
+        if (build->getTableName() == tableName && build->isBuilding(columnName))
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,59 @@
+#ifndef INDEXBUILDER_H
+#define INDEXBUILDER_H
+
+#include "ingestSink.h"
+#include "segmentFile.h"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// DO NOT USE "using namespace std;" in header files
+
+struct TableDescriptor;
+
+/**
+ * @brief Builds indexes on the rows already in a table's pages, for INDEX ON
+ * and for LOAD ... BACKGROUND. The table's dirty pages are flushed first and
+ * its pages are then read straight from its segment with Page::readPageData
+ * and fed to an IndexBuilderSink one page at a time.
+ *
+ * A background build reads the pages and sorts the entries on its own
+ * thread, like the Prefetcher only using the segment and its own buffers
+ * (the sink is deferred, so no index page is written there); the pool, the
+ * catalogue and the logger stay with the query thread, which writes the
+ * index pages in finish(). Until then the table must not change, so every
+ * command that names the table finishes its builds first (see
+ * finishIndexBuilds).
+ */
+class IndexBuild
+{
+    Table *table;
+    IndexBuilderSink sink;
+    bool background;
+    std::shared_ptr<const TableDescriptor> descriptor; // the pages when the build started
+    std::shared_ptr<SegmentFile> segment;
+    std::thread worker;
+    bool collected = false;
+    std::string error;
+
+    void collect();
+
+public:
+    IndexBuild(Table &table, const std::vector<std::string> &columnNames, const std::vector<std::string> &hashColumnNames, bool background);
+    IndexBuild(const IndexBuild &) = delete;
+    IndexBuild &operator=(const IndexBuild &) = delete;
+    ~IndexBuild();
+
+    bool start();
+    bool finish();
+    const std::string &getTableName() const;
+    bool isBuilding(const std::string &columnName) const;
+};
+
+bool buildIndexes(Table &table, const std::vector<std::string> &columnNames, const std::vector<std::string> &hashColumnNames, bool background);
+void finishIndexBuilds(const std::vector<std::string> &tokens);
+void finishAllIndexBuilds();
+bool isIndexBuildPending(const std::string &tableName, const std::string &columnName);
+
+#endif // INDEXBUILDER_H
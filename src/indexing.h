@@ -5,92 +5,48 @@
 
 #include "page.h"          // Defines Page class
 #include "bufferManager.h" // Defines BufferManager class
+#include <memory>
 #include <vector>
 #include <string>
-#include <utility>   // For std::pair
-#include <cmath>     // For std::floor in calculations
-#include <fstream>   // Used for serialization logic (even if implemented in .cpp)
-#include <sstream>   // Used for serialization logic (even if implemented in .cpp)
-#include <stdexcept> // For exceptions
-#include <limits>    // Needed for searchRange implementation
+#include <fstream>
+#include <queue>
+
+// DO NOT USE "using namespace std;" in header files
 
 // Forward declarations
+class ColumnIndex;
 class BPTree;
 class BPTreeNode;
 
 // --- B+ Tree Parameter Calculation ---
-// Moved inside the include guard and after including global.h
-
-// Size assumptions (in bytes) - adjust if your system or data types differ.
-const unsigned int SIZEOF_INT = sizeof(int);                        // Size of a key
-const unsigned int SIZEOF_UNSIGNED_INT = sizeof(unsigned int);      // Size of a page ID or row index
-const unsigned int SIZEOF_BOOL = sizeof(bool);                      // Size of the isLeaf flag
-const unsigned int SIZEOF_RECORD_POINTER = 2 * SIZEOF_UNSIGNED_INT; // Size of RecordPointer struct
-// Use the literal value directly since BLOCK_SIZE is constexpr 1.0f
-const unsigned int PAGE_SIZE_BYTES = (unsigned int)(1.0f * 1000); // Page size in bytes (as per spec: 1KB blocks = 1000 bytes)
-
-// Estimated overhead per node page for metadata (e.g., isLeaf flag, current key count).
-// This needs to accurately reflect how you store node metadata within the page.
-const unsigned int NODE_METADATA_SIZE = SIZEOF_BOOL + SIZEOF_UNSIGNED_INT; // isLeaf + keyCount
-
-// Calculate Fanout (Order 'm' for internal nodes - max number of children)
-// An internal node with 'k' keys has 'k+1' children pointers.
-// Structure: Meta | Ptr0 | Key1 | Ptr1 | Key2 | Ptr2 | ... | Key(m-1) | Ptr(m-1)
-// PageSize >= MetaSize + m * ChildPtrSize + (m-1) * KeySize
-// PageSize >= MetaSize + m * (ChildPtrSize + KeySize) - KeySize
-// m <= floor( (PageSize - MetaSize + KeySize) / (ChildPtrSize + KeySize) )
-const unsigned int FANOUT = static_cast<unsigned int>(
-    std::floor((float)(PAGE_SIZE_BYTES - NODE_METADATA_SIZE + SIZEOF_INT) /
-               (float)(SIZEOF_UNSIGNED_INT + SIZEOF_INT)));
-
-// Calculate Leaf Capacity (Order 'L' for leaf nodes - max number of key-pointer pairs)
-// Structure: Meta | NextPtr | Key1 | RecPtr1 | Key2 | RecPtr2 | ... | KeyL | RecPtrL
-// PageSize >= MetaSize + NextPtrSize + L * (KeySize + RecordPtrSize)
-// L <= floor( (PageSize - MetaSize - NextPtrSize) / (KeySize + RecordPtrSize) )
-const unsigned int LEAF_MAX_RECORDS = static_cast<unsigned int>(
-    std::floor((float)(PAGE_SIZE_BYTES - NODE_METADATA_SIZE - SIZEOF_UNSIGNED_INT) /
-               (float)(SIZEOF_INT + SIZEOF_RECORD_POINTER)));
-
-// Ensure minimum valid order for B+ Tree functionality
-// Fanout must be >= 3. Leaf capacity must be >= 1.
-const unsigned int MIN_FANOUT = (FANOUT >= 3) ? FANOUT : 3;
-const unsigned int MIN_LEAF_RECORDS = (LEAF_MAX_RECORDS >= 1) ? LEAF_MAX_RECORDS : 1;
 
-// --- End B+ Tree Parameter Calculation ---
+// Every node (or bucket) is one page of its index's segment file: a single
+// row of NODE_INT_COUNT ints, sized so that the page header and the row fill
+// one 4 KB slot whatever the table's BLOCK_SIZE is.
+const unsigned int INDEX_NODE_BYTES = 4096;
+const unsigned int NODE_INT_COUNT = (INDEX_NODE_BYTES - sizeof(PageHeader)) / sizeof(int);
 
-// --- Helper Function Declarations (Implemented in indexing.cpp) ---
+// Node layout (all ints, k = keyCount):
+//   Leaf:     1 | k | nextPageId | k keys | k (pageId, rowIndex) pairs
+//   Internal: 0 | k | 0          | k keys | k (pageId, rowIndex) pairs | k + 1 children
+// An entry is a key and the RecordPointer of its row. Internal nodes store
+// full entries as separators, so every entry has exactly one place in the
+// tree even when many rows share a key. Keys and pointers are stored as
+// contiguous runs so a node is read and written with plain copies.
+const unsigned int NODE_HEADER_INTS = 3;
+const unsigned int ENTRY_INTS = 3;
 
-/**
- * @brief Generates the unique filename for an index node page.
- * Assumes BufferManager can handle filenames in this format.
- * Format: ../data/temp/<tableName>_<columnName>_idx_Page<pageId>
- * @param tableName Name of the table.
- * @param columnName Name of the indexed column.
- * @param pageId Page ID of the index node.
- * @return Standardized filename string.
- */
-std::string getIndexPageName(const std::string &tableName, const std::string &columnName, unsigned int pageId);
+// Max key-pointer pairs for leaf nodes (order L)
+const unsigned int LEAF_MAX_RECORDS = (NODE_INT_COUNT - NODE_HEADER_INTS) / ENTRY_INTS;
+// Max children for internal nodes (order m): header + m - 1 separators + m children
+const unsigned int FANOUT = (NODE_INT_COUNT - NODE_HEADER_INTS + ENTRY_INTS) / (ENTRY_INTS + 1);
 
-/**
- * @brief Serializes a BPTreeNode object into a flat data structure suitable for writing to a page.
- * NOTE: This example uses vector<int> for simplicity. A production system would likely use
- * a char buffer (vector<char> or similar) for precise byte-level control and efficiency.
- * @param node The node object to serialize.
- * @param pageData Output vector representing the serialized page content.
- */
-void serializeNode(BPTreeNode *node, std::vector<int> &pageData);
+const unsigned int INVALID_PAGE_ID = (unsigned int)-1; // no node (empty tree, last leaf)
 
-/**
- * @brief Deserializes page data back into a BPTreeNode object (Leaf or Internal).
- * @param pageData Input vector representing the serialized page content.
- * @param pageId The page ID this data belongs to.
- * @param tree Pointer to the parent BPTree object.
- * @return Pointer to the newly created BPTreeNode object (caller manages deletion).
- * @throws std::runtime_error if deserialization fails (e.g., empty data).
- */
-BPTreeNode *deserializeNode(const std::vector<int> &pageData, unsigned int pageId, BPTree *tree);
+// Share of a node a bulk load fills, leaving the rest for later inserts
+const double DEFAULT_INDEX_FILL_FACTOR = 0.9;
 
-// --- Core Indexing Structures ---
+// --- End B+ Tree Parameter Calculation ---
 
 /**
  * @brief Structure to represent a pointer to a specific record (row)
@@ -119,264 +75,350 @@ struct RecordPointer
 };
 
 /**
- * @brief Abstract Base Class for nodes within the B+ Tree.
- * Defines the common interface for Leaf and Internal nodes.
+ * @brief A key and the row it was read from, ordered by key and then by row
+ * (the order of the entries in the leaves).
+ */
+struct IndexEntry
+{
+    int key;
+    RecordPointer pointer;
+
+    bool operator==(const IndexEntry &other) const
+    {
+        return key == other.key && pointer == other.pointer;
+    }
+    bool operator<(const IndexEntry &other) const
+    {
+        if (key != other.key)
+            return key < other.key;
+        return pointer < other.pointer;
+    }
+};
+
+/**
+ * @brief Separator pushed up to the parent when a node splits: the first
+ * entry of the new right node and the page it was written to.
+ */
+struct NodeSplit
+{
+    int key = 0;
+    RecordPointer pointer = {0, 0};
+    unsigned int pageId = INVALID_PAGE_ID;
+};
+
+// --- Helper Function Declarations (Implemented in indexing.cpp) ---
+
+/**
+ * @brief Relation name under which the pages of the index on
+ * tableName.columnName are kept in the buffer pool and on disk
+ * ("<tableName>_<columnName>_idx", segment "<tableName>_<columnName>_idx.seg").
+ */
+std::string getIndexName(const std::string &tableName, const std::string &columnName);
+
+/**
+ * @brief Page name of an index page, as the buffer manager names it:
+ * ../data/temp/<tableName>_<columnName>_idx_Page<pageId>
+ */
+std::string getIndexPageName(const std::string &tableName, const std::string &columnName, unsigned int pageId);
+
+/**
+ * @brief Serializes a node into the NODE_INT_COUNT ints of its page (see the
+ * node layout above), zero padded.
+ */
+void serializeNode(const BPTreeNode *node, std::vector<int> &pageData);
+
+/**
+ * @brief Rebuilds a node from the row of its page.
+ *
+ * @return nullptr if the row is not a valid node
+ */
+std::unique_ptr<BPTreeNode> deserializeNode(const RowView &pageData, unsigned int pageId, BPTree *tree);
+
+// --- Core Indexing Structures ---
+
+/**
+ * @brief Abstract Base Class for nodes within the B+ Tree. Nodes are
+ * deserialized copies of their pages, which stay pinned while the node
+ * exists (an insert pins one root-to-leaf path); writeNode puts a changed
+ * node back.
+ * keys[i] and pointers[i] form entry i: in a leaf the key of a row and the
+ * row itself, in an internal node a separator.
  */
 class BPTreeNode
 {
 public:
-    bool isLeaf;           // Flag indicating if the node is a leaf (true) or internal (false).
-    std::vector<int> keys; // Stores keys. In internal nodes, keys separate child pointers.
-                           // In leaf nodes, keys correspond to data records.
-    unsigned int pageId;   // The unique Page ID where this node's data is stored on disk/buffer.
-    BPTree *tree;          // Pointer back to the BPTree instance this node belongs to.
-                           // Used to access tree-wide info like BufferManager, constants, etc.
-    unsigned int keyCount; // Current number of keys stored in this node.
+    bool isLeaf;                         // Flag indicating if the node is a leaf (true) or internal (false).
+    std::vector<int> keys;               // Keys of the entries, ascending.
+    std::vector<RecordPointer> pointers; // Row of each entry; orders entries that share a key.
+    unsigned int pageId;                 // Page of the index segment holding this node.
+    BPTree *tree;                        // Owning tree, for node fetches and page allocation.
+    PageHandle page;                     // Pins the node's page while the node is in use; invalid for new nodes.
 
-    /**
-     * @brief Constructor for BPTreeNode.
-     * @param id The page ID for this node.
-     * @param treePtr Pointer to the owning BPTree.
-     * @param leafStatus True if this is a leaf node, false otherwise.
-     */
     BPTreeNode(unsigned int id, BPTree *treePtr, bool leafStatus)
-        : isLeaf(leafStatus), pageId(id), tree(treePtr), keyCount(0) {}
-
-    /**
-     * @brief Virtual destructor.
-     */
+        : isLeaf(leafStatus), pageId(id), tree(treePtr) {}
     virtual ~BPTreeNode() = default;
 
+    unsigned int getKeyCount() const { return this->keys.size(); }
+
     /**
-     * @brief Writes the current state of this node back to its corresponding page
-     * via the BufferManager. Must be implemented by derived classes.
+     * @brief Writes the node to its pinned page, or straight to its slot if it
+     * is a new node.
      */
-    virtual void writeNode() = 0;
+    void writeNode();
 
     /**
-     * @brief Inserts a key-value pair (key and RecordPointer) into the subtree rooted at this node.
-     * Handles splitting if the node overflows.
-     * @param key The key to insert.
-     * @param pointer The RecordPointer associated with the key (only relevant for leaf insertion).
-     * @return Status code: 0=Success, 1=Node split occurred (may require parent update), -1=Error/Duplicate(optional).
+     * @brief Inserts an entry into the subtree rooted at this node, splitting
+     * nodes that overflow.
+     *
+     * @return 0 inserted, 1 inserted and this node split (split describes the
+     * new right sibling), -1 entry already present or a node could not be read
      */
-    virtual int insert(int key, RecordPointer pointer) = 0;
+    virtual int insert(int key, RecordPointer pointer, NodeSplit &split) = 0;
 
     /**
-     * @brief Removes a specific key-pointer pair from the subtree rooted at this node.
-     * Handles underflow by merging or redistributing with siblings.
-     * @param key The key to remove.
-     * @param pointer The specific RecordPointer associated with the key to remove (needed for non-unique keys).
-     * @return Status code: 0=Success, 1=Underflow/Merge occurred (may require parent update), -1=Error/Not Found.
+     * @brief Removes one entry from the subtree. Nodes are not merged when
+     * they underflow; an emptied leaf stays in the leaf chain.
+     *
+     * @return 0 removed, -1 not found
      */
     virtual int remove(int key, const RecordPointer &pointer) = 0;
 
     /**
-     * @brief Searches for a specific key in the subtree rooted at this node.
-     * @param key The key to search for.
-     * @param result Output vector where found RecordPointers are added.
-     * @return True if the key was found, false otherwise.
+     * @brief Changes the pointer of the entry (key, from) to to in place,
+     * including a separator that copies the entry.
+     *
+     * @return 0 changed, -1 not found or to would leave its place in order
      */
-    virtual bool search(int key, std::vector<RecordPointer> &result) = 0;
+    virtual int repoint(int key, const RecordPointer &from, const RecordPointer &to) = 0;
 
     /**
-     * @brief Searches for all keys within a given range [low, high] in the subtree.
-     * Primarily implemented by leaf nodes traversing the linked list.
-     * @param low The lower bound of the key range (inclusive).
-     * @param high The upper bound of the key range (inclusive).
-     * @param result Output vector where found RecordPointers are added.
+     * @brief Appends the pointers of every entry with low <= key <= high to
+     * result, in key order, following the leaf chain (nextPageId).
      */
     virtual void searchRange(int low, int high, std::vector<RecordPointer> &result) = 0;
 
     /**
-     * @brief Finds the index of the first key in the node that is greater than or equal to the given key.
-     * Used for navigation during search, insert, and delete operations.
-     * In internal nodes, determines which child pointer to follow.
-     * @param key The key to compare against.
-     * @return The 0-based index.
+     * @brief Index of the first entry whose key is not less than key. In an
+     * internal node this is the child holding the first such entry.
+     */
+    int findFirstKeyIndex(int key) const;
+
+    /**
+     * @brief Number of entries that are not greater than (key, pointer). In
+     * an internal node this is the child that holds or would hold the entry.
      */
-    virtual int findFirstKeyIndex(int key) = 0;
+    int findEntryIndex(int key, const RecordPointer &pointer) const;
 };
 
 /**
- * @brief Represents a Leaf Node in the B+ Tree.
- * Stores actual key-data (RecordPointer) pairs and pointers to sibling leaves.
+ * @brief Represents a Leaf Node in the B+ Tree. Stores the index entries and
+ * the page of the next leaf, so range scans walk the leaves in key order.
+ * All rows with the same key form one run of entries ordered by
+ * RecordPointer (the key's posting list), which may continue into the
+ * following leaves.
  */
 class BPTreeLeafNode : public BPTreeNode
 {
 public:
-    std::vector<RecordPointer> pointers; // Stores RecordPointers corresponding to keys.
-    unsigned int nextPageId;             // Page ID of the next leaf node in sequence (0 if none).
+    unsigned int nextPageId = INVALID_PAGE_ID; // Page of the next leaf in key order
 
-    /**
-     * @brief Constructor for BPTreeLeafNode.
-     * @param id The page ID for this node.
-     * @param treePtr Pointer to the owning BPTree.
-     */
-    BPTreeLeafNode(unsigned int id, BPTree *treePtr);
-    ~BPTreeLeafNode() override = default;
+    BPTreeLeafNode(unsigned int id, BPTree *treePtr) : BPTreeNode(id, treePtr, true) {}
 
-    // --- Overridden Virtual Methods ---
-    void writeNode() override;
-    int insert(int key, RecordPointer pointer) override;
+    int insert(int key, RecordPointer pointer, NodeSplit &split) override;
     int remove(int key, const RecordPointer &pointer) override;
-    bool search(int key, std::vector<RecordPointer> &result) override;
+    int repoint(int key, const RecordPointer &from, const RecordPointer &to) override;
     void searchRange(int low, int high, std::vector<RecordPointer> &result) override;
-    int findFirstKeyIndex(int key) override;
-
-    // --- Leaf-Specific Logic (to be implemented in .cpp) ---
-    // TODO: Implement split logic: Creates a new sibling node, moves half the data,
-    //       updates next pointers, and returns the middle key to propagate upwards.
-    // int split(BPTreeLeafNode* newNode);
-
-    // TODO: Implement merge/redistribute logic for handling underflow.
 };
 
 /**
  * @brief Represents an Internal Node (Index Node) in the B+ Tree.
- * Stores keys that guide the search and pointers to child nodes.
+ * childrenPageIds[i] holds the entries below separator i (and not below
+ * separator i - 1); the last child holds those from the last separator on.
  */
 class BPTreeInternalNode : public BPTreeNode
 {
 public:
-    // Stores Page IDs of child nodes. If there are 'k' keys, there are 'k+1' children.
-    // childrenPageIds[i] points to the subtree for keys < keys[i].
-    // childrenPageIds[k] points to the subtree for keys >= keys[k-1].
-    std::vector<unsigned int> childrenPageIds;
+    std::vector<unsigned int> childrenPageIds; // keyCount + 1 children
 
-    /**
-     * @brief Constructor for BPTreeInternalNode.
-     * @param id The page ID for this node.
-     * @param treePtr Pointer to the owning BPTree.
-     */
-    BPTreeInternalNode(unsigned int id, BPTree *treePtr);
-    ~BPTreeInternalNode() override = default;
+    BPTreeInternalNode(unsigned int id, BPTree *treePtr) : BPTreeNode(id, treePtr, false) {}
 
-    // --- Overridden Virtual Methods ---
-    void writeNode() override;
-    int insert(int key, RecordPointer pointer) override;
+    int insert(int key, RecordPointer pointer, NodeSplit &split) override;
     int remove(int key, const RecordPointer &pointer) override;
-    bool search(int key, std::vector<RecordPointer> &result) override;
+    int repoint(int key, const RecordPointer &from, const RecordPointer &to) override;
     void searchRange(int low, int high, std::vector<RecordPointer> &result) override;
-    int findFirstKeyIndex(int key) override; // Returns index of the child pointer to follow
 
-    // --- Internal Node-Specific Helpers (implemented in .cpp) ---
-    /**
-     * @brief Fetches the child node corresponding to the given index.
-     * Handles fetching the page via the BufferManager and deserializing it.
-     * @param childIndex The index of the child pointer in childrenPageIds.
-     * @return Pointer to the fetched child node (caller manages deletion).
-     * @throws std::out_of_range if childIndex is invalid.
-     * @throws std::runtime_error if fetching/deserializing fails.
-     */
-    BPTreeNode *fetchChild(int childIndex);
-
-    // Removed declarations for split, merge, redistribute as they are not implemented/defined
-    // bool redistributeWithLeftSibling(...);
-    // bool redistributeWithRightSibling(...);
-    // void mergeWithLeftSibling(...);
-    // void mergeWithRightSibling(...);
-    // bool handleChildUnderflow(...);
+    std::unique_ptr<BPTreeNode> fetchChild(int childIndex);
 };
 
 /**
- * @brief Main B+ Tree class managing the overall index structure for a column.
- * Owns the root node and interacts with the BufferManager and Table.
+ * @brief External sort of index entries for a bulk load. Entries are
+ * collected into a run of as many entries as the memory it is given holds;
+ * a full run is sorted and spilled to "../data/temp/<name>_Run<index>" (raw
+ * entries, like HashPartitioner's files). finish() sorts the last run and,
+ * if anything was spilled, starts a k-way merge that reads every run in
+ * chunks sharing the same memory, so next() hands out the entries in order
+ * without holding them all. spill() instead writes the last run out and
+ * frees the run memory, for a sorter that waits before it is merged. Run
+ * files are deleted when the sorter is destroyed. add() and finish() do not log or touch the pool, so a
+ * background index build fills and sorts its sorters on its own thread.
  */
-class BPTree
+class IndexEntrySorter
 {
-    friend class BPTreeNode; // Allow nodes to access tree members (like bufferManager)
-    friend class BPTreeLeafNode;
-    friend class BPTreeInternalNode;
+    std::string filePrefix;
+    size_t runCapacity; // entries sorted in memory per run
+    std::vector<IndexEntry> buffer;
+    size_t bufferPosition = 0;
+    std::vector<long long> runEntryCounts;
+    long long entryCount = 0;
+    bool finished = false;
+
+    struct RunReader
+    {
+        std::ifstream file;
+        std::vector<IndexEntry> entries;
+        size_t position = 0;
+        long long remaining = 0;
+    };
+    std::vector<std::unique_ptr<RunReader>> readers;
+    typedef std::pair<IndexEntry, int> MergeHead; // current entry of a run, run index
+    std::priority_queue<MergeHead, std::vector<MergeHead>, std::greater<MergeHead>> mergeHeads;
+
+    std::string getRunFileName(int runIndex) const;
+    bool spillRun();
+    bool refill(RunReader &reader, size_t chunkEntries);
 
-private:
+public:
+    IndexEntrySorter(const std::string &name, size_t memoryBytes);
+    IndexEntrySorter(const IndexEntrySorter &) = delete;
+    IndexEntrySorter &operator=(const IndexEntrySorter &) = delete;
+    ~IndexEntrySorter();
+
+    bool add(int key, RecordPointer pointer);
+    bool spill();
+    void setMemory(size_t memoryBytes);
+    bool finish();
+    bool next(IndexEntry &entry);
+    long long getEntryCount() const { return this->entryCount; }
+    int getRunCount() const { return this->runEntryCounts.size(); }
+};
+
+/**
+ * @brief An index on one column of a table: for every row an entry of the
+ * row's key and its RecordPointer. The index's pages are pages of its own
+ * segment file ("<table>_<column>_idx.seg"), INDEX_NODE_BYTES each, read and
+ * written through the buffer pool like table pages (the catalogue describes
+ * them under getIndexName), so only the pages a lookup touches are in
+ * memory. Keys may repeat: each row is a separate entry. Destroying the
+ * index deletes its pages.
+ */
+class ColumnIndex
+{
+protected:
     std::string tableName;           // Name of the table this index belongs to.
     std::string columnName;          // Name of the column this index is built on.
-    unsigned int rootPageId;         // Page ID of the root node (0 if the tree is empty).
+    std::string indexName;           // Relation name of the index pages (see getIndexName).
     BufferManager *bufferManager;    // Pointer to the shared BufferManager instance.
-    const unsigned int fanout;       // Max children for internal nodes (Order m).
-    const unsigned int leafCapacity; // Max key-pointer pairs for leaf nodes (Order L).
+    unsigned int pageCount = 0;      // Pages 0 .. pageCount - 1 are in use.
+    unsigned int describedPages = 0; // Pages covered by the registered descriptor.
+    long long entryCount = 0;
 
-    /**
-     * @brief Fetches a node (Leaf or Internal) from disk/buffer given its page ID.
-     * Uses the BufferManager and node deserialization.
-     * @param pageId The ID of the page containing the node data.
-     * @return Pointer to the fetched BPTreeNode (caller manages deletion).
-     *         Returns nullptr if the page cannot be fetched or is invalid.
-     */
-    BPTreeNode *fetchNode(unsigned int pageId);
-
-    /**
-     * @brief Allocates a new, unused page ID for creating a new index node.
-     * Needs coordination with the BufferManager or a central page allocator.
-     * @return The allocated page ID.
-     * @throws std::runtime_error if allocation fails.
-     */
+    PageHandle fetchPage(unsigned int pageId);
     unsigned int getNewPageId();
+    void writeNewPage(unsigned int pageId, std::vector<int> &&pageData);
+
+public:
+    ColumnIndex(const std::string &tblName, const std::string &colName, BufferManager *bufMgr);
+    ColumnIndex(const ColumnIndex &) = delete;
+    ColumnIndex &operator=(const ColumnIndex &) = delete;
+    virtual ~ColumnIndex();
 
     /**
-     * @brief Updates the rootPageId member and notifies the owning Table object
-     *        so it can update its persisted metadata.
-     * @param newRootId The new page ID of the root node.
+     * @brief Name of the index type as the INDEX command spells it.
      */
-    void updateRoot(unsigned int newRootId);
+    virtual const char *getStrategyName() const = 0;
 
-public:
     /**
-     * @brief Constructs a BPTree instance.
-     * @param tblName Name of the table.
-     * @param colName Name of the indexed column.
-     * @param bufMgr Pointer to the application's BufferManager.
-     * @param rootId The Page ID of the root node. If 0, indicates a new/empty tree.
+     * @brief Whether searchRange can answer key ranges; an unordered index
+     * only answers single keys.
      */
-    BPTree(const std::string &tblName, const std::string &colName, BufferManager *bufMgr, unsigned int rootId = 0);
+    virtual bool isOrdered() const = 0;
 
     /**
-     * @brief Destructor. (Doesn't explicitly delete nodes, assumes owning Table manages BPTree lifetime).
+     * @return false if the entry was already indexed or a page could not be read
      */
-    ~BPTree();
+    virtual bool insert(int key, RecordPointer pointer) = 0;
 
-    void deleteNodePage(unsigned int pageId);
     /**
-     * @brief Inserts a key and its corresponding data pointer into the B+ Tree.
-     * Starts the insertion process from the root. Handles root splits.
-     * @param key The key value to insert.
-     * @param pointer The RecordPointer pointing to the actual data row.
+     * @return false if the entry is not in the index
      */
-    void insert(int key, RecordPointer pointer);
+    virtual bool remove(int key, RecordPointer pointer) = 0;
 
     /**
-     * @brief Removes a specific key-pointer pair from the B+ Tree.
-     * Starts the removal process from the root. Handles root changes (e.g., shrinking height).
-     * @param key The key value to remove.
-     * @param pointer The specific RecordPointer to remove (handles non-unique keys).
+     * @brief Points the entry (key, from) at the row's new location to,
+     * changing it where it is stored instead of removing and inserting it.
+     * For a row that moves within its table, such as one DELETE slides down
+     * over removed rows: no other entry of the key may lie between from and
+     * to.
+     *
+     * @return false if the entry is not in the index or cannot move to to
      */
-    void remove(int key, RecordPointer pointer);
+    virtual bool repoint(int key, RecordPointer from, RecordPointer to) = 0;
 
     /**
-     * @brief Searches for a specific key and returns all associated RecordPointers.
-     * @param key The key to search for.
-     * @return A vector of RecordPointers matching the key. Empty if not found.
+     * @brief Every row whose key equals key, ordered by location.
      */
-    std::vector<RecordPointer> search(int key);
+    virtual std::vector<RecordPointer> search(int key) = 0;
 
     /**
-     * @brief Searches for keys within a given range [low, high] (inclusive).
-     * @param low The lower bound of the key range.
-     * @param high The upper bound of the key range.
-     * @return A vector of RecordPointers for keys within the range.
+     * @brief Every row with low <= key <= high, in key order and, within a
+     * key, by location.
      */
-    std::vector<RecordPointer> searchRange(int low, int high);
+    virtual std::vector<RecordPointer> searchRange(int low, int high) = 0;
 
     // --- Getters ---
-    unsigned int getRootPageId() const { return rootPageId; }
     std::string getTableName() const { return tableName; }
     std::string getColumnName() const { return columnName; }
+    std::string getIndexName() const { return indexName; }
     BufferManager *getBufferManager() const { return bufferManager; }
+    unsigned int getPageCount() const { return pageCount; }
+    long long getEntryCount() const { return entryCount; }
+};
+
+/**
+ * @brief B+ tree index on one column of a table; every page of its segment
+ * is a node. An empty tree can be bulk loaded from sorted entries, which
+ * writes every node once, instead of inserting the rows one by one.
+ */
+class BPTree : public ColumnIndex
+{
+    friend class BPTreeNode;
+    friend class BPTreeLeafNode;
+    friend class BPTreeInternalNode;
+
+private:
+    unsigned int rootPageId = INVALID_PAGE_ID;
+    const unsigned int fanout;       // Max children for internal nodes (Order m).
+    const unsigned int leafCapacity; // Max key-pointer pairs for leaf nodes (Order L).
+
+    std::unique_ptr<BPTreeNode> fetchNode(unsigned int pageId);
+    void updateRoot(unsigned int newRootId);
+
+public:
+    BPTree(const std::string &tblName, const std::string &colName, BufferManager *bufMgr);
+
+    const char *getStrategyName() const { return "BTREE"; }
+    bool isOrdered() const { return true; }
+    bool bulkLoad(IndexEntrySorter &sorter, double fillFactor = DEFAULT_INDEX_FILL_FACTOR);
+    bool insert(int key, RecordPointer pointer);
+    bool remove(int key, RecordPointer pointer);
+    bool repoint(int key, RecordPointer from, RecordPointer to);
+    std::vector<RecordPointer> search(int key);
+    std::vector<RecordPointer> searchRange(int low, int high);
+
+    // --- Getters ---
+    unsigned int getRootPageId() const { return rootPageId; }
     unsigned int getFanout() const { return fanout; }
     unsigned int getLeafCapacity() const { return leafCapacity; }
-
-    // Note: persist() method removed; persistence is handled by the Table saving its metadata (indexRoots map).
 };
 
-#endif // INDEXING_H
\ No newline at end of file
+#endif // INDEXING_H
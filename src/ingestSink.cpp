@@ -0,0 +1,297 @@
+#include "global.h"
+#include "ingestSink.h"
+#include "table.h"
+#include <algorithm>
+
+/**
+ * @brief Copies the batch into a page, transposing it into column order for
+ * PAX tables, and writes the page through the buffer manager.
+ *
+ * @param table
+ * @param pageIndex
+ * @param rows
+ * @return true
+ */
+bool PageWriterSink::consume(Table &table, int pageIndex, const RowBatch &rows)
+{
+    vector<int> data((size_t)rows.rowCount * rows.columnCount);
+    if (table.layout == PAX_LAYOUT)
+    {
+        for (int rowCounter = 0; rowCounter < rows.rowCount; rowCounter++)
+        {
+            for (int columnCounter = 0; columnCounter < rows.columnCount; columnCounter++)
+            {
+                data[(size_t)columnCounter * rows.rowCount + rowCounter] = rows.data[(size_t)rowCounter * rows.columnCount + columnCounter];
+            }
+        }
+    }
+    else
+    {
+        copy(rows.data, rows.data + data.size(), data.begin());
+    }
+    Page page(table.tableName, pageIndex, rows.columnCount, table.layout, std::move(data), rows.rowCount);
+    bufferManager.writePage(page);
+    return true;
+}
+
+bool StatisticsSink::begin(Table &table)
+{
+    table.resetStatistics();
+    return true;
+}
+
+bool StatisticsSink::consume(Table &table, int pageIndex, const RowBatch &rows)
+{
+    for (int rowCounter = 0; rowCounter < rows.rowCount; rowCounter++)
+    {
+        table.updateStatistics(rows.row(rowCounter));
+    }
+    return true;
+}
+
+bool StatisticsSink::finish(Table &table)
+{
+    table.finishStatistics(this->histogramBuckets);
+    return true;
+}
+
+bool ZoneMapSink::begin(Table &table)
+{
+    table.zoneMap.reset(table.columnCount);
+    return true;
+}
+
+bool ZoneMapSink::consume(Table &table, int pageIndex, const RowBatch &rows)
+{
+    table.zoneMap.setPage(pageIndex, rows);
+    return true;
+}
+
+size_t IndexBuilderSink::getSorterCount() const
+{
+    size_t sorterCount = 0;
+    for (const unique_ptr<IndexEntrySorter> &sorter : this->sorters)
+    {
+        if (sorter != nullptr)
+            sorterCount++;
+    }
+    return sorterCount;
+}
+
+/**
+ * @brief Requests the INDEX BUILD grant for the sorters' runs. A run never
+ * needs more than every row of the table, and never gets more than
+ * INDEX_SORT_RUN_BLOCKS, so a build does not take all free memory.
+ *
+ * @param table
+ * @param sorterCount
+ */
+void IndexBuilderSink::requestGrant(const Table &table, size_t sorterCount)
+{
+    size_t runBlocks = INDEX_SORT_RUN_BLOCKS;
+    if (table.rowCount > 0)
+    {
+        size_t runBytes = (size_t)table.rowCount * sizeof(IndexEntry);
+        runBlocks = min(runBlocks, (runBytes + MemoryManager::blockBytes() - 1) / MemoryManager::blockBytes());
+    }
+    this->grant = memoryManager.requestGrant("INDEX BUILD", MIN_WORKING_MEMORY_BLOCKS, sorterCount * runBlocks);
+}
+
+/**
+ * @brief Resolves the column names against the table's header.
+ *
+ * @param table
+ * @return false if a column does not exist or is named twice
+ */
+bool BloomFilterSink::begin(Table &table)
+{
+    vector<int> columnIndexes;
+    for (const string &columnName : this->columnNames)
+    {
+        int columnIndex = table.getColumnIndex(columnName);
+        if (columnIndex < 0 || find(columnIndexes.begin(), columnIndexes.end(), columnIndex) != columnIndexes.end())
+        {
+            cout << "ERROR: Bloom filter column '" << columnName << "' does not exist in table '" << table.tableName << "' or is repeated." << endl;
+            logger.log("BloomFilterSink::begin ERROR: Bad column '" + columnName + "' for table " + table.tableName);
+            return false;
+        }
+        columnIndexes.push_back(columnIndex);
+    }
+    table.bloomFilters.reset(columnIndexes);
+    return true;
+}
+
+bool BloomFilterSink::consume(Table &table, int pageIndex, const RowBatch &rows)
+{
+    table.bloomFilters.setPage(pageIndex, rows);
+    return true;
+}
+
+bool IndexBuilderSink::isHashColumn(const string &columnName) const
+{
+    return find(this->hashColumnNames.begin(), this->hashColumnNames.end(), columnName) != this->hashColumnNames.end();
+}
+
+/**
+ * @brief Resolves the column names against the table's header and starts an
+ * empty index for each, with an entry sorter for each B+ tree (and, when
+ * deferred, each hash index), dropping the table's current index on that
+ * column first (the new index reuses its file name). The sorters split one
+ * INDEX BUILD memory grant between them.
+ *
+ * @param table
+ * @return false if a requested column does not exist
+ */
+bool IndexBuilderSink::begin(Table &table)
+{
+    this->columnIndexes.clear();
+    this->indexes.clear();
+    this->sorters.clear();
+    if (this->columnNames.empty())
+    {
+        this->columnNames = table.columns;
+    }
+    for (const string &columnName : this->columnNames)
+    {
+        int columnIndex = table.getColumnIndex(columnName);
+        if (columnIndex < 0)
+        {
+            cout << "ERROR: Index column '" << columnName << "' does not exist in table '" << table.tableName << "'." << endl;
+            logger.log("IndexBuilderSink::begin ERROR: No column '" + columnName + "' in table " + table.tableName);
+            return false;
+        }
+        this->columnIndexes.push_back(columnIndex);
+    }
+    for (const string &columnName : this->hashColumnNames)
+    {
+        if (find(this->columnNames.begin(), this->columnNames.end(), columnName) == this->columnNames.end())
+        {
+            cout << "ERROR: Hash index column '" << columnName << "' does not exist in table '" << table.tableName << "'." << endl;
+            logger.log("IndexBuilderSink::begin ERROR: Bad hash column '" + columnName + "' for table " + table.tableName);
+            return false;
+        }
+    }
+    size_t sorterCount = 0;
+    for (const string &columnName : this->columnNames)
+    {
+        if (this->deferred || !this->isHashColumn(columnName))
+            sorterCount++;
+    }
+    if (sorterCount > 0)
+    {
+        this->requestGrant(table, sorterCount);
+    }
+    for (const string &columnName : this->columnNames)
+    {
+        table.indexes.erase(columnName);
+        if (this->isHashColumn(columnName))
+            this->indexes.push_back(make_shared<HashIndex>(table.tableName, columnName, &bufferManager));
+        else
+            this->indexes.push_back(make_shared<BPTree>(table.tableName, columnName, &bufferManager));
+        if (this->deferred || !this->isHashColumn(columnName))
+            this->sorters.emplace_back(new IndexEntrySorter(getIndexName(table.tableName, columnName), this->grant.bytes() / sorterCount));
+        else
+            this->sorters.emplace_back();
+    }
+    return true;
+}
+
+bool IndexBuilderSink::consume(Table &table, int pageIndex, const RowBatch &rows)
+{
+    for (size_t indexCounter = 0; indexCounter < this->columnIndexes.size(); indexCounter++)
+    {
+        IndexEntrySorter *sorter = this->sorters[indexCounter].get();
+        HashIndex *hashIndex = sorter == nullptr ? static_cast<HashIndex *>(this->indexes[indexCounter].get()) : nullptr;
+        const int *value = rows.data + this->columnIndexes[indexCounter];
+        for (int rowCounter = 0; rowCounter < rows.rowCount; rowCounter++, value += rows.columnCount)
+        {
+            RecordPointer pointer = {(unsigned int)pageIndex, (unsigned int)rowCounter};
+            if (sorter != nullptr ? !sorter->add(*value, pointer) : !hashIndex->append(*value, pointer))
+            {
+                // Sorters report their own errors; a deferred builder may be off the query thread
+                if (hashIndex != nullptr)
+                    logger.log("IndexBuilderSink::consume ERROR: Cannot index row " + to_string(rowCounter) + " of page " + to_string(pageIndex));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Ends the input of every sorter, so finish has only the index pages
+ * left to write. A deferred builder spills its last runs and releases its
+ * grant here, as it may wait some time before finish is called.
+ *
+ * @return false if a sorter could not write or read its runs
+ */
+bool IndexBuilderSink::sortEntries()
+{
+    bool sorted = true;
+    for (unique_ptr<IndexEntrySorter> &sorter : this->sorters)
+    {
+        if (sorter != nullptr && !(this->deferred ? sorter->spill() : sorter->finish()))
+        {
+            sorted = false;
+            break;
+        }
+    }
+    if (this->deferred)
+    {
+        this->grant.release();
+    }
+    return sorted;
+}
+
+/**
+ * @brief Bulk loads each B+ tree from its sorted entries, fills each
+ * deferred hash index from its sorter, and installs the finished indexes in
+ * the table.
+ *
+ * @param table
+ * @return false if an index could not be built
+ */
+bool IndexBuilderSink::finish(Table &table)
+{
+    bool built = true;
+    size_t sorterCount = this->getSorterCount();
+    if (this->deferred && sorterCount > 0)
+    {
+        // The grant went back after sorting; the merge needs one again
+        this->requestGrant(table, sorterCount);
+        for (unique_ptr<IndexEntrySorter> &sorter : this->sorters)
+        {
+            if (sorter != nullptr)
+                sorter->setMemory(this->grant.bytes() / sorterCount);
+        }
+    }
+    for (size_t indexCounter = 0; indexCounter < this->indexes.size(); indexCounter++)
+    {
+        const string &columnName = this->columnNames[indexCounter];
+        ColumnIndex &index = *this->indexes[indexCounter];
+        IndexEntrySorter *sorter = this->sorters[indexCounter].get();
+        if (sorter != nullptr && index.isOrdered())
+        {
+            built = static_cast<BPTree &>(index).bulkLoad(*sorter, this->fillFactor);
+        }
+        else if (sorter != nullptr)
+        {
+            IndexEntry entry;
+            built = sorter->finish();
+            while (built && sorter->next(entry))
+                built = static_cast<HashIndex &>(index).append(entry.key, entry.pointer);
+        }
+        if (!built)
+        {
+            logger.log("IndexBuilderSink::finish ERROR: Cannot build the index for column '" + columnName + "'");
+            break;
+        }
+        this->sorters[indexCounter].reset();
+        table.indexes[columnName] = this->indexes[indexCounter];
+        logger.log(string(index.getStrategyName()) + " index for column '" + columnName + "' created. Entries: " + to_string(index.getEntryCount()) + ", pages: " + to_string(index.getPageCount()));
+    }
+    this->indexes.clear();
+    this->sorters.clear();
+    this->grant.release();
+    return built;
+}
@@ -0,0 +1,128 @@
+#ifndef INGESTSINK_H
+#define INGESTSINK_H
+
+#include "cursor.h"
+#include "columnStatistics.h"
+#include "hashIndex.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// DO NOT USE "using namespace std;" in header files
+
+class Table;
+
+/**
+ * @brief Receives the rows of a table as Table::blockify produces them, one
+ * page at a time and in file order, so everything that has to look at every
+ * row of a newly loaded table (writing pages, statistics, indexes) is done in
+ * the single parsing pass instead of re-reading the pages afterwards.
+ *
+ * begin is called once the columns are known, consume once per page with the
+ * page's rows (row-major, valid only during the call) and finish after the
+ * last page. A sink that returns false fails the load.
+ */
+class IngestSink
+{
+public:
+    virtual ~IngestSink() {}
+    virtual bool begin(Table & /*table*/) { return true; }
+    virtual bool consume(Table &table, int pageIndex, const RowBatch &rows) = 0;
+    virtual bool finish(Table & /*table*/) { return true; }
+};
+
+/**
+ * @brief Writes each batch as a page of the table, in the table's layout.
+ */
+class PageWriterSink : public IngestSink
+{
+public:
+    bool consume(Table &table, int pageIndex, const RowBatch &rows);
+};
+
+/**
+ * @brief Collects the table's column statistics (see ColumnStatistics).
+ */
+class StatisticsSink : public IngestSink
+{
+    int histogramBuckets;
+
+public:
+    explicit StatisticsSink(int histogramBuckets = DEFAULT_HISTOGRAM_BUCKETS) : histogramBuckets(histogramBuckets) {}
+
+    bool begin(Table &table);
+    bool consume(Table &table, int pageIndex, const RowBatch &rows);
+    bool finish(Table &table);
+};
+
+/**
+ * @brief Builds the table's zone map (see ZoneMap).
+ */
+class ZoneMapSink : public IngestSink
+{
+public:
+    bool begin(Table &table);
+    bool consume(Table &table, int pageIndex, const RowBatch &rows);
+};
+
+/**
+ * @brief Builds per-page Bloom filters on the named columns into
+ * Table::bloomFilters (see PageBloomFilters).
+ */
+class BloomFilterSink : public IngestSink
+{
+    std::vector<std::string> columnNames;
+
+public:
+    explicit BloomFilterSink(const std::vector<std::string> &columnNames) : columnNames(columnNames) {}
+
+    bool begin(Table &table);
+    bool consume(Table &table, int pageIndex, const RowBatch &rows);
+};
+
+// Largest run memory an index entry sorter is granted, in blocks
+const size_t INDEX_SORT_RUN_BLOCKS = 2;
+
+/**
+ * @brief Builds indexes on some or all columns into Table::indexes, one
+ * entry per row, replacing any existing index on the same columns: a
+ * HashIndex on the columns named as hash columns, a B+ tree (see BPTree) on
+ * the others. B+ tree entries are external sorted while the table loads (the
+ * runs share one memory grant) and each tree is bulk loaded at the end; hash
+ * entries go straight into their index.
+ *
+ * A deferred builder sorts the hash entries too and only writes index pages
+ * in finish, so consume and sortEntries, which touch nothing but the
+ * builder's sorters, can run off the query thread (see IndexBuild). Its
+ * sorted runs wait on disk, so sortEntries gives the grant back and finish
+ * requests one again for the merge.
+ */
+class IndexBuilderSink : public IngestSink
+{
+    std::vector<std::string> columnNames;     // empty: every column
+    std::vector<std::string> hashColumnNames; // indexed with a HashIndex
+    std::vector<int> columnIndexes;
+    double fillFactor;
+    bool deferred;
+    std::vector<std::shared_ptr<ColumnIndex>> indexes;
+    std::vector<std::unique_ptr<IndexEntrySorter>> sorters; // null for hash indexes built directly
+    MemoryGrant grant;
+
+    bool isHashColumn(const std::string &columnName) const;
+    size_t getSorterCount() const;
+    void requestGrant(const Table &table, size_t sorterCount);
+
+public:
+    explicit IndexBuilderSink(const std::vector<std::string> &columnNames = std::vector<std::string>(),
+                              const std::vector<std::string> &hashColumnNames = std::vector<std::string>(),
+                              double fillFactor = DEFAULT_INDEX_FILL_FACTOR, bool deferred = false)
+        : columnNames(columnNames), hashColumnNames(hashColumnNames), fillFactor(fillFactor), deferred(deferred) {}
+
+    bool begin(Table &table);
+    bool consume(Table &table, int pageIndex, const RowBatch &rows);
+    bool sortEntries();
+    bool finish(Table &table);
+    const std::vector<std::string> &getColumnNames() const { return this->columnNames; }
+};
+
+#endif // INGESTSINK_H
@@ -1,8 +1,10 @@
 #include "global.h" // Include global definitions like BLOCK_SIZE
 #include "matrix.h"
+#include "csvTokenizer.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <iterator>
 
 extern int BLOCK_SIZE; // Declare the external block size
 
@@ -22,25 +24,23 @@ bool Matrix::load()
         return false;
     }
 
-    string line;
+    string contents((istreambuf_iterator<char>(infile)), istreambuf_iterator<char>());
+    CsvTokenizer tokenizer(contents.data(), contents.data() + contents.size());
+    const char *fieldBegin;
+    const char *fieldEnd;
     int pageIndex = 0;
-    while (getline(infile, line))
+    while (tokenizer.nextLine())
     {
         vector<int> row;
-        stringstream ss(line);
-        string token;
-        while (getline(ss, token, ','))
+        while (tokenizer.nextField(fieldBegin, fieldEnd))
         {
-            try
-            {
-                int value = stoi(token);
-                row.push_back(value);
-            }
-            catch (exception &e)
+            int value;
+            if (parseCsvInteger(fieldBegin, fieldEnd, value) != CSV_PARSE_OK)
             {
                 cout << "Error: Invalid integer in file " << filename << endl;
                 return false;
             }
+            row.push_back(value);
         }
         this->data.push_back(row);
         this->writePage(pageIndex++, row); // Write each row as a separate page
@@ -84,7 +84,6 @@ bool Matrix::blockify()
         return false;
     }
 
-    string line;
     // Assuming the first line contains dimensions (rows, cols) - This might need adjustment based on actual CSV format
     // If dimensions are known beforehand (e.g., from constructor), skip reading them here.
     // For now, let's assume dimensions are already set in the Matrix object.
@@ -107,20 +106,23 @@ bool Matrix::blockify()
     int blockRow = 0, blockCol = 0;
     int rowInBlock = 0, colInBlock = 0;
 
+    string contents((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+    CsvTokenizer tokenizer(contents.data(), contents.data() + contents.size());
+    const char *fieldBegin;
+    const char *fieldEnd;
+
     // Read the matrix data cell by cell
     for (unsigned int r = 0; r < this->dimension; ++r)
     {
-        if (!getline(fin, line))
+        if (!tokenizer.nextLine())
         {
             logger.log("Matrix::blockify ERROR: Not enough rows in CSV file. Expected " + to_string(this->dimension));
             fin.close();
             return false;
         }
-        stringstream ss(line);
-        string cellValueStr;
         for (unsigned int c = 0; c < this->dimension; ++c)
         {
-            if (!getline(ss, cellValueStr, ','))
+            if (!tokenizer.nextField(fieldBegin, fieldEnd))
             {
                 logger.log("Matrix::blockify ERROR: Not enough columns in CSV row " + to_string(r) + ". Expected " + to_string(this->dimension));
                 fin.close();
@@ -142,19 +144,16 @@ bool Matrix::blockify()
             // For simplicity, let's assume we buffer one block at a time.
 
             // Read cell value
-            try
-            {
-                blockData[rowInBlock][colInBlock] = stoi(cellValueStr);
-            }
-            catch (const std::invalid_argument &ia)
+            CsvParseStatus status = parseCsvInteger(fieldBegin, fieldEnd, blockData[rowInBlock][colInBlock]);
+            if (status == CSV_PARSE_INVALID)
             {
-                logger.log("Matrix::blockify ERROR: Invalid integer value '" + cellValueStr + "' at row " + to_string(r) + ", col " + to_string(c));
+                logger.log("Matrix::blockify ERROR: Invalid integer value '" + string(fieldBegin, fieldEnd) + "' at row " + to_string(r) + ", col " + to_string(c));
                 fin.close();
                 return false;
             }
-            catch (const std::out_of_range &oor)
+            if (status == CSV_PARSE_OUT_OF_RANGE)
             {
-                logger.log("Matrix::blockify ERROR: Integer value out of range '" + cellValueStr + "' at row " + to_string(r) + ", col " + to_string(c));
+                logger.log("Matrix::blockify ERROR: Integer value out of range '" + string(fieldBegin, fieldEnd) + "' at row " + to_string(r) + ", col " + to_string(c));
                 fin.close();
                 return false;
             }
@@ -0,0 +1,167 @@
+#include "global.h"
+#include "memoryManager.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+MemoryGrant::MemoryGrant() : memoryManager(nullptr), grantedBlocks(0) {}
+
+MemoryGrant::MemoryGrant(MemoryManager *memoryManager, size_t grantedBlocks) : memoryManager(memoryManager), grantedBlocks(grantedBlocks) {}
+
+MemoryGrant::MemoryGrant(MemoryGrant &&other) : memoryManager(other.memoryManager), grantedBlocks(other.grantedBlocks)
+{
+    other.memoryManager = nullptr;
+    other.grantedBlocks = 0;
+}
+
+MemoryGrant &MemoryGrant::operator=(MemoryGrant &&other)
+{
+    if (this != &other)
+    {
+        this->release();
+        this->memoryManager = other.memoryManager;
+        this->grantedBlocks = other.grantedBlocks;
+        other.memoryManager = nullptr;
+        other.grantedBlocks = 0;
+    }
+    return *this;
+}
+
+MemoryGrant::~MemoryGrant()
+{
+    this->release();
+}
+
+size_t MemoryGrant::bytes() const
+{
+    return this->grantedBlocks * MemoryManager::blockBytes();
+}
+
+/**
+ * @brief Gives the granted blocks back to the budget early. The grant is
+ * empty afterwards.
+ *
+ */
+void MemoryGrant::release()
+{
+    if (this->memoryManager != nullptr)
+    {
+        this->memoryManager->returnGrant(this->grantedBlocks);
+        this->memoryManager = nullptr;
+        this->grantedBlocks = 0;
+    }
+}
+
+MemoryManager::MemoryManager()
+{
+    // Only the shares are computed here; the buffer pool is resized when
+    // setBudget is called from main, after every global is constructed.
+    this->budgetMB = DEFAULT_MEMORY_MB;
+    this->budgetBlocks = DEFAULT_MEMORY_MB * 1024 * 1024 / blockBytes();
+    this->poolBlocks = max((size_t)BLOCK_COUNT, this->budgetBlocks / 4);
+}
+
+/**
+ * @brief Size of one block of memory in bytes. This is the size of a full
+ * table page (see Table::maxRowsPerBlock), so a grant of n blocks holds n
+ * pages worth of rows.
+ *
+ * @return size_t
+ */
+size_t MemoryManager::blockBytes()
+{
+    return (size_t)BLOCK_SIZE * 1000;
+}
+
+/**
+ * @brief Smallest budget that still leaves BLOCK_COUNT buffer frames plus
+ * MIN_WORKING_MEMORY_BLOCKS of working memory.
+ *
+ * @return size_t megabytes
+ */
+size_t MemoryManager::minimumBudgetMB()
+{
+    size_t minimumBytes = (BLOCK_COUNT + MIN_WORKING_MEMORY_BLOCKS) * blockBytes();
+    return (minimumBytes + 1024 * 1024 - 1) / (1024 * 1024);
+}
+
+/**
+ * @brief Sets the memory budget. A quarter of it (but never fewer than
+ * BLOCK_COUNT frames) goes to the buffer pool, which is resized right away;
+ * the rest is working memory for operator grants. Grants that are currently
+ * held are not revoked.
+ *
+ * @param megabytes
+ * @return true if the budget was applied
+ * @return false if it is below minimumBudgetMB()
+ */
+bool MemoryManager::setBudget(size_t megabytes)
+{
+    logger.log("MemoryManager::setBudget");
+    if (megabytes < minimumBudgetMB())
+    {
+        cerr << "MemoryManager::setBudget ERROR: Budget of " << megabytes << " MB is below the minimum of " << minimumBudgetMB() << " MB." << endl;
+        return false;
+    }
+    this->budgetMB = megabytes;
+    this->budgetBlocks = megabytes * 1024 * 1024 / blockBytes();
+    this->poolBlocks = max((size_t)BLOCK_COUNT, this->budgetBlocks / 4);
+    if (this->budgetBlocks < this->poolBlocks + MIN_WORKING_MEMORY_BLOCKS)
+    {
+        this->poolBlocks = BLOCK_COUNT;
+    }
+    bufferManager.setCapacity(this->poolBlocks);
+    logger.log("MemoryManager::setBudget: " + to_string(megabytes) + " MB = " + to_string(this->budgetBlocks) + " blocks, " + to_string(this->poolBlocks) + " for the buffer pool.");
+    return true;
+}
+
+/**
+ * @brief Working memory blocks not currently granted to any operator.
+ *
+ * @return size_t
+ */
+size_t MemoryManager::availableBlocks() const
+{
+    lock_guard<mutex> lock(this->grantMutex);
+    return this->freeBlocks();
+}
+
+// Caller holds grantMutex
+size_t MemoryManager::freeBlocks() const
+{
+    size_t workingBlocks = this->getWorkingBlocks();
+    return this->grantedBlocks >= workingBlocks ? 0 : workingBlocks - this->grantedBlocks;
+}
+
+/**
+ * @brief Grants working memory to an operator: everything that is available,
+ * capped at maxBlocks. An operator always receives at least minBlocks so it
+ * can make progress; if the budget cannot cover that the grant is logged as
+ * over-committed.
+ *
+ * @param requester operator name, for the log
+ * @param minBlocks
+ * @param maxBlocks
+ * @return MemoryGrant
+ */
+MemoryGrant MemoryManager::requestGrant(const string &requester, size_t minBlocks, size_t maxBlocks)
+{
+    logger.log("MemoryManager::requestGrant");
+    lock_guard<mutex> lock(this->grantMutex);
+    size_t available = this->freeBlocks();
+    size_t blocks = min(max(available, minBlocks), max(minBlocks, maxBlocks));
+    if (blocks > available)
+    {
+        logger.log("MemoryManager::requestGrant WARNING: " + requester + " over-commits the budget by " + to_string(blocks - available) + " blocks.");
+    }
+    this->grantedBlocks += blocks;
+    logger.log("MemoryManager::requestGrant: " + requester + " granted " + to_string(blocks) + " blocks.");
+    return MemoryGrant(this, blocks);
+}
+
+void MemoryManager::returnGrant(size_t blocks)
+{
+    lock_guard<mutex> lock(this->grantMutex);
+    this->grantedBlocks -= min(blocks, this->grantedBlocks);
+}
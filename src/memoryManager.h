@@ -0,0 +1,74 @@
+#ifndef MEMORYMANAGER_H
+#define MEMORYMANAGER_H
+
+#include <string>
+#include <cstddef>
+#include <mutex>
+
+// DO NOT USE "using namespace std;" in header files
+
+const size_t DEFAULT_MEMORY_MB = 512;       // Budget used when none is given at startup
+const size_t MIN_WORKING_MEMORY_BLOCKS = 3; // Enough for a two-way merge plus an output block
+
+class MemoryManager;
+
+/**
+ * @brief Working memory handed to an operator by the MemoryManager. The grant
+ * is measured in blocks (one table page worth of bytes) and is returned to
+ * the budget when the grant is released or destroyed, so an operator simply
+ * keeps it alive for as long as it runs. Grants can be moved but not copied.
+ */
+class MemoryGrant
+{
+    MemoryManager *memoryManager;
+    size_t grantedBlocks;
+
+public:
+    MemoryGrant();
+    MemoryGrant(MemoryManager *memoryManager, size_t grantedBlocks);
+    MemoryGrant(MemoryGrant &&other);
+    MemoryGrant &operator=(MemoryGrant &&other);
+    MemoryGrant(const MemoryGrant &) = delete;
+    MemoryGrant &operator=(const MemoryGrant &) = delete;
+    ~MemoryGrant();
+
+    size_t blocks() const { return this->grantedBlocks; }
+    size_t bytes() const;
+    void release();
+};
+
+/**
+ * @brief The MemoryManager owns the engine-wide memory budget. A fixed share
+ * of it sizes the buffer pool; the rest is working memory that operators
+ * (sort runs, hash join partitions, aggregation) request grants from instead
+ * of assuming a fixed number of blocks. The budget is set at startup and can
+ * be changed with SET MEMORY. Grants are requested on the query thread but
+ * may be released from a worker (see IndexBuild), so the granted total is
+ * guarded by grantMutex.
+ */
+class MemoryManager
+{
+    size_t budgetBlocks = 0;
+    size_t poolBlocks = 0;
+    size_t grantedBlocks = 0;
+    size_t budgetMB = 0;
+    mutable std::mutex grantMutex;
+
+    friend class MemoryGrant;
+    void returnGrant(size_t blocks);
+    size_t freeBlocks() const;
+
+public:
+    MemoryManager();
+
+    static size_t blockBytes();
+    static size_t minimumBudgetMB();
+    bool setBudget(size_t megabytes);
+    size_t getBudgetMB() const { return this->budgetMB; }
+    size_t getPoolBlocks() const { return this->poolBlocks; }
+    size_t getWorkingBlocks() const { return this->budgetBlocks - this->poolBlocks; }
+    size_t availableBlocks() const;
+    MemoryGrant requestGrant(const std::string &requester, size_t minBlocks, size_t maxBlocks = (size_t)-1);
+};
+
+#endif // MEMORYMANAGER_H
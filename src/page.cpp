@@ -1,4 +1,5 @@
 #include "global.h"
+#include "pageCodec.h"
 #include "page.h"           // Include the header file for the Page class
 #include "tableCatalogue.h" // Include TableCatalogue definition
 #include "table.h"          // Include the full definition of the Table class
@@ -6,9 +7,32 @@
 #include <string>
 #include <fstream>
 #include <iostream> // For cerr
+#include <algorithm>
+#include <fcntl.h>    // For open()
+#include <unistd.h>   // For close()
+#include <sys/stat.h> // For fstat()
+#include <sys/uio.h>  // For preadv()
+#include <sys/mman.h> // For mmap()
 
 using namespace std; // Make std namespace accessible (acceptable in .cpp)
 
+/**
+ * @brief A read-only private mapping of one page slot. The rows start
+ * right after the PageHeader, so they are used in place. Unmapped when the
+ * last Page sharing it goes away; detached from the file if the slot is
+ * rewritten or removed first (see SlotMapping).
+ */
+struct PageMapping
+{
+    SlotMapping slot;
+    const int *rows;
+
+    PageMapping(void *address, const PageLocation &location) : slot(address, location.bytes, location.fileDescriptor, location.offset)
+    {
+        this->rows = reinterpret_cast<const int *>(static_cast<const char *>(address) + sizeof(PageHeader));
+    }
+};
+
 /**
  * @brief Construct a new Page object. Never used as part of the code
  *
@@ -20,213 +44,589 @@ Page::Page()
     this->pageIndex = -1; // Initialize int pageIndex
     this->rowCount = 0;
     this->columnCount = 0;
-    this->rows.clear();
 }
 
 /**
  * @brief Construct a new Page:: Page object given the table name and page
  * index. When tables are loaded they are broken up into blocks of BLOCK_SIZE
- * and each block is stored in a different file named
- * "<tablename>_Page<pageindex>". For example, If the Page being loaded is of
- * table "R" and the pageIndex is 2 then the file name is "R_Page2". The page
- * loads the rows (or tuples) into a vector of rows (where each row is a vector
- * of integers).
+ * and each block is stored in its own slot of the table's segment file
+ * "<tablename>.seg" (see SegmentFile). Pages are still named
+ * "<tablename>_Page<pageindex>" in logs and messages; for example, if the Page
+ * being loaded is of table "R" and the pageIndex is 2 then it is "R_Page2".
+ * Pages are binary (see PageHeader); the page loads the rows (or tuples)
+ * straight into its contiguous row-major buffer, or, with mapFile, maps its
+ * slot and reads the rows in place. A mapped page is copied into its own
+ * buffer the first time it is modified. Compressed pages are always decoded
+ * into the page's own buffer.
  *
  * @param tableName
  * @param pageIndex
+ * @param mapFile
  */
-Page::Page(const string &tableName, int pageIndex) // Use const&
+Page::Page(const string &tableName, int pageIndex, bool mapFile) // Use const&
 {
     logger.log("Page::Page");
     this->tableName = tableName;
     this->pageIndex = pageIndex; // Assign int pageIndex
-    // Use to_string to convert the int pageIndex for the filename
-    this->pageName = "../data/temp/" + this->tableName + "_Page" + to_string(pageIndex);
-    Table *tablePtr = tableCatalogue.getTable(tableName);
+    // Only the storage descriptor is needed, never a copy of the Table
+    shared_ptr<const TableDescriptor> descriptor = tableCatalogue.getDescriptor(tableName);
 
     // Check if the table exists and the pageIndex is valid
-    if (tablePtr == nullptr || pageIndex < 0 || pageIndex >= tablePtr->blockCount)
+    if (descriptor == nullptr || pageIndex < 0 || pageIndex >= (int)descriptor->blockCount)
     {
         logger.log("Page::Page ERROR: Table '" + tableName + "' not found or invalid page index " + to_string(pageIndex) + ".");
         cerr << "Page::Page ERROR: Table '" << tableName << "' not found or invalid page index " << pageIndex << "." << endl;
-        // Initialize to a safe state
-        this->pageName = "";
-        this->tableName = "";
-        this->pageIndex = -1; // Set int pageIndex to -1
-        this->rowCount = 0;
-        this->columnCount = 0;
-        this->rows.clear();
+        this->invalidate();
         return; // Exit constructor early
     }
+    this->pageName = Page::getPageName(tableName, pageIndex);
+    this->columnCount = descriptor->columnCount;
+    this->layout = descriptor->layout;
 
-    Table table = *tablePtr; // Dereference the pointer safely
-    this->columnCount = table.columnCount;
-    // Use BLOCK_SIZE directly if maxRowsPerBlock isn't reliably set elsewhere
-    // uint maxRowCount = table.maxRowsPerBlock;
-    // Avoid potential division by zero if columnCount is 0 (though unlikely for a valid table)
-    // uint maxRowCount = (this->columnCount > 0) ? (BLOCK_SIZE * 1000 / (sizeof(int) * this->columnCount)) : 0;
-    // if (maxRowCount == 0) maxRowCount = 1; // Ensure at least 1 row can be potentially stored if block size is very small
-
-    // Get the expected row count for this specific block from the table object
-    if (pageIndex < (int)table.rowsPerBlockCount.size())
+    // Get the expected row count for this specific block from the descriptor
+    if (pageIndex >= (int)descriptor->rowsPerBlockCount.size())
     {
-        this->rowCount = table.rowsPerBlockCount[pageIndex]; // Set rowCount based on catalogue info
-        // Reserve space for efficiency, using the known row count for this block
-        this->rows.reserve(this->rowCount);
+        logger.log("Page::Page ERROR: pageIndex " + to_string(pageIndex) + " out of bounds for rowsPerBlockCount vector (size " + to_string(descriptor->rowsPerBlockCount.size()) + ").");
+        cerr << "Page::Page ERROR: pageIndex " << pageIndex << " out of bounds for rowsPerBlockCount vector (size " << descriptor->rowsPerBlockCount.size() << ")." << endl;
+        this->invalidate();
+        return;
     }
-    else
+    long long int expectedRowCount = descriptor->getRowCount(pageIndex);
+
+    // If rowCount for this page is 0, no need to read the file
+    if (expectedRowCount == 0)
     {
-        logger.log("Page::Page ERROR: pageIndex " + to_string(pageIndex) + " out of bounds for rowsPerBlockCount vector (size " + to_string(table.rowsPerBlockCount.size()) + ").");
-        cerr << "Page::Page ERROR: pageIndex " << pageIndex << " out of bounds for rowsPerBlockCount vector (size " << table.rowsPerBlockCount.size() << ")." << endl;
-        // Initialize to a safe state
-        this->pageName = "";
-        this->tableName = "";
-        this->pageIndex = -1;
+        logger.log("Page::Page: Page " + this->pageName + " has 0 rows according to catalogue. Skipping read.");
         this->rowCount = 0;
-        this->columnCount = 0;
-        this->rows.clear();
-        return; // Exit constructor early
+        this->data.clear();
+        return;
     }
 
-    // If rowCount for this page is 0, no need to read the file
-    if (this->rowCount == 0)
+    shared_ptr<SegmentFile> segment = bufferManager.findSegment(tableName);
+    PageLocation location = segment ? segment->locate(pageIndex) : PageLocation();
+    string error;
+    bool loaded = mapFile ? Page::mapPageData(location, this->pageName, this->columnCount, this->layout, this->mapping, this->data, this->rowCount, error)
+                          : Page::readPageData(location, this->pageName, this->columnCount, this->layout, this->data, this->rowCount, error);
+    if (!loaded)
     {
-        logger.log("Page::Page: Page " + this->pageName + " has 0 rows according to catalogue. Skipping read.");
-        // Ensure rows vector is empty
-        this->rows.clear();
-        // No need to open/close file
+        logger.log("Page::Page ERROR: " + error);
+        cerr << "Page::Page ERROR: " << error << endl;
+        this->invalidate();
         return;
     }
+    if (this->rowCount != expectedRowCount)
+    {
+        logger.log("Page::Page WARNING: " + pageName + " holds " + to_string(this->rowCount) + " rows but catalogue expects " + to_string(expectedRowCount) + ". Trusting page header.");
+    }
+}
+
+/**
+ * @brief Construct a Page around values that are already in page order: rows
+ * read from its segment by Page::readPageData (pages loaded by the prefetch
+ * thread) or a block built by Table::blockify.
+ *
+ * @param tableName
+ * @param pageIndex
+ * @param columnCount
+ * @param layout
+ * @param data rowCount * columnCount values, in layout order
+ * @param rowCount
+ */
+Page::Page(const string &tableName, int pageIndex, int columnCount, PageLayout layout, vector<int> &&data, long long int rowCount)
+{
+    logger.log("Page::Page (Constructor with prefetched data)");
+    this->tableName = tableName;
+    this->pageIndex = pageIndex;
+    this->pageName = Page::getPageName(this->tableName, pageIndex);
+    this->columnCount = columnCount;
+    this->layout = layout;
+    this->rowCount = rowCount;
+    this->data = std::move(data);
+}
 
-    ifstream fin(pageName, ios::in);
-    if (!fin)
+/**
+ * @brief Reads and validates a page from its segment slot with a single
+ * preadv straight into the page buffer. A compressed page is read into the
+ * same buffer and then decoded into a new one. This only does file I/O: it
+ * does not consult the catalogue or write to the log, so the prefetch thread
+ * can call it while the query thread runs.
+ *
+ * @param location segment descriptor, slot offset and bytes in use
+ * @param pageName used in error messages
+ * @param columnCount expected width of the rows
+ * @param layout order of the values in the page
+ * @param data receives the rows, in layout order
+ * @param rowCount receives the row count from the page header
+ * @param error receives the reason on failure
+ * @return true on success
+ */
+bool Page::readPageData(const PageLocation &location, const string &pageName, int columnCount, PageLayout layout, vector<int> &data, long long int &rowCount, string &error)
+{
+    if (location.fileDescriptor < 0 || location.bytes < sizeof(PageHeader))
     {
-        logger.log("Page::Page ERROR: Cannot open page file " + pageName);
-        cerr << "Page::Page ERROR: Cannot open page file " << pageName << endl;
-        // Initialize to a safe state
-        this->pageName = "";
-        this->tableName = "";
-        this->pageIndex = -1; // Set int pageIndex to -1
-        this->rowCount = 0;
-        this->columnCount = 0;
-        this->rows.clear();
-        return; // Exit constructor early
+        error = "Page " + pageName + " was never written.";
+        return false;
     }
+    PageHeader header;
+    data.resize((location.bytes - sizeof(PageHeader)) / sizeof(int));
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(PageHeader);
+    iov[1].iov_base = data.data();
+    iov[1].iov_len = data.size() * sizeof(int);
+    ssize_t bytesRead = preadv(location.fileDescriptor, iov, 2, location.offset);
 
-    int number;
-    // Read exactly rowCount rows
-    for (long long int rowCounter = 0; rowCounter < this->rowCount; rowCounter++)
+    if (bytesRead < (ssize_t)sizeof(PageHeader) || header.magic != PAGE_MAGIC ||
+        (header.version != PAGE_FORMAT_VERSION && header.version != PAGE_FORMAT_COMPRESSED))
+    {
+        error = pageName + " is not a valid page.";
+        return false;
+    }
+    bool compressed = header.version == PAGE_FORMAT_COMPRESSED;
+    if ((int)header.columnCount != columnCount ||
+        (!compressed && (size_t)bytesRead < sizeof(PageHeader) + (size_t)header.rowCount * header.columnCount * sizeof(int)))
+    {
+        error = "Header of " + pageName + " does not match its table or payload.";
+        return false;
+    }
+    rowCount = header.rowCount;
+    if (compressed)
     {
-        vector<int> currentRow; // Read into a temporary vector
-        // Reserve space based on columnCount if it's known and > 0
-        if (this->columnCount > 0)
+        vector<int> rows(rowCount * columnCount);
+        if (!decodePage(data.data(), bytesRead - sizeof(PageHeader), rowCount, columnCount, layout == PAX_LAYOUT, rows.data(), error))
         {
-            currentRow.reserve(this->columnCount);
+            error = "Cannot decode " + pageName + ": " + error;
+            return false;
         }
-        for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+        data.swap(rows);
+        return true;
+    }
+    data.resize(rowCount * columnCount);
+    return true;
+}
+
+/**
+ * @brief Maps a page's segment slot read-only and validates its header.
+ * Slots are aligned to the OS page size, so the slot offset is a valid
+ * mapping offset. Plain pages are then read in place; a compressed page is
+ * decoded from the mapping into data and the mapping is dropped. Like
+ * readPageData this is pure I/O.
+ *
+ * @param location segment descriptor, slot offset and bytes in use
+ * @param pageName used in error messages
+ * @param columnCount expected width of the rows
+ * @param layout order of the values in the page
+ * @param mapping receives the mapping of a plain page
+ * @param data receives the rows of a compressed page
+ * @param rowCount receives the row count from the page header
+ * @param error receives the reason on failure
+ * @return true on success
+ */
+bool Page::mapPageData(const PageLocation &location, const string &pageName, int columnCount, PageLayout layout, shared_ptr<const PageMapping> &mapping, vector<int> &data, long long int &rowCount, string &error)
+{
+    if (location.fileDescriptor < 0 || location.bytes < sizeof(PageHeader))
+    {
+        error = "Page " + pageName + " was never written.";
+        return false;
+    }
+    void *address = mmap(nullptr, location.bytes, PROT_READ, MAP_PRIVATE, location.fileDescriptor, location.offset);
+    if (address == MAP_FAILED)
+    {
+        error = "Cannot map page " + pageName;
+        return false;
+    }
+    shared_ptr<const PageMapping> newMapping = make_shared<PageMapping>(address, location);
+    madvise(address, location.bytes, MADV_SEQUENTIAL);
+
+    const PageHeader *header = static_cast<const PageHeader *>(address);
+    if (header->magic != PAGE_MAGIC || (header->version != PAGE_FORMAT_VERSION && header->version != PAGE_FORMAT_COMPRESSED))
+    {
+        error = pageName + " is not a valid page.";
+        return false;
+    }
+    bool compressed = header->version == PAGE_FORMAT_COMPRESSED;
+    if ((int)header->columnCount != columnCount ||
+        (!compressed && location.bytes < sizeof(PageHeader) + (size_t)header->rowCount * header->columnCount * sizeof(int)))
+    {
+        error = "Header of " + pageName + " does not match its table or payload.";
+        return false;
+    }
+    rowCount = header->rowCount;
+    if (compressed)
+    {
+        data.resize(rowCount * columnCount);
+        if (!decodePage(header + 1, location.bytes - sizeof(PageHeader), rowCount, columnCount, layout == PAX_LAYOUT, data.data(), error))
         {
-            if (!(fin >> number))
-            { // Check if read was successful
-                logger.log("Page::Page ERROR: Failed to read data from " + pageName + " at row " + to_string(rowCounter) + ", col " + to_string(columnCounter) + ". File might be corrupted or shorter than expected.");
-                cerr << "Page::Page ERROR: Failed to read data from " + pageName << " at row " << rowCounter << ", col " << columnCounter << endl;
-                fin.close();
-                // Initialize to a safe state or handle partial read
-                // Mark how many rows were actually read before the error
-                this->rowCount = rowCounter;
-                // Clear partially read rows to avoid inconsistent state? Or keep them?
-                // Keeping partially read data might be problematic. Clearing seems safer.
-                this->rows.clear();
-                this->pageIndex = -1; // Indicate failure by setting pageIndex to -1
-                return;
-            }
-            currentRow.push_back(number);
+            error = "Cannot decode " + pageName + ": " + error;
+            return false;
         }
-        // Check if the row read has the expected number of columns
-        if ((int)currentRow.size() != this->columnCount)
+        return true;
+    }
+    mapping = newMapping;
+    return true;
+}
+
+/**
+ * @brief Tells the kernel a page is about to be read so it can start reading
+ * it into the page cache in the background. Used as read-ahead for mapped
+ * pages.
+ *
+ * @param location
+ */
+void Page::adviseWillNeed(const PageLocation &location)
+{
+    if (location.fileDescriptor >= 0 && location.bytes > 0)
+    {
+        posix_fadvise(location.fileDescriptor, location.offset, location.bytes, POSIX_FADV_WILLNEED);
+    }
+}
+
+/**
+ * @brief Start of the rows: the mapping if the page is mapped, else its own
+ * buffer.
+ *
+ * @return const int*
+ */
+const int *Page::rowData() const
+{
+    return this->mapping ? this->mapping->rows : this->data.data();
+}
+
+/**
+ * @brief Position of a value in the page's buffer, according to its layout.
+ *
+ * @param rowIndex
+ * @param columnIndex
+ * @return size_t
+ */
+size_t Page::valueIndex(long long int rowIndex, int columnIndex) const
+{
+    if (this->layout == PAX_LAYOUT)
+    {
+        return (size_t)columnIndex * this->rowCount + rowIndex;
+    }
+    return (size_t)rowIndex * this->columnCount + columnIndex;
+}
+
+/**
+ * @brief The page in the other layout: row-major for a PAX page, column-major
+ * for a row page. Built on first use and kept until the page is modified.
+ *
+ * @return const int*
+ */
+const int *Page::transposedData() const
+{
+    size_t valueCount = (size_t)this->rowCount * this->columnCount;
+    if (this->transposed.size() != valueCount)
+    {
+        const int *values = this->rowData();
+        this->transposed.resize(valueCount);
+        for (long long int rowIndex = 0; rowIndex < this->rowCount; rowIndex++)
         {
-            logger.log("Page::Page WARNING: Row " + to_string(rowCounter) + " in " + pageName + " has incorrect column count (" + to_string(currentRow.size()) + "). Expected " + to_string(this->columnCount));
-            // Decide how to handle: skip row, pad, error out?
-            // For now, let's add it as is, but log a warning. The writePage logic might need adjustment.
+            for (int columnIndex = 0; columnIndex < this->columnCount; columnIndex++)
+            {
+                size_t rowMajorIndex = (size_t)rowIndex * this->columnCount + columnIndex;
+                size_t columnMajorIndex = (size_t)columnIndex * this->rowCount + rowIndex;
+                if (this->layout == PAX_LAYOUT)
+                {
+                    this->transposed[rowMajorIndex] = values[columnMajorIndex];
+                }
+                else
+                {
+                    this->transposed[columnMajorIndex] = values[rowMajorIndex];
+                }
+            }
         }
-        this->rows.push_back(currentRow); // Add the fully read row
     }
+    return this->transposed.data();
+}
+
+/**
+ * @brief Copies the rows of a mapped page into the page's own buffer and
+ * drops the mapping, so the page can be modified.
+ *
+ */
+void Page::makeWritable()
+{
+    if (!this->mapping)
+    {
+        return;
+    }
+    const int *rows = this->mapping->rows;
+    this->data.assign(rows, rows + (size_t)this->rowCount * this->columnCount);
+    this->mapping.reset();
+}
+
+/**
+ * @brief Resets the page to the empty state used to signal a failed load
+ * (pageIndex == -1).
+ *
+ */
+void Page::invalidate()
+{
+    this->pageName = "";
+    this->tableName = "";
+    this->pageIndex = -1;
+    this->rowCount = 0;
+    this->columnCount = 0;
+    this->data.clear();
+    this->transposed.clear();
+    this->mapping.reset();
+}
+
+/**
+ * @brief Get a copy of the row indexed by rowIndex. Prefer getRowView() in
+ * loops; this allocates a new vector on every call.
+ *
+ * @param rowIndex
+ * @return vector<int> empty if rowIndex is out of bounds
+ */
+vector<int> Page::getRow(int rowIndex) const
+{
+    return this->getRowView(rowIndex).toVector();
+}
+
+/**
+ * @brief Get a zero-copy view of the row indexed by rowIndex. The rows of a
+ * PAX page are viewed in a row-major copy of the page made on first use, so
+ * scans of PAX tables should read columns (getColumn) instead.
+ *
+ * @param rowIndex
+ * @return RowView empty view if rowIndex is out of bounds
+ */
+RowView Page::getRowView(int rowIndex) const
+{
+    if (rowIndex < 0 || (long long int)rowIndex >= this->rowCount)
+    {
+        return RowView();
+    }
+    const int *rows = this->layout == PAX_LAYOUT ? this->transposedData() : this->rowData();
+    return RowView(rows + (size_t)rowIndex * this->columnCount, this->columnCount);
+}
 
-    // After the loop, check if there's more data in the file than expected (rowCount rows)
-    // This could indicate corruption or an issue with rowCount tracking.
-    if (fin >> number)
+/**
+ * @brief Get a zero-copy pointer to the rowCount values of a column. For a
+ * PAX page these are read in place; for a row page a column-major copy of the
+ * page is made on first use. Valid while the page is alive and unmodified.
+ *
+ * @param columnIndex
+ * @return const int* nullptr if columnIndex is out of bounds
+ */
+const int *Page::getColumn(int columnIndex) const
+{
+    if (columnIndex < 0 || columnIndex >= this->columnCount)
     {
-        logger.log("Page::Page WARNING: File " + pageName + " contains more data than expected (" + to_string(this->rowCount) + " rows).");
-        cerr << "Page::Page WARNING: File " + pageName + " contains more data than expected (" << this->rowCount << " rows)." << endl;
-        // Read and discard the rest? Or just log? For now, just log.
+        return nullptr;
     }
+    const int *columns = this->layout == PAX_LAYOUT ? this->rowData() : this->transposedData();
+    return columns + (size_t)columnIndex * this->rowCount;
+}
 
-    fin.close();
+/**
+ * @brief Reads a single value in place, in either layout. Unlike getRowView
+ * and getColumn it never builds the transposed copy, so it stays cheap while
+ * the page is being modified.
+ *
+ * @param rowIndex
+ * @param columnIndex
+ * @return int the value; the caller checks the bounds
+ */
+int Page::getCell(int rowIndex, int columnIndex) const
+{
+    return this->rowData()[this->valueIndex(rowIndex, columnIndex)];
+}
 
-    // Final check: Verify that the number of rows read matches the expected rowCount
-    if (this->rows.size() != (size_t)this->rowCount)
+/**
+ * @brief Overwrites a single value of the page in memory. Call writePage() (or
+ * BufferManager::writePage(Page&)) to persist it.
+ *
+ * @param rowIndex
+ * @param columnIndex
+ * @param value
+ */
+void Page::setCell(int rowIndex, int columnIndex, int value)
+{
+    if (rowIndex < 0 || (long long int)rowIndex >= this->rowCount || columnIndex < 0 || columnIndex >= this->columnCount)
     {
-        logger.log("Page::Page WARNING: Number of rows read (" + to_string(this->rows.size()) + ") does not match expected rowCount (" + to_string(this->rowCount) + ") for file " + pageName + ". Adjusting rowCount.");
-        cerr << "Page::Page WARNING: Number of rows read (" << this->rows.size() << ") does not match expected rowCount (" << this->rowCount << ") for file " << pageName << ". Adjusting rowCount." << endl;
-        this->rowCount = this->rows.size(); // Adjust rowCount to actual number of rows read
-        // This discrepancy might indicate an issue elsewhere (e.g., table metadata update)
+        logger.log("Page::setCell ERROR: cell {" + to_string(rowIndex) + "," + to_string(columnIndex) + "} out of bounds.");
+        return;
     }
+    this->makeWritable();
+    this->data[this->valueIndex(rowIndex, columnIndex)] = value;
+    this->transposed.clear();
 }
 
 /**
- * @brief Get row from page indexed by rowIndex
+ * @brief Overwrites the row at rowIndex with the contents of row. The view may
+ * point into this same page (used to compact rows in place).
  *
  * @param rowIndex
- * @return vector<int>
+ * @param row
  */
-vector<int> Page::getRow(int rowIndex)
+void Page::setRow(int rowIndex, const RowView &row)
 {
-    // logger.log("Page::getRow"); // Logging this for every row access might be too verbose
-    // Use unsigned comparison for safety with vector index
-    // Also check against the actual size of the rows vector, not just rowCount
-    if (rowIndex >= 0 && (size_t)rowIndex < this->rows.size())
+    if (rowIndex < 0 || (long long int)rowIndex >= this->rowCount || row.size() != this->columnCount)
+    {
+        logger.log("Page::setRow ERROR: row " + to_string(rowIndex) + " out of bounds or wrong width.");
+        return;
+    }
+    // row may point into the mapping; keep it alive until the copy is done
+    shared_ptr<const PageMapping> rowSource = this->mapping;
+    this->makeWritable();
+    if (this->layout == PAX_LAYOUT)
+    {
+        // row may point into the transposed copy, which is only dropped after
+        for (int columnIndex = 0; columnIndex < this->columnCount; columnIndex++)
+        {
+            this->data[this->valueIndex(rowIndex, columnIndex)] = row[columnIndex];
+        }
+    }
+    else
     {
-        // Return a copy of the row
-        return this->rows[rowIndex];
+        int *target = this->data.data() + (size_t)rowIndex * this->columnCount;
+        if (target != row.data())
+        {
+            copy(row.begin(), row.end(), target);
+        }
     }
+    this->transposed.clear();
+}
 
-    // Log if the index is out of bounds based on the actual vector size
-    if (rowIndex < 0 || (size_t)rowIndex >= this->rows.size())
+/**
+ * @brief Copies the row at fromRowIndex over the row at toRowIndex, in place
+ * in either layout (used to compact rows without a RowView of a PAX page).
+ *
+ * @param fromRowIndex
+ * @param toRowIndex
+ */
+void Page::moveRow(int fromRowIndex, int toRowIndex)
+{
+    if (fromRowIndex < 0 || (long long int)fromRowIndex >= this->rowCount || toRowIndex < 0 || (long long int)toRowIndex >= this->rowCount)
     {
-        // logger.log("Page::getRow WARN: rowIndex " + to_string(rowIndex) + " out of bounds [0, " + to_string(this->rows.size()) + ").");
+        logger.log("Page::moveRow ERROR: row " + to_string(fromRowIndex) + " or " + to_string(toRowIndex) + " out of bounds.");
+        return;
     }
-    // This condition indicates an inconsistency between rowCount and rows.size() if it triggers
-    // when the previous condition didn't.
-    else if ((long long int)rowIndex >= this->rowCount)
+    if (fromRowIndex == toRowIndex)
     {
-        logger.log("Page::getRow ERROR: rowIndex " + to_string(rowIndex) + " is within internal rows vector size (" + to_string(this->rows.size()) + ") but exceeds stored rowCount (" + to_string(this->rowCount) + ").");
-        cerr << "Page::getRow ERROR: rowIndex " << rowIndex << " is within internal rows vector size (" << this->rows.size() << ") but exceeds stored rowCount (" << this->rowCount << ")." << endl;
+        return;
     }
+    this->makeWritable();
+    for (int columnIndex = 0; columnIndex < this->columnCount; columnIndex++)
+    {
+        this->data[this->valueIndex(toRowIndex, columnIndex)] = this->data[this->valueIndex(fromRowIndex, columnIndex)];
+    }
+    this->transposed.clear();
+}
 
-    return vector<int>(); // Return empty vector if index is invalid or out of bounds
+/**
+ * @brief Appends a row at the end of the page. Any RowView taken earlier may
+ * be invalidated.
+ *
+ * @param row must have exactly columnCount values
+ */
+void Page::appendRow(const vector<int> &row)
+{
+    if ((int)row.size() != this->columnCount)
+    {
+        logger.log("Page::appendRow ERROR: row has " + to_string(row.size()) + " values, expected " + to_string(this->columnCount) + ".");
+        return;
+    }
+    this->makeWritable();
+    if (this->layout == PAX_LAYOUT)
+    {
+        // Each column grows by one value; the last column is extended first
+        // so the insert positions of the earlier ones do not move
+        for (int columnIndex = this->columnCount - 1; columnIndex >= 0; columnIndex--)
+        {
+            this->data.insert(this->data.begin() + (size_t)(columnIndex + 1) * this->rowCount, row[columnIndex]);
+        }
+    }
+    else
+    {
+        this->data.insert(this->data.end(), row.begin(), row.end());
+    }
+    this->rowCount++;
+    this->transposed.clear();
 }
 
-Page::Page(const string &tableName, int pageIndex, vector<vector<int>> rows, int rowCount) // Use const&
+/**
+ * @brief Drops every row from newRowCount onwards.
+ *
+ * @param newRowCount
+ */
+void Page::truncate(long long int newRowCount)
+{
+    if (newRowCount < 0 || newRowCount >= this->rowCount)
+    {
+        return;
+    }
+    this->makeWritable();
+    if (this->layout == PAX_LAYOUT)
+    {
+        // Close up the columns; each one only moves towards the front
+        for (int columnIndex = 1; columnIndex < this->columnCount; columnIndex++)
+        {
+            auto source = this->data.begin() + (size_t)columnIndex * this->rowCount;
+            copy(source, source + newRowCount, this->data.begin() + (size_t)columnIndex * newRowCount);
+        }
+    }
+    this->rowCount = newRowCount;
+    this->data.resize(newRowCount * this->columnCount);
+    this->transposed.clear();
+}
+
+/**
+ * @brief Construct a Page from rows built outside the pool (blockify and the
+ * data modification commands), to be written with writePage().
+ *
+ * @param tableName
+ * @param pageIndex
+ * @param rows
+ * @param rowCount number of leading entries of rows that belong to the page
+ * @param layout layout of the table the page belongs to
+ */
+Page::Page(const string &tableName, int pageIndex, vector<vector<int>> rows, int rowCount, PageLayout layout) // Use const&
 {
     logger.log("Page::Page (Constructor with rows)");
     this->tableName = tableName;
-    this->pageIndex = pageIndex;  // Assign int pageIndex
-    this->rows = std::move(rows); // Use move semantics for efficiency
-    this->rowCount = rowCount;
+    this->pageIndex = pageIndex; // Assign int pageIndex
+    this->layout = layout;
     // Ensure columnCount is set correctly, handle empty rows case
-    this->columnCount = (this->rows.empty() || this->rows[0].empty()) ? 0 : this->rows[0].size();
+    this->columnCount = (rows.empty() || rows[0].empty()) ? 0 : rows[0].size();
     // Use to_string to convert the int pageIndex for the filename
-    this->pageName = "../data/temp/" + this->tableName + "_Page" + to_string(pageIndex);
+    this->pageName = Page::getPageName(this->tableName, pageIndex);
+
+    // Callers commonly pass a buffer sized for a full block together with the
+    // number of rows actually filled; only those rows belong to the page.
+    if (rowCount > (int)rows.size())
+    {
+        logger.log("Page::Page(rows) WARNING: Provided rowCount (" + to_string(rowCount) + ") exceeds actual rows vector size (" + to_string(rows.size()) + "). Using vector size.");
+        rowCount = rows.size();
+    }
+    this->rowCount = rowCount;
 
-    // Add a check for consistency between rowCount and actual rows size
-    if (this->rowCount != (long long int)this->rows.size())
+    // Flatten into the page buffer. Short rows are padded with 0 so every
+    // row keeps the fixed columnCount width.
+    this->data.assign((size_t)rowCount * this->columnCount, 0);
+    for (int rowCounter = 0; rowCounter < rowCount; rowCounter++)
     {
-        logger.log("Page::Page(rows) WARNING: Provided rowCount (" + to_string(this->rowCount) + ") differs from actual rows vector size (" + to_string(this->rows.size()) + "). Using vector size.");
-        this->rowCount = this->rows.size();
+        const vector<int> &row = rows[rowCounter];
+        if ((int)row.size() != this->columnCount)
+        {
+            logger.log("Page::Page(rows) WARNING: Row " + to_string(rowCounter) + " has incorrect column count (" + to_string(row.size()) + ") vs expected (" + to_string(this->columnCount) + "). Padding/truncating.");
+        }
+        size_t colsToCopy = min(row.size(), (size_t)this->columnCount);
+        for (size_t columnCounter = 0; columnCounter < colsToCopy; columnCounter++)
+        {
+            this->data[this->valueIndex(rowCounter, columnCounter)] = row[columnCounter];
+        }
     }
 }
 
 /**
- * @brief writes current page contents to file.
+ * @brief writes current page contents into its slot of the table's segment
+ * file (see SegmentFile). With page compression on, the columns are encoded
+ * (see encodePage) and the page is stored compressed whenever that is smaller.
  *
  */
 void Page::writePage()
@@ -239,65 +639,37 @@ void Page::writePage()
         cerr << "Page::writePage ERROR: Page name is empty or page index (" << this->pageIndex << ") is invalid, cannot write." << endl;
         return;
     }
-    ofstream fout(this->pageName, ios::trunc); // Use trunc to overwrite existing file
-    if (!fout)
+    PageHeader header;
+    header.magic = PAGE_MAGIC;
+    header.version = PAGE_FORMAT_VERSION;
+    header.columnCount = this->columnCount;
+    header.rowCount = this->rowCount;
+
+    size_t rawBytes = (size_t)this->rowCount * this->columnCount * sizeof(int);
+    const void *payload = this->rowData();
+    size_t payloadBytes = rawBytes;
+    vector<uint64_t> encoded;
+    size_t encodedBytes = 0;
+    if (bufferManager.getPageCompression() && encodePage(this->rowData(), this->rowCount, this->columnCount, this->layout == PAX_LAYOUT, encoded, encodedBytes))
     {
-        logger.log("Page::writePage ERROR: Cannot open file for writing: " + this->pageName);
-        cerr << "Page::writePage ERROR: Cannot open file for writing: " << this->pageName << endl;
-        return;
+        header.version = PAGE_FORMAT_COMPRESSED;
+        payload = encoded.data();
+        payloadBytes = encodedBytes;
     }
-    // Ensure rowCount doesn't exceed the actual number of rows stored
-    // Use the actual size of the rows vector for iteration safety
-    size_t actualRowCount = this->rows.size();
-    // Update the object's rowCount if it differs from the vector size before writing
-    // This might indicate an earlier inconsistency.
-    if (this->rowCount != (long long int)actualRowCount)
+
+    shared_ptr<SegmentFile> segment = bufferManager.getSegment(this->tableName, sizeof(PageHeader) + rawBytes);
+    string error;
+    if (segment == nullptr)
     {
-        logger.log("Page::writePage WARNING: Internal rowCount (" + to_string(this->rowCount) + ") differs from actual rows vector size (" + to_string(actualRowCount) + ") before writing. Adjusting rowCount.");
-        this->rowCount = actualRowCount;
-        // TODO: Consider if TableCatalogue needs updating here if row counts change.
-        // This depends on how table metadata is managed.
+        return;
     }
-
-    // Write exactly actualRowCount rows
-    for (size_t rowCounter = 0; rowCounter < actualRowCount; rowCounter++)
+    if (segment->writePage(this->pageIndex, &header, sizeof(PageHeader), payload, payloadBytes, error))
     {
-        // Check if the row itself has the expected number of columns
-        if ((int)this->rows[rowCounter].size() != this->columnCount)
-        {
-            logger.log("Page::writePage WARNING: Row " + to_string(rowCounter) + " has incorrect column count (" + to_string(this->rows[rowCounter].size()) + ") vs expected (" + to_string(this->columnCount) + "). Writing available columns.");
-            cerr << "Page::writePage WARNING: Row " << rowCounter << " has incorrect column count (" << this->rows[rowCounter].size() << ") vs expected (" << this->columnCount << "). Writing available columns." << endl;
-            // Decide how to handle: skip row, pad, or write available columns?
-            // Writing available columns:
-            int colsToWrite = this->rows[rowCounter].size();
-            for (int columnCounter = 0; columnCounter < colsToWrite; columnCounter++)
-            {
-                if (columnCounter != 0)
-                    fout << " ";
-                fout << this->rows[rowCounter][columnCounter];
-            }
-            // Optionally pad with default values (e.g., 0) up to columnCount if strict format needed
-            // for (int k = colsToWrite; k < this->columnCount; ++k) {
-            //     fout << " 0"; // Example padding
-            // }
-        }
-        else
-        {
-            // Normal case: write exactly columnCount elements
-            for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
-            {
-                if (columnCounter != 0)
-                    fout << " ";
-                fout << this->rows[rowCounter][columnCounter];
-            }
-        }
-        fout << endl;
+        bufferManager.recordPageWrite(rawBytes, payloadBytes);
     }
-    fout.close();
-    // Check fstream state after closing
-    if (!fout.good())
+    else
     {
-        logger.log("Page::writePage ERROR: Error occurred during writing or closing file " + this->pageName);
-        cerr << "Page::writePage ERROR: Error occurred during writing or closing file " << this->pageName << endl;
+        logger.log("Page::writePage ERROR: " + error);
+        cerr << "Page::writePage ERROR: " << error << endl;
     }
 }
@@ -3,11 +3,73 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <memory>
 #include "logger.h" // Include Logger for logging capabilities
+#include "segmentFile.h"
 
 // DO NOT USE "using namespace std;" in header files
 // Use std:: prefix instead.
 
+/**
+ * @brief Fixed-size header at the start of every page. In a plain page
+ * (PAGE_FORMAT_VERSION) it is followed directly by rowCount * columnCount
+ * native int32 values in row-major order, so a page is read or written with
+ * a single system call and no parsing. In a compressed page
+ * (PAGE_FORMAT_COMPRESSED) it is followed by one encoded chunk per column
+ * (see pageCodec.h).
+ */
+struct PageHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t columnCount;
+    uint32_t rowCount;
+};
+
+const uint32_t PAGE_MAGIC = 0x47504152;   // "RAPG" as stored on disk (little-endian)
+const uint32_t PAGE_FORMAT_VERSION = 1;    // plain rows
+const uint32_t PAGE_FORMAT_COMPRESSED = 2; // per-column encoded chunks
+
+struct PageMapping;
+
+/**
+ * @brief How the values of a page are ordered in memory and in its plain
+ * on-disk form. ROW_LAYOUT stores row after row. PAX_LAYOUT stores the page
+ * column after column (column c starts at c * rowCount), so a scan that only
+ * reads a few columns of a wide table only touches those columns' bytes.
+ * Chosen per table at LOAD and the same for every page of the table.
+ */
+enum PageLayout
+{
+    ROW_LAYOUT,
+    PAX_LAYOUT
+};
+
+/**
+ * @brief Read-only, non-owning view of a single row stored inside a Page. It
+ * is just a pointer into the page buffer plus the column count, so taking a
+ * view never allocates. A view is only valid while the page it came from is
+ * alive and has not been modified.
+ */
+class RowView
+{
+    const int *rowData;
+    int columnCount;
+
+public:
+    RowView() : rowData(nullptr), columnCount(0) {}
+    RowView(const int *rowData, int columnCount) : rowData(rowData), columnCount(columnCount) {}
+
+    int operator[](int columnIndex) const { return rowData[columnIndex]; }
+    int size() const { return columnCount; }
+    bool empty() const { return rowData == nullptr || columnCount == 0; }
+    const int *data() const { return rowData; }
+    const int *begin() const { return rowData; }
+    const int *end() const { return rowData + columnCount; }
+    std::vector<int> toVector() const { return std::vector<int>(begin(), end()); }
+};
+
 /**
  * @brief The Page object is the main memory representation of a physical page
  * (equivalent to a block). The page class and the page.h header file are at the
@@ -26,21 +88,50 @@ class Page
     std::string pageName;
     int columnCount;
     long long int rowCount; // Changed to long long int for potentially large tables
-    std::vector<std::vector<int>> rows;
+    // All rows back to back in row-major order; row i starts at i * columnCount
+    std::vector<int> data;
+    // Set when the rows are read in place from the memory-mapped page slot
+    // instead of data. Copies of the page share the read-only mapping.
+    std::shared_ptr<const PageMapping> mapping;
+    PageLayout layout = ROW_LAYOUT;
+    // The page in the other layout, built on the first row access to a PAX
+    // page or column access to a row page; dropped whenever the page changes
+    mutable std::vector<int> transposed;
+
+    void invalidate();
+    const int *rowData() const;
+    const int *transposedData() const;
+    size_t valueIndex(long long int rowIndex, int columnIndex) const;
+    void makeWritable();
 
 public:
     int pageIndex; // Changed type to int and made public
 
     Page();
-    Page(const std::string &tableName, int pageIndex);                                                   // Use const& for string
-    Page(const std::string &tableName, int pageIndex, std::vector<std::vector<int>> rows, int rowCount); // Use const& for string
-    std::vector<int> getRow(int rowIndex);
+    Page(const std::string &tableName, int pageIndex, bool mapFile = false);                             // Use const& for string
+    Page(const std::string &tableName, int pageIndex, std::vector<std::vector<int>> rows, int rowCount, PageLayout layout = ROW_LAYOUT); // Use const& for string
+    Page(const std::string &tableName, int pageIndex, int columnCount, PageLayout layout, std::vector<int> &&data, long long int rowCount);
+    static std::string getPageName(const std::string &tableName, int pageIndex) { return "../data/temp/" + tableName + "_Page" + std::to_string(pageIndex); }
+    static bool readPageData(const PageLocation &location, const std::string &pageName, int columnCount, PageLayout layout, std::vector<int> &data, long long int &rowCount, std::string &error);
+    static bool mapPageData(const PageLocation &location, const std::string &pageName, int columnCount, PageLayout layout, std::shared_ptr<const PageMapping> &mapping, std::vector<int> &data, long long int &rowCount, std::string &error);
+    static void adviseWillNeed(const PageLocation &location);
+    bool isMapped() const { return this->mapping != nullptr; }
+    std::vector<int> getRow(int rowIndex) const;
+    RowView getRowView(int rowIndex) const;
+    const int *getColumn(int columnIndex) const;
+    int getCell(int rowIndex, int columnIndex) const;
+    void setCell(int rowIndex, int columnIndex, int value);
+    void setRow(int rowIndex, const RowView &row);
+    void moveRow(int fromRowIndex, int toRowIndex);
+    void appendRow(const std::vector<int> &row);
+    void truncate(long long int newRowCount);
     void writePage();
 
     // Added getter methods for private members if needed elsewhere
     std::string getTableName() const { return tableName; }
     std::string getPageName() const { return pageName; }
     int getColumnCount() const { return columnCount; }
+    PageLayout getLayout() const { return layout; }
     long long int getRowCount() const { return rowCount; } // Updated return type
 };
 
@@ -0,0 +1,341 @@
+#include "pageCodec.h"
+#include <cstring>   // For memcpy()
+#include <algorithm> // For min(), max()
+
+using namespace std;
+
+/**
+ * @brief Number of bits needed to hold value (0 for 0).
+ */
+static int bitsNeeded(uint32_t value)
+{
+    int bitWidth = 0;
+    while (value != 0)
+    {
+        bitWidth++;
+        value >>= 1;
+    }
+    return bitWidth;
+}
+
+/**
+ * @brief Bytes taken by count values of bitWidth bits, in whole 64-bit words.
+ */
+static size_t packedBytes(size_t count, int bitWidth)
+{
+    return (count * bitWidth + 63) / 64 * sizeof(uint64_t);
+}
+
+static size_t paddedBytes(size_t bytes)
+{
+    return (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+}
+
+/**
+ * @brief Packs count values of bitWidth bits each, lowest bits first, into
+ * zeroed words. valueAt(i) returns the i-th value.
+ */
+template <typename ValueAt>
+static void packBits(size_t count, int bitWidth, uint64_t *words, ValueAt valueAt)
+{
+    if (bitWidth == 0)
+    {
+        return;
+    }
+    for (size_t valueIndex = 0; valueIndex < count; valueIndex++)
+    {
+        uint64_t value = valueAt(valueIndex);
+        size_t bitPosition = valueIndex * bitWidth;
+        size_t wordIndex = bitPosition / 64;
+        int shift = bitPosition % 64;
+        words[wordIndex] |= value << shift;
+        if (shift + bitWidth > 64)
+        {
+            words[wordIndex + 1] |= value >> (64 - shift);
+        }
+    }
+}
+
+/**
+ * @brief Reads the i-th word of a payload that may not be 8-byte aligned.
+ */
+static inline uint64_t loadWord(const uint8_t *payload, size_t wordIndex)
+{
+    uint64_t word;
+    memcpy(&word, payload + wordIndex * sizeof(uint64_t), sizeof(uint64_t));
+    return word;
+}
+
+/**
+ * @brief Unpacks the i-th value of bitWidth bits (1 to 32).
+ */
+static inline uint32_t unpackValue(const uint8_t *payload, size_t valueIndex, int bitWidth)
+{
+    size_t bitPosition = valueIndex * bitWidth;
+    size_t wordIndex = bitPosition / 64;
+    int shift = bitPosition % 64;
+    uint64_t value = loadWord(payload, wordIndex) >> shift;
+    if (shift + bitWidth > 64)
+    {
+        value |= loadWord(payload, wordIndex + 1) << (64 - shift);
+    }
+    return (uint32_t)(value & ((1ULL << bitWidth) - 1));
+}
+
+/**
+ * @brief Compresses a page column by column. Each column becomes a
+ * ColumnChunkHeader followed by its payload, in whichever encoding is
+ * smallest for that column; on a tie the cheaper one to decode wins (RAW,
+ * then FOR, DELTA, RLE).
+ *
+ * @param rows rowCount * columnCount values
+ * @param rowCount
+ * @param columnCount
+ * @param columnMajor rows holds whole columns one after another
+ * @param encoded receives the compressed page, in 64-bit words
+ * @param encodedBytes receives the compressed size in bytes
+ * @return true if the compressed page is smaller than the plain rows
+ */
+bool encodePage(const int *rows, long long int rowCount, int columnCount, bool columnMajor, vector<uint64_t> &encoded, size_t &encodedBytes)
+{
+    size_t rawBytes = (size_t)rowCount * columnCount * sizeof(int);
+    encoded.clear();
+    encodedBytes = 0;
+    if (rowCount <= 0 || columnCount <= 0 || rowCount > UINT32_MAX)
+    {
+        return false;
+    }
+    size_t count = rowCount;
+    size_t rowStride = columnMajor ? 1 : columnCount;
+    size_t columnStride = columnMajor ? count : 1;
+    for (int columnIndex = 0; columnIndex < columnCount; columnIndex++)
+    {
+        const int *column = rows + columnIndex * columnStride;
+        auto valueAt = [column, rowStride](size_t rowIndex) { return column[rowIndex * rowStride]; };
+
+        int minimum = valueAt(0), maximum = valueAt(0);
+        bool sorted = true;
+        uint32_t maximumDelta = 0;
+        size_t runCount = 1;
+        for (size_t rowIndex = 1; rowIndex < count; rowIndex++)
+        {
+            int value = valueAt(rowIndex), previous = valueAt(rowIndex - 1);
+            minimum = min(minimum, value);
+            maximum = max(maximum, value);
+            if (value < previous)
+            {
+                sorted = false;
+            }
+            else
+            {
+                maximumDelta = max(maximumDelta, (uint32_t)value - (uint32_t)previous);
+            }
+            if (value != previous)
+            {
+                runCount++;
+            }
+        }
+
+        ColumnChunkHeader chunk;
+        chunk.encoding = ENCODING_RAW;
+        chunk.bitWidth = 32;
+        chunk.reserved = 0;
+        chunk.base = 0;
+        chunk.valueCount = count;
+        chunk.payloadBytes = paddedBytes(count * sizeof(int));
+
+        int forWidth = bitsNeeded((uint32_t)maximum - (uint32_t)minimum);
+        if (packedBytes(count, forWidth) < chunk.payloadBytes)
+        {
+            chunk.encoding = ENCODING_FOR;
+            chunk.bitWidth = forWidth;
+            chunk.base = minimum;
+            chunk.payloadBytes = packedBytes(count, forWidth);
+        }
+        int deltaWidth = bitsNeeded(maximumDelta);
+        if (sorted && packedBytes(count - 1, deltaWidth) < chunk.payloadBytes)
+        {
+            chunk.encoding = ENCODING_DELTA;
+            chunk.bitWidth = deltaWidth;
+            chunk.base = valueAt(0);
+            chunk.payloadBytes = packedBytes(count - 1, deltaWidth);
+        }
+        if (runCount * 2 * sizeof(int) < chunk.payloadBytes)
+        {
+            chunk.encoding = ENCODING_RLE;
+            chunk.bitWidth = 32;
+            chunk.base = 0;
+            chunk.valueCount = runCount;
+            chunk.payloadBytes = runCount * 2 * sizeof(int);
+        }
+
+        size_t chunkWord = encoded.size();
+        encoded.resize(chunkWord + (sizeof(ColumnChunkHeader) + chunk.payloadBytes) / sizeof(uint64_t), 0);
+        memcpy(&encoded[chunkWord], &chunk, sizeof(ColumnChunkHeader));
+        uint64_t *words = &encoded[chunkWord + sizeof(ColumnChunkHeader) / sizeof(uint64_t)];
+        switch (chunk.encoding)
+        {
+        case ENCODING_RAW:
+        {
+            uint8_t *payload = reinterpret_cast<uint8_t *>(words);
+            for (size_t rowIndex = 0; rowIndex < count; rowIndex++)
+            {
+                memcpy(payload + rowIndex * sizeof(int), &column[rowIndex * rowStride], sizeof(int));
+            }
+            break;
+        }
+        case ENCODING_FOR:
+            packBits(count, chunk.bitWidth, words, [&](size_t rowIndex) { return (uint32_t)valueAt(rowIndex) - (uint32_t)minimum; });
+            break;
+        case ENCODING_DELTA:
+            packBits(count - 1, chunk.bitWidth, words, [&](size_t deltaIndex) { return (uint32_t)valueAt(deltaIndex + 1) - (uint32_t)valueAt(deltaIndex); });
+            break;
+        case ENCODING_RLE:
+        {
+            uint8_t *payload = reinterpret_cast<uint8_t *>(words);
+            size_t runStart = 0, runIndex = 0;
+            for (size_t rowIndex = 1; rowIndex <= count; rowIndex++)
+            {
+                if (rowIndex < count && valueAt(rowIndex) == valueAt(runStart))
+                {
+                    continue;
+                }
+                int run[2] = {valueAt(runStart), (int)(rowIndex - runStart)};
+                memcpy(payload + runIndex * sizeof(run), run, sizeof(run));
+                runIndex++;
+                runStart = rowIndex;
+            }
+            break;
+        }
+        }
+    }
+    encodedBytes = encoded.size() * sizeof(uint64_t);
+    return encodedBytes < rawBytes;
+}
+
+/**
+ * @brief Decompresses a page written by encodePage. Every column is decoded
+ * straight into its slots of the output, so the result can be handed out as
+ * row or column batches as is. Sizes are checked against encodedBytes,
+ * so a damaged page is reported instead of read past its end.
+ *
+ * @param encoded compressed page, as stored after the PageHeader
+ * @param encodedBytes
+ * @param rowCount
+ * @param columnCount
+ * @param columnMajor lay the output out column by column instead of row by row
+ * @param rows receives rowCount * columnCount values
+ * @param error receives the reason on failure
+ * @return true on success
+ */
+bool decodePage(const void *encoded, size_t encodedBytes, long long int rowCount, int columnCount, bool columnMajor, int *rows, string &error)
+{
+    const uint8_t *position = static_cast<const uint8_t *>(encoded);
+    const uint8_t *end = position + encodedBytes;
+    size_t count = rowCount;
+    size_t rowStride = columnMajor ? 1 : columnCount;
+    size_t columnStride = columnMajor ? count : 1;
+    for (int columnIndex = 0; columnIndex < columnCount; columnIndex++)
+    {
+        ColumnChunkHeader chunk;
+        if ((size_t)(end - position) < sizeof(ColumnChunkHeader))
+        {
+            error = "compressed page ends before column " + to_string(columnIndex);
+            return false;
+        }
+        memcpy(&chunk, position, sizeof(ColumnChunkHeader));
+        const uint8_t *payload = position + sizeof(ColumnChunkHeader);
+        if ((size_t)(end - payload) < chunk.payloadBytes || chunk.bitWidth > 32 ||
+            (chunk.encoding != ENCODING_RLE && chunk.valueCount != count))
+        {
+            error = "column " + to_string(columnIndex) + " of the compressed page is damaged";
+            return false;
+        }
+        int *output = rows + columnIndex * columnStride;
+        switch (chunk.encoding)
+        {
+        case ENCODING_RAW:
+            if (chunk.payloadBytes < count * sizeof(int))
+            {
+                error = "column " + to_string(columnIndex) + " of the compressed page is damaged";
+                return false;
+            }
+            for (size_t rowIndex = 0; rowIndex < count; rowIndex++)
+            {
+                memcpy(output + rowIndex * rowStride, payload + rowIndex * sizeof(int), sizeof(int));
+            }
+            break;
+        case ENCODING_FOR:
+            if (chunk.payloadBytes < packedBytes(count, chunk.bitWidth))
+            {
+                error = "column " + to_string(columnIndex) + " of the compressed page is damaged";
+                return false;
+            }
+            if (chunk.bitWidth == 0)
+            {
+                for (size_t rowIndex = 0; rowIndex < count; rowIndex++)
+                {
+                    output[rowIndex * rowStride] = chunk.base;
+                }
+                break;
+            }
+            for (size_t rowIndex = 0; rowIndex < count; rowIndex++)
+            {
+                output[rowIndex * rowStride] = (int)((uint32_t)chunk.base + unpackValue(payload, rowIndex, chunk.bitWidth));
+            }
+            break;
+        case ENCODING_DELTA:
+        {
+            if (count == 0 || chunk.payloadBytes < packedBytes(count - 1, chunk.bitWidth))
+            {
+                error = "column " + to_string(columnIndex) + " of the compressed page is damaged";
+                return false;
+            }
+            uint32_t value = chunk.base;
+            output[0] = (int)value;
+            for (size_t rowIndex = 1; rowIndex < count; rowIndex++)
+            {
+                if (chunk.bitWidth != 0)
+                {
+                    value += unpackValue(payload, rowIndex - 1, chunk.bitWidth);
+                }
+                output[rowIndex * rowStride] = (int)value;
+            }
+            break;
+        }
+        case ENCODING_RLE:
+        {
+            if (chunk.payloadBytes < (size_t)chunk.valueCount * 2 * sizeof(int))
+            {
+                error = "column " + to_string(columnIndex) + " of the compressed page is damaged";
+                return false;
+            }
+            size_t rowIndex = 0;
+            for (size_t runIndex = 0; runIndex < chunk.valueCount; runIndex++)
+            {
+                int run[2];
+                memcpy(run, payload + runIndex * sizeof(run), sizeof(run));
+                if ((uint32_t)run[1] > count - rowIndex)
+                {
+                    break;
+                }
+                for (uint32_t repeat = 0; repeat < (uint32_t)run[1]; repeat++, rowIndex++)
+                {
+                    output[rowIndex * rowStride] = run[0];
+                }
+            }
+            if (rowIndex != count)
+            {
+                error = "runs of column " + to_string(columnIndex) + " of the compressed page do not add up to its rows";
+                return false;
+            }
+            break;
+        }
+        default:
+            error = "column " + to_string(columnIndex) + " has unknown encoding " + to_string(chunk.encoding);
+            return false;
+        }
+        position = payload + chunk.payloadBytes;
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef PAGECODEC_H
+#define PAGECODEC_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// DO NOT USE "using namespace std;" in header files
+
+/**
+ * @brief How one column of a compressed page is stored.
+ *
+ * RAW   plain int32 values.
+ * FOR   frame of reference: value - base, bit-packed in bitWidth bits.
+ * DELTA for non-decreasing columns: base is the first value, the differences
+ *       between neighbours are bit-packed in bitWidth bits.
+ * RLE   runs of equal values as (value, run length) pairs of int32/uint32.
+ */
+enum ColumnEncoding : uint8_t
+{
+    ENCODING_RAW = 0,
+    ENCODING_FOR = 1,
+    ENCODING_DELTA = 2,
+    ENCODING_RLE = 3
+};
+
+/**
+ * @brief Precedes every column of a compressed page. Columns are stored one
+ * after another, each payload padded to 8 bytes so the bit-packed words of
+ * the next column stay aligned.
+ */
+struct ColumnChunkHeader
+{
+    uint8_t encoding;
+    uint8_t bitWidth;
+    uint16_t reserved;
+    int32_t base;
+    uint32_t valueCount; // values for RAW/FOR/DELTA, runs for RLE
+    uint32_t payloadBytes;
+};
+
+// Per-column compression of integer pages. encodePage keeps, for every
+// column, whichever encoding is smallest; decodePage writes each column
+// straight into its place in the page buffer, row-major (what RowBatch views)
+// or column-major (PAX pages, what ColumnBatch views).
+bool encodePage(const int *rows, long long int rowCount, int columnCount, bool columnMajor, std::vector<uint64_t> &encoded, size_t &encodedBytes);
+bool decodePage(const void *encoded, size_t encodedBytes, long long int rowCount, int columnCount, bool columnMajor, int *rows, std::string &error);
+
+#endif // PAGECODEC_H
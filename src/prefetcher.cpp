@@ -0,0 +1,228 @@
+#include "prefetcher.h"
+#include "page.h"
+#include <algorithm>
+
+using namespace std;
+
+Prefetcher::Prefetcher()
+{
+    this->maxPages = DEFAULT_PREFETCH_DEPTH * 2;
+}
+
+Prefetcher::~Prefetcher()
+{
+    {
+        lock_guard<std::mutex> lock(this->queueMutex);
+        this->stopping = true;
+    }
+    this->workAvailable.notify_all();
+    if (this->worker.joinable())
+    {
+        this->worker.join();
+    }
+}
+
+/**
+ * @brief Body of the I/O thread: reads queued pages one at a time, with the
+ * lock released while the file is read.
+ *
+ */
+void Prefetcher::run()
+{
+    unique_lock<std::mutex> lock(this->queueMutex);
+    while (true)
+    {
+        this->workAvailable.wait(lock, [this]() { return this->stopping || !this->queue.empty(); });
+        if (this->stopping)
+        {
+            return;
+        }
+        Request request = std::move(this->queue.front());
+        this->queue.pop_front();
+        this->reading = true;
+        this->readingKey = request.key;
+        lock.unlock();
+
+        StagedPage page;
+        string error;
+        page.columnCount = request.columnCount;
+        page.layout = request.layout;
+        page.valid = Page::readPageData(request.location, request.pageName, request.columnCount, request.layout, page.data, page.rowCount, error);
+        page.ready = true;
+
+        lock.lock();
+        this->reading = false;
+        // cancel() and take() wait for a page that is being read, so its
+        // entry is still there
+        auto it = this->staged.find(request.key);
+        if (it != this->staged.end())
+        {
+            it->second = std::move(page);
+            this->readyOrder.push_back(request.key);
+        }
+        this->readFinished.notify_all();
+    }
+}
+
+void Prefetcher::waitForRead(unique_lock<std::mutex> &lock, uint64_t key)
+{
+    this->readFinished.wait(lock, [this, key]() { return !this->reading || this->readingKey != key; });
+}
+
+/**
+ * @brief Forgets a page wherever it is: queued or ready. Must be called with
+ * the lock held and never for the page being read.
+ *
+ * @param key
+ */
+void Prefetcher::erase(uint64_t key)
+{
+    if (this->staged.erase(key) == 0)
+    {
+        return;
+    }
+    auto queued = find_if(this->queue.begin(), this->queue.end(), [key](const Request &request) { return request.key == key; });
+    if (queued != this->queue.end())
+    {
+        this->queue.erase(queued);
+    }
+    auto ready = find(this->readyOrder.begin(), this->readyOrder.end(), key);
+    if (ready != this->readyOrder.end())
+    {
+        this->readyOrder.erase(ready);
+    }
+}
+
+/**
+ * @brief Limits how many pages may be queued or staged at once. Zero turns
+ * read-ahead off.
+ *
+ * @param pageCount
+ */
+void Prefetcher::setMaxPages(size_t pageCount)
+{
+    lock_guard<std::mutex> lock(this->queueMutex);
+    this->maxPages = pageCount;
+    while (this->staged.size() > this->maxPages && !this->readyOrder.empty())
+    {
+        this->erase(this->readyOrder.front());
+        this->droppedCount++;
+    }
+}
+
+/**
+ * @brief Queues a page to be read in the background. When the staging area is
+ * full the oldest page that was read but never taken is dropped to make room.
+ *
+ * @param key frame table key of the page
+ * @param pageName used in error messages
+ * @param segment segment file of the page's table
+ * @param pageIndex
+ * @param columnCount
+ * @param layout
+ * @return true if the page was queued
+ * @return false if it is already queued or staged, or there is no room
+ */
+bool Prefetcher::schedule(uint64_t key, const string &pageName, const shared_ptr<SegmentFile> &segment, int pageIndex, int columnCount, PageLayout layout)
+{
+    lock_guard<std::mutex> lock(this->queueMutex);
+    if (this->maxPages == 0 || this->staged.count(key))
+    {
+        return false;
+    }
+    if (this->staged.size() >= this->maxPages)
+    {
+        if (this->readyOrder.empty())
+        {
+            return false;
+        }
+        this->erase(this->readyOrder.front());
+        this->droppedCount++;
+    }
+    if (!this->worker.joinable())
+    {
+        this->worker = thread(&Prefetcher::run, this);
+    }
+    this->staged[key].columnCount = columnCount;
+    this->staged[key].layout = layout;
+    // The slot is located here, on the query thread, which owns the page
+    // directory
+    this->queue.push_back({key, pageName, segment, segment->locate(pageIndex), columnCount, layout});
+    this->workAvailable.notify_one();
+    return true;
+}
+
+/**
+ * @brief Hands a staged page over to the caller. A page that is being read is
+ * waited for; a page that is still queued is dropped, since reading it on the
+ * caller's thread is no slower than waiting behind the pages before it.
+ *
+ * @param key
+ * @param columnCount receives the row width
+ * @param layout receives the order of the values in data
+ * @param data receives the rows
+ * @param rowCount receives the row count
+ * @return true if the page was read ahead and is now owned by the caller
+ */
+bool Prefetcher::take(uint64_t key, int &columnCount, PageLayout &layout, vector<int> &data, long long int &rowCount)
+{
+    unique_lock<std::mutex> lock(this->queueMutex);
+    this->waitForRead(lock, key);
+    auto it = this->staged.find(key);
+    if (it == this->staged.end())
+    {
+        return false;
+    }
+    bool taken = it->second.ready && it->second.valid;
+    if (taken)
+    {
+        columnCount = it->second.columnCount;
+        layout = it->second.layout;
+        data = std::move(it->second.data);
+        rowCount = it->second.rowCount;
+        this->usedCount++;
+    }
+    this->erase(key);
+    return taken;
+}
+
+/**
+ * @brief Drops a page whose slot is about to change or disappear, waiting
+ * for it first if it is being read.
+ *
+ * @param key
+ */
+void Prefetcher::cancel(uint64_t key)
+{
+    unique_lock<std::mutex> lock(this->queueMutex);
+    this->waitForRead(lock, key);
+    if (this->staged.count(key))
+    {
+        this->erase(key);
+        this->droppedCount++;
+    }
+}
+
+/**
+ * @brief Drops every page of a table, see cancel().
+ *
+ * @param tableId
+ */
+void Prefetcher::cancelTable(uint32_t tableId)
+{
+    unique_lock<std::mutex> lock(this->queueMutex);
+    this->readFinished.wait(lock, [this, tableId]() { return !this->reading || (this->readingKey >> 32) != tableId; });
+    vector<uint64_t> keys;
+    for (const auto &entry : this->staged)
+    {
+        if ((entry.first >> 32) == tableId)
+        {
+            keys.push_back(entry.first);
+        }
+    }
+    for (uint64_t key : keys)
+    {
+        this->erase(key);
+        this->droppedCount++;
+    }
+}
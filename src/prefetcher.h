@@ -0,0 +1,82 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include "segmentFile.h"
+#include "page.h"
+
+// DO NOT USE "using namespace std;" in header files
+
+const size_t DEFAULT_PREFETCH_DEPTH = 4; // Pages read ahead of a sequential scan
+
+/**
+ * @brief Reads pages on a background I/O thread. The BufferManager schedules
+ * the pages that follow a sequential scan; the thread reads each page from
+ * its segment into a staging buffer with Page::readPageData, and when the scan reaches
+ * the page the BufferManager takes the buffer and installs it in a frame
+ * without touching the disk. Only the queue and staging buffers are shared
+ * with the thread; frames, the catalogue and the logger are only ever used
+ * by the query thread. At most maxPages pages are queued or staged at once.
+ */
+class Prefetcher
+{
+    struct Request
+    {
+        uint64_t key;
+        std::string pageName;
+        std::shared_ptr<SegmentFile> segment; // keeps the descriptor open
+        PageLocation location;
+        int columnCount;
+        PageLayout layout;
+    };
+    struct StagedPage
+    {
+        bool ready = false;
+        bool valid = false;
+        int columnCount = 0;
+        PageLayout layout = ROW_LAYOUT;
+        std::vector<int> data;
+        long long int rowCount = 0;
+    };
+
+    std::mutex queueMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable readFinished;
+    std::deque<Request> queue;
+    std::unordered_map<uint64_t, StagedPage> staged; // queued, being read or ready
+    std::deque<uint64_t> readyOrder;                 // ready keys, oldest first
+    bool reading = false;
+    uint64_t readingKey = 0;
+    bool stopping = false;
+    std::thread worker;
+    size_t maxPages;
+
+    void run();
+    void waitForRead(std::unique_lock<std::mutex> &lock, uint64_t key);
+    void erase(uint64_t key);
+
+public:
+    long long usedCount = 0;
+    long long droppedCount = 0;
+
+    Prefetcher();
+    ~Prefetcher();
+
+    void setMaxPages(size_t pageCount);
+    bool schedule(uint64_t key, const std::string &pageName, const std::shared_ptr<SegmentFile> &segment, int pageIndex, int columnCount, PageLayout layout);
+    size_t getMaxPages() const { return this->maxPages; }
+    bool take(uint64_t key, int &columnCount, PageLayout &layout, std::vector<int> &data, long long int &rowCount);
+    void cancel(uint64_t key);
+    void cancelTable(uint32_t tableId);
+};
+
+#endif // PREFETCHER_H
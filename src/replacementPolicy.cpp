@@ -0,0 +1,297 @@
+#include "replacementPolicy.h"
+#include <algorithm>
+
+using namespace std;
+
+void LRUPolicy::ensureFrame(int frameIndex)
+{
+    if ((size_t)frameIndex >= this->tracked.size())
+    {
+        this->tracked.resize(frameIndex + 1, false);
+        this->positions.resize(frameIndex + 1);
+    }
+}
+
+void LRUPolicy::recordInsert(int frameIndex, uint64_t /*pageKey*/)
+{
+    this->ensureFrame(frameIndex);
+    if (this->tracked[frameIndex])
+    {
+        this->recency.erase(this->positions[frameIndex]);
+    }
+    this->positions[frameIndex] = this->recency.insert(this->recency.end(), frameIndex);
+    this->tracked[frameIndex] = true;
+}
+
+void LRUPolicy::recordAccess(int frameIndex)
+{
+    this->ensureFrame(frameIndex);
+    if (this->tracked[frameIndex])
+    {
+        this->recency.splice(this->recency.end(), this->recency, this->positions[frameIndex]);
+    }
+}
+
+void LRUPolicy::recordRemove(int frameIndex, uint64_t /*pageKey*/, bool /*evicted*/)
+{
+    this->ensureFrame(frameIndex);
+    if (this->tracked[frameIndex])
+    {
+        this->recency.erase(this->positions[frameIndex]);
+        this->tracked[frameIndex] = false;
+    }
+}
+
+/**
+ * @brief Walks from the least recently used end and returns the first frame
+ * that may be evicted.
+ *
+ * @param isEvictable
+ * @return int frame index or -1
+ */
+int LRUPolicy::chooseVictim(const function<bool(int)> &isEvictable)
+{
+    for (int frameIndex : this->recency)
+    {
+        if (isEvictable(frameIndex))
+        {
+            return frameIndex;
+        }
+    }
+    return -1;
+}
+
+void ClockPolicy::ensureFrame(int frameIndex)
+{
+    if ((size_t)frameIndex >= this->tracked.size())
+    {
+        this->tracked.resize(frameIndex + 1, false);
+        this->referenced.resize(frameIndex + 1, false);
+    }
+}
+
+void ClockPolicy::recordInsert(int frameIndex, uint64_t /*pageKey*/)
+{
+    this->ensureFrame(frameIndex);
+    this->tracked[frameIndex] = true;
+    this->referenced[frameIndex] = false;
+}
+
+void ClockPolicy::recordAccess(int frameIndex)
+{
+    this->ensureFrame(frameIndex);
+    if (this->tracked[frameIndex])
+    {
+        this->referenced[frameIndex] = true;
+    }
+}
+
+void ClockPolicy::recordRemove(int frameIndex, uint64_t /*pageKey*/, bool /*evicted*/)
+{
+    this->ensureFrame(frameIndex);
+    this->tracked[frameIndex] = false;
+    this->referenced[frameIndex] = false;
+}
+
+/**
+ * @brief Advances the hand, clearing reference bits, until it reaches an
+ * unreferenced evictable frame. Two full turns are enough: the first clears
+ * every bit it passes.
+ *
+ * @param isEvictable
+ * @return int frame index or -1
+ */
+int ClockPolicy::chooseVictim(const function<bool(int)> &isEvictable)
+{
+    size_t frameCount = this->tracked.size();
+    if (frameCount == 0)
+    {
+        return -1;
+    }
+    for (size_t step = 0; step < 2 * frameCount; step++)
+    {
+        size_t frameIndex = this->hand % frameCount;
+        this->hand = (frameIndex + 1) % frameCount;
+        if (!this->tracked[frameIndex] || !isEvictable(frameIndex))
+        {
+            continue;
+        }
+        if (this->referenced[frameIndex])
+        {
+            this->referenced[frameIndex] = false;
+            continue;
+        }
+        return frameIndex;
+    }
+    return -1;
+}
+
+void TwoQueuePolicy::ensureFrame(int frameIndex)
+{
+    if ((size_t)frameIndex >= this->queueOf.size())
+    {
+        this->queueOf.resize(frameIndex + 1, NONE);
+        this->positions.resize(frameIndex + 1);
+    }
+}
+
+/**
+ * @brief Number of frames A1in may hold before it is evicted from ahead of
+ * Am: a quarter of the pool, as suggested for 2Q.
+ *
+ * @return size_t
+ */
+size_t TwoQueuePolicy::a1inTarget() const
+{
+    return max((size_t)1, this->capacity / 4);
+}
+
+/**
+ * @brief Number of ghost keys kept in A1out: half the pool.
+ *
+ * @return size_t
+ */
+size_t TwoQueuePolicy::a1outLimit() const
+{
+    return max((size_t)1, this->capacity / 2);
+}
+
+int TwoQueuePolicy::firstEvictable(const list<int> &queue, const function<bool(int)> &isEvictable) const
+{
+    for (int frameIndex : queue)
+    {
+        if (isEvictable(frameIndex))
+        {
+            return frameIndex;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief A page whose key is still in A1out was re-referenced shortly after
+ * leaving the pool and goes straight to Am; any other page starts in A1in.
+ *
+ * @param frameIndex
+ * @param pageKey
+ */
+void TwoQueuePolicy::recordInsert(int frameIndex, uint64_t pageKey)
+{
+    this->ensureFrame(frameIndex);
+    if (this->queueOf[frameIndex] == A1IN)
+    {
+        this->a1in.erase(this->positions[frameIndex]);
+    }
+    else if (this->queueOf[frameIndex] == AM)
+    {
+        this->am.erase(this->positions[frameIndex]);
+    }
+    if (this->a1outKeys.erase(pageKey))
+    {
+        this->a1out.erase(find(this->a1out.begin(), this->a1out.end(), pageKey));
+        this->positions[frameIndex] = this->am.insert(this->am.end(), frameIndex);
+        this->queueOf[frameIndex] = AM;
+    }
+    else
+    {
+        this->positions[frameIndex] = this->a1in.insert(this->a1in.end(), frameIndex);
+        this->queueOf[frameIndex] = A1IN;
+    }
+}
+
+/**
+ * @brief Hits in Am refresh recency. Hits in A1in are deliberately ignored:
+ * repeated reads of a page during one scan are correlated and must not make
+ * it look hot.
+ *
+ * @param frameIndex
+ */
+void TwoQueuePolicy::recordAccess(int frameIndex)
+{
+    this->ensureFrame(frameIndex);
+    if (this->queueOf[frameIndex] == AM)
+    {
+        this->am.splice(this->am.end(), this->am, this->positions[frameIndex]);
+    }
+}
+
+/**
+ * @brief Unlinks the frame. Only pages evicted from A1in are remembered in
+ * A1out; deleted or discarded pages are not coming back.
+ *
+ * @param frameIndex
+ * @param pageKey
+ * @param evicted
+ */
+void TwoQueuePolicy::recordRemove(int frameIndex, uint64_t pageKey, bool evicted)
+{
+    this->ensureFrame(frameIndex);
+    Queue queue = this->queueOf[frameIndex];
+    if (queue == A1IN)
+    {
+        this->a1in.erase(this->positions[frameIndex]);
+    }
+    else if (queue == AM)
+    {
+        this->am.erase(this->positions[frameIndex]);
+    }
+    this->queueOf[frameIndex] = NONE;
+    if (queue == A1IN && evicted && this->a1outKeys.insert(pageKey).second)
+    {
+        this->a1out.push_back(pageKey);
+        while (this->a1out.size() > this->a1outLimit())
+        {
+            this->a1outKeys.erase(this->a1out.front());
+            this->a1out.pop_front();
+        }
+    }
+}
+
+/**
+ * @brief Evicts the oldest page of A1in while A1in is over its target share,
+ * otherwise the least recently used page of Am. Falls back to the other
+ * queue when every frame of the preferred one is pinned.
+ *
+ * @param isEvictable
+ * @return int frame index or -1
+ */
+int TwoQueuePolicy::chooseVictim(const function<bool(int)> &isEvictable)
+{
+    int victim = -1;
+    if (this->a1in.size() > this->a1inTarget() || this->am.empty())
+    {
+        victim = this->firstEvictable(this->a1in, isEvictable);
+        if (victim == -1)
+        {
+            victim = this->firstEvictable(this->am, isEvictable);
+        }
+    }
+    else
+    {
+        victim = this->firstEvictable(this->am, isEvictable);
+        if (victim == -1)
+        {
+            victim = this->firstEvictable(this->a1in, isEvictable);
+        }
+    }
+    return victim;
+}
+
+/**
+ * @brief Creates a policy from its name (LRU, CLOCK or 2Q, case insensitive).
+ *
+ * @param name
+ * @return ReplacementPolicy* owned by the caller, nullptr for an unknown name
+ */
+ReplacementPolicy *createReplacementPolicy(const string &name)
+{
+    string upperName = name;
+    transform(upperName.begin(), upperName.end(), upperName.begin(), ::toupper);
+    if (upperName == "LRU")
+        return new LRUPolicy();
+    if (upperName == "CLOCK")
+        return new ClockPolicy();
+    if (upperName == "2Q")
+        return new TwoQueuePolicy();
+    return nullptr;
+}
@@ -0,0 +1,125 @@
+#ifndef REPLACEMENTPOLICY_H
+#define REPLACEMENTPOLICY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+
+// DO NOT USE "using namespace std;" in header files
+
+const char *const DEFAULT_REPLACEMENT_POLICY = "2Q"; // Used when none is given at startup
+
+/**
+ * @brief Decides which buffer frame the BufferManager evicts. The buffer
+ * manager reports every page that enters a frame, every hit on a resident
+ * page and every page that leaves a frame; the policy only ever picks among
+ * frames for which the caller's predicate holds (resident and unpinned).
+ * Hit, miss and eviction counters are kept per policy instance.
+ */
+class ReplacementPolicy
+{
+public:
+    long long hits = 0;
+    long long misses = 0;
+    long long evictions = 0;
+
+    virtual ~ReplacementPolicy() {}
+    virtual std::string getName() const = 0;
+    virtual void setCapacity(size_t frameCount) { this->capacity = frameCount; }
+    // A page was loaded into frameIndex
+    virtual void recordInsert(int frameIndex, uint64_t pageKey) = 0;
+    // The resident page in frameIndex was requested again
+    virtual void recordAccess(int frameIndex) = 0;
+    // The page left frameIndex; evicted is false when it was deleted or discarded
+    virtual void recordRemove(int frameIndex, uint64_t pageKey, bool evicted) = 0;
+    // Returns a frame for which isEvictable holds, or -1
+    virtual int chooseVictim(const std::function<bool(int)> &isEvictable) = 0;
+
+protected:
+    size_t capacity = 0;
+};
+
+/**
+ * @brief Least recently used.
+ */
+class LRUPolicy : public ReplacementPolicy
+{
+    std::list<int> recency; // front = least recently used
+    std::vector<std::list<int>::iterator> positions;
+    std::vector<bool> tracked;
+
+    void ensureFrame(int frameIndex);
+
+public:
+    std::string getName() const { return "LRU"; }
+    void recordInsert(int frameIndex, uint64_t pageKey);
+    void recordAccess(int frameIndex);
+    void recordRemove(int frameIndex, uint64_t pageKey, bool evicted);
+    int chooseVictim(const std::function<bool(int)> &isEvictable);
+};
+
+/**
+ * @brief CLOCK (second chance): frames sit on a circle with a reference bit
+ * that a hit sets and the sweeping hand clears; the first unreferenced frame
+ * the hand reaches is evicted.
+ */
+class ClockPolicy : public ReplacementPolicy
+{
+    std::vector<bool> referenced;
+    std::vector<bool> tracked;
+    size_t hand = 0;
+
+    void ensureFrame(int frameIndex);
+
+public:
+    std::string getName() const { return "CLOCK"; }
+    void recordInsert(int frameIndex, uint64_t pageKey);
+    void recordAccess(int frameIndex);
+    void recordRemove(int frameIndex, uint64_t pageKey, bool evicted);
+    int chooseVictim(const std::function<bool(int)> &isEvictable);
+};
+
+/**
+ * @brief Scan resistant 2Q (Johnson & Shasha). New pages enter the FIFO
+ * queue A1in and are evicted from it first, so a page touched only by one
+ * sequential scan never displaces the hot set. Keys of pages evicted from
+ * A1in are remembered in the ghost queue A1out; a page that is requested
+ * again while its key is still there is promoted to the LRU queue Am.
+ */
+class TwoQueuePolicy : public ReplacementPolicy
+{
+    enum Queue
+    {
+        NONE,
+        A1IN,
+        AM
+    };
+    std::list<int> a1in; // FIFO, front = oldest
+    std::list<int> am;   // LRU, front = least recently used
+    std::vector<std::list<int>::iterator> positions;
+    std::vector<Queue> queueOf;
+    std::deque<uint64_t> a1out; // ghost keys, front = oldest
+    std::unordered_set<uint64_t> a1outKeys;
+
+    void ensureFrame(int frameIndex);
+    size_t a1inTarget() const;
+    size_t a1outLimit() const;
+    int firstEvictable(const std::list<int> &queue, const std::function<bool(int)> &isEvictable) const;
+
+public:
+    std::string getName() const { return "2Q"; }
+    void recordInsert(int frameIndex, uint64_t pageKey);
+    void recordAccess(int frameIndex);
+    void recordRemove(int frameIndex, uint64_t pageKey, bool evicted);
+    int chooseVictim(const std::function<bool(int)> &isEvictable);
+};
+
+ReplacementPolicy *createReplacementPolicy(const std::string &name);
+
+#endif // REPLACEMENTPOLICY_H
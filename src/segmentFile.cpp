@@ -0,0 +1,200 @@
+#include "segmentFile.h"
+#include <fcntl.h>    // For open(), fallocate()
+#include <unistd.h>   // For close(), unlink()
+#include <sys/uio.h>  // For pwritev()
+#include <sys/mman.h> // For mmap(), munmap()
+#include <cstring>    // For memcpy()
+#include <map>
+
+using namespace std;
+
+typedef multimap<pair<int, off_t>, SlotMapping *> SlotMappingRegistry;
+
+/**
+ * @brief Live slot mappings by (descriptor, slot offset). Never destroyed,
+ * as pages in the global buffer pool are unmapped at exit after this file's
+ * statics are gone.
+ */
+static SlotMappingRegistry &getLiveMappings()
+{
+    static SlotMappingRegistry *liveMappings = new SlotMappingRegistry();
+    return *liveMappings;
+}
+
+SlotMapping::SlotMapping(void *address, size_t length, int fileDescriptor, off_t offset)
+    : address(address), length(length), fileDescriptor(fileDescriptor), offset(offset)
+{
+    getLiveMappings().emplace(make_pair(fileDescriptor, offset), this);
+}
+
+SlotMapping::~SlotMapping()
+{
+    SlotMappingRegistry &liveMappings = getLiveMappings();
+    auto range = liveMappings.equal_range(make_pair(this->fileDescriptor, this->offset));
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == this)
+        {
+            liveMappings.erase(it);
+            break;
+        }
+    }
+    munmap(this->address, this->length);
+}
+
+/**
+ * @brief Replaces the file mapping by anonymous memory holding the same
+ * bytes, at the same address, so the mapping no longer follows the slot.
+ */
+void SlotMapping::detach()
+{
+    vector<char> bytes(static_cast<const char *>(this->address), static_cast<const char *>(this->address) + this->length);
+    void *copy = mmap(this->address, this->length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    if (copy == MAP_FAILED)
+    {
+        return;
+    }
+    memcpy(copy, bytes.data(), this->length);
+    mprotect(copy, this->length, PROT_READ);
+}
+
+/**
+ * @brief Detaches every live mapping of a slot before the slot changes.
+ *
+ * @param fileDescriptor
+ * @param offset
+ */
+void SlotMapping::detachSlot(int fileDescriptor, off_t offset)
+{
+    SlotMappingRegistry &liveMappings = getLiveMappings();
+    auto range = liveMappings.equal_range(make_pair(fileDescriptor, offset));
+    for (auto it = range.first; it != range.second; it = liveMappings.erase(it))
+    {
+        it->second->detach();
+        it->second->fileDescriptor = -1; // no longer tied to the slot
+    }
+}
+
+/**
+ * @brief Creates (or empties) the segment file and keeps it open.
+ *
+ * @param fileName
+ * @param slotBytes size of every page slot, a multiple of the OS page size
+ */
+SegmentFile::SegmentFile(const string &fileName, size_t slotBytes) : fileName(fileName), slotBytes(slotBytes)
+{
+    this->fileDescriptor = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+}
+
+SegmentFile::~SegmentFile()
+{
+    if (this->fileDescriptor >= 0)
+    {
+        close(this->fileDescriptor);
+    }
+}
+
+/**
+ * @brief Bytes used in a page's slot.
+ *
+ * @param pageIndex
+ * @return size_t 0 if the page was never written or was removed
+ */
+size_t SegmentFile::getPageBytes(int pageIndex) const
+{
+    if (pageIndex < 0 || pageIndex >= (int)this->pageBytes.size())
+    {
+        return 0;
+    }
+    return this->pageBytes[pageIndex];
+}
+
+/**
+ * @brief Location of a page for Page::readPageData/mapPageData.
+ *
+ * @param pageIndex
+ * @return PageLocation bytes is 0 if the page was never written
+ */
+PageLocation SegmentFile::locate(int pageIndex) const
+{
+    PageLocation location;
+    location.fileDescriptor = this->fileDescriptor;
+    location.offset = this->getPageOffset(pageIndex);
+    location.bytes = this->getPageBytes(pageIndex);
+    return location;
+}
+
+/**
+ * @brief Writes a page (header followed by payload) into its slot with one
+ * pwritev and records its size in the page directory.
+ *
+ * @param pageIndex
+ * @param header
+ * @param headerBytes
+ * @param payload
+ * @param payloadBytes
+ * @param error receives the reason on failure
+ * @return true on success
+ */
+bool SegmentFile::writePage(int pageIndex, const void *header, size_t headerBytes, const void *payload, size_t payloadBytes, string &error)
+{
+    if (!this->isOpen())
+    {
+        error = "Segment " + this->fileName + " is not open.";
+        return false;
+    }
+    if (pageIndex < 0 || headerBytes + payloadBytes > this->slotBytes)
+    {
+        error = "Page " + to_string(pageIndex) + " of " + to_string(headerBytes + payloadBytes) + " bytes does not fit a " + to_string(this->slotBytes) + " byte slot of " + this->fileName + ".";
+        return false;
+    }
+    SlotMapping::detachSlot(this->fileDescriptor, this->getPageOffset(pageIndex));
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<void *>(header);
+    iov[0].iov_len = headerBytes;
+    iov[1].iov_base = const_cast<void *>(payload);
+    iov[1].iov_len = payloadBytes;
+    if (pwritev(this->fileDescriptor, iov, 2, this->getPageOffset(pageIndex)) != (ssize_t)(headerBytes + payloadBytes))
+    {
+        error = "Error occurred during writing page " + to_string(pageIndex) + " of " + this->fileName;
+        return false;
+    }
+    if (pageIndex >= (int)this->pageBytes.size())
+    {
+        this->pageBytes.resize(pageIndex + 1, 0);
+    }
+    this->pageBytes[pageIndex] = headerBytes + payloadBytes;
+    return true;
+}
+
+/**
+ * @brief Marks a page's slot unused and, where the filesystem supports it,
+ * gives its disk blocks back.
+ *
+ * @param pageIndex
+ */
+void SegmentFile::removePage(int pageIndex)
+{
+    if (pageIndex < 0 || pageIndex >= (int)this->pageBytes.size() || this->pageBytes[pageIndex] == 0)
+    {
+        return;
+    }
+    SlotMapping::detachSlot(this->fileDescriptor, this->getPageOffset(pageIndex));
+#ifdef FALLOC_FL_PUNCH_HOLE
+    fallocate(this->fileDescriptor, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, this->getPageOffset(pageIndex), this->pageBytes[pageIndex]);
+#endif
+    this->pageBytes[pageIndex] = 0;
+}
+
+/**
+ * @brief Deletes the segment file, dropping every page at once. The open
+ * descriptor (and any mapping of the file) stays usable until the segment
+ * is destroyed.
+ *
+ * @return true if the file was removed
+ */
+bool SegmentFile::removeFile()
+{
+    this->pageBytes.clear();
+    return unlink(this->fileName.c_str()) == 0;
+}
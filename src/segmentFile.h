@@ -0,0 +1,91 @@
+#ifndef SEGMENTFILE_H
+#define SEGMENTFILE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <sys/types.h>
+
+// DO NOT USE "using namespace std;" in header files
+
+/**
+ * @brief Where a page sits on disk: the open segment descriptor, the slot
+ * offset and the number of bytes in use. Enough to read or map the page
+ * without looking anything up, e.g. from the prefetch thread.
+ */
+struct PageLocation
+{
+    int fileDescriptor = -1;
+    off_t offset = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * @brief A read-only MAP_PRIVATE mapping of (the start of) one page slot.
+ * Pages read mapped rows in place, so a slot must not change under a live
+ * mapping: before SegmentFile rewrites or removes a slot it detaches every
+ * mapping of it (detachSlot), which copies the mapped bytes into anonymous
+ * memory at the same address. Views into the mapping stay valid and keep
+ * showing the old contents. Mappings are only made and dropped on the query
+ * thread, like the pool that holds them.
+ */
+class SlotMapping
+{
+    void *address;
+    size_t length;
+    int fileDescriptor;
+    off_t offset;
+
+    void detach();
+
+public:
+    SlotMapping(void *address, size_t length, int fileDescriptor, off_t offset);
+    ~SlotMapping();
+    SlotMapping(const SlotMapping &) = delete;
+    SlotMapping &operator=(const SlotMapping &) = delete;
+
+    static void detachSlot(int fileDescriptor, off_t offset);
+};
+
+/**
+ * @brief All pages of one table live in a single segment file, each in a
+ * fixed-size slot: page i starts at byte i * slotBytes. Slots are a multiple
+ * of the OS page size, so a page can also be mapped straight from its offset.
+ * Pages are variable-size within their slot; the page directory records how
+ * many bytes of each slot are in use (0 for a slot that was never written or
+ * was removed). Unused slot space is never written, so the file stays sparse.
+ * Temporary files do not survive a restart, so the directory only lives in
+ * memory. Reads and writes use pread/pwrite on one descriptor that stays
+ * open for the life of the segment, so no file is opened per page. A slot
+ * is rewritten in place, after its live mappings are detached (see
+ * SlotMapping).
+ */
+class SegmentFile
+{
+    std::string fileName;
+    int fileDescriptor;
+    size_t slotBytes;
+    std::vector<uint32_t> pageBytes; // page directory: bytes used in each slot
+
+public:
+    SegmentFile(const std::string &fileName, size_t slotBytes);
+    ~SegmentFile();
+    SegmentFile(const SegmentFile &) = delete;
+    SegmentFile &operator=(const SegmentFile &) = delete;
+
+    bool isOpen() const { return this->fileDescriptor >= 0; }
+    int getFileDescriptor() const { return this->fileDescriptor; }
+    const std::string &getFileName() const { return this->fileName; }
+    size_t getSlotBytes() const { return this->slotBytes; }
+    off_t getPageOffset(int pageIndex) const { return (off_t)pageIndex * (off_t)this->slotBytes; }
+    size_t getPageBytes(int pageIndex) const;
+    int getPageCount() const { return this->pageBytes.size(); }
+    PageLocation locate(int pageIndex) const;
+
+    bool writePage(int pageIndex, const void *header, size_t headerBytes, const void *payload, size_t payloadBytes, std::string &error);
+    void removePage(int pageIndex);
+    bool removeFile();
+};
+
+#endif // SEGMENTFILE_H
@@ -29,6 +29,7 @@ bool semanticParseSEARCH();
 bool semanticParseINSERT();
 bool semanticParseUPDATE();
 bool semanticParseDELETE();
+bool semanticParseSETMEMORY();
 // Remove RENAME MATRIX related functions if they existed
 // bool semanticParseRENAMEMATRIX(); // Example if it existed
 
@@ -92,6 +93,8 @@ bool semanticParse()
         return semanticParseUPDATE();
     case DELETE:
         return semanticParseDELETE();
+    case SET_MEMORY:
+        return semanticParseSETMEMORY();
     default:
         cout << "SEMANTIC ERROR: Unrecognized query type." << endl; // More specific error
     }
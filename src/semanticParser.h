@@ -25,6 +25,7 @@ bool semanticParseSEARCH();
 bool semanticParseINSERT();
 bool semanticParseUPDATE();
 bool semanticParseDELETE();
+bool semanticParseSETMEMORY();
 
 bool semanticParseLOADMATRIX();
 bool semanticParsePRINTMATRIX();
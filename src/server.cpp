@@ -5,6 +5,7 @@
 #include "tableCatalogue.h"  // Include TableCatalogue definition
 #include "matrixCatalogue.h" // Include MatrixCatalogue definition
 #include "executor.h"        // Include declaration for executeCommand
+#include "indexBuilder.h"    // Include for finishIndexBuilds
 #include <iostream>          // Include for cin, cout, endl
 #include <string>            // Include for string
 #include <vector>            // Include for vector
@@ -25,6 +26,8 @@ ParsedQuery parsedQuery;
 void doCommand()
 {
     logger.log("doCommand");
+    // Indexes still being built on a table the query names are finished first
+    finishIndexBuilds(tokenizedQuery);
     if (syntacticParse() && semanticParse())
     {
         // printf("Parsed and Semantic\n"); // Debugging print
@@ -38,11 +41,58 @@ void doCommand()
     return;
 }
 
-int main(void)
+/**
+ * @brief Usage: ./server [--memory <MB>] [--buffer-policy LRU|CLOCK|2Q] [--prefetch <pages>] [--mmap on|off] [--compression on|off] [--search-plan auto|index|scan]
+ * --prefetch sets how many pages are read ahead of sequential scans (0 turns
+ * read-ahead off). --mmap off reads pages into private buffers instead of
+ * mapping them. --compression off stores pages uncompressed. --search-plan
+ * index or scan makes SEARCH skip its cost estimate and always use the index
+ * (where it can answer the condition) or always scan, to compare the plans.
+ * The memory budget can also be changed later with SET MEMORY <MB>.
+ */
+int main(int argc, char *argv[])
 {
 
     regex delim("[^\\s,()]+"); // Updated regex to handle parentheses as delimiters as well
     string command;
+    size_t memoryBudgetMB = DEFAULT_MEMORY_MB;
+    string replacementPolicy = DEFAULT_REPLACEMENT_POLICY;
+    size_t prefetchDepth = DEFAULT_PREFETCH_DEPTH;
+    bool mappedReads = true;
+    bool pageCompression = true;
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        string arg = argv[argIndex];
+        if ((arg == "--memory" || arg == "-m") && argIndex + 1 < argc && regex_match(argv[argIndex + 1], regex("[0-9]+")))
+        {
+            memoryBudgetMB = stoul(argv[++argIndex]);
+        }
+        else if ((arg == "--buffer-policy" || arg == "-p") && argIndex + 1 < argc)
+        {
+            replacementPolicy = argv[++argIndex];
+        }
+        else if (arg == "--prefetch" && argIndex + 1 < argc && regex_match(argv[argIndex + 1], regex("[0-9]+")))
+        {
+            prefetchDepth = stoul(argv[++argIndex]);
+        }
+        else if (arg == "--mmap" && argIndex + 1 < argc && (string(argv[argIndex + 1]) == "on" || string(argv[argIndex + 1]) == "off"))
+        {
+            mappedReads = string(argv[++argIndex]) == "on";
+        }
+        else if (arg == "--compression" && argIndex + 1 < argc && (string(argv[argIndex + 1]) == "on" || string(argv[argIndex + 1]) == "off"))
+        {
+            pageCompression = string(argv[++argIndex]) == "on";
+        }
+        else if (arg == "--search-plan" && argIndex + 1 < argc && regex_match(argv[argIndex + 1], regex("auto|index|scan")))
+        {
+            string plan = argv[++argIndex];
+            searchPlan = plan == "index" ? INDEX_PLAN : plan == "scan" ? SCAN_PLAN : AUTO_PLAN;
+        }
+        else
+        {
+            cerr << "Warning: Ignoring unknown argument '" << arg << "'. Usage: " << argv[0] << " [--memory <MB>] [--buffer-policy LRU|CLOCK|2Q] [--prefetch <pages>] [--mmap on|off] [--compression on|off] [--search-plan auto|index|scan]" << endl;
+        }
+    }
     // Use system calls cautiously, consider platform compatibility
     // Ensure the paths are correct relative to the executable's CWD
     if (system("rm -rf ../data/temp") != 0)
@@ -54,6 +104,19 @@ int main(void)
         cerr << "Error: Could not create temp directory." << endl;
         return 1; // Exit if essential directory cannot be created
     }
+    if (!memoryManager.setBudget(memoryBudgetMB))
+    {
+        cerr << "Warning: Using the default memory budget of " << DEFAULT_MEMORY_MB << " MB." << endl;
+        memoryManager.setBudget(DEFAULT_MEMORY_MB);
+    }
+    if (!bufferManager.setReplacementPolicy(replacementPolicy))
+    {
+        cerr << "Warning: Using the default replacement policy " << DEFAULT_REPLACEMENT_POLICY << "." << endl;
+        bufferManager.setReplacementPolicy(DEFAULT_REPLACEMENT_POLICY);
+    }
+    bufferManager.setPrefetchDepth(prefetchDepth);
+    bufferManager.setMappedReads(mappedReads);
+    bufferManager.setPageCompression(pageCompression);
 
     while (!cin.eof())
     {
@@ -123,6 +186,7 @@ int main(void)
     }
 
     // Cleanup before exiting if necessary
+    finishAllIndexBuilds();
     // system("rm -rf ../data/temp"); // Optional: clean up temp files on exit
 
     return 0; // Indicate successful execution
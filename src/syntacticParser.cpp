@@ -27,6 +27,7 @@ bool syntacticParseCROSSTRANSPOSEMATRIX();
 bool syntacticParseINSERT();
 bool syntacticParseUPDATE();
 bool syntacticParseDELETE();
+bool syntacticParseSETMEMORY();
 bool syntacticParsePROJECTION();
 bool syntacticParseSELECTION();
 bool syntacticParseJOIN();
@@ -120,6 +121,8 @@ bool syntacticParse()
         return syntacticParseUPDATE(); 
     else if (possibleQueryType == "DELETE")
         return syntacticParseDELETE(); 
+    else if (possibleQueryType == "SET")
+        return syntacticParseSETMEMORY();
     else 
     {
         string resultantRelationName = possibleQueryType;
@@ -190,6 +193,7 @@ void ParsedQuery::clear()
     this->indexingStrategy = NOTHING;
     this->indexColumnName = "";
     this->indexRelationName = "";
+    this->indexInBackground = false;
 
     this->joinBinaryOperator = NO_BINOP_CLAUSE;
     this->joinResultRelationName = "";
@@ -199,6 +203,11 @@ void ParsedQuery::clear()
     this->joinSecondColumnName = "";
 
     this->loadRelationName = "";
+    this->loadColumnar = false;
+    this->loadIndexColumns.clear();
+    this->loadHashColumns.clear();
+    this->loadBloomColumns.clear();
+    this->loadIndexInBackground = false;
 
     this->printRelationName = "";
 
@@ -229,6 +238,10 @@ void ParsedQuery::clear()
 
     this->sourceFileName = "";
 
+    this->memoryBudgetMB = 0;
+
+    this->listObject = "";
+
     // Reset Matrix fields
     this->loadMatrixName = "";
     this->printMatrixName = "";
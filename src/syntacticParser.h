@@ -29,6 +29,7 @@ enum QueryType
     INSERT,
     UPDATE,
     DELETE,
+    SET_MEMORY,
 
     LOAD_MATRIX,
     PRINT_MATRIX,
@@ -93,6 +94,7 @@ public:
     IndexingStrategy indexingStrategy = NOTHING;
     string indexColumnName = "";
     string indexRelationName = "";
+    bool indexInBackground = false;
 
     BinaryOperator joinBinaryOperator = NO_BINOP_CLAUSE;
     string joinResultRelationName = "";
@@ -102,6 +104,11 @@ public:
     string joinSecondColumnName = "";
 
     string loadRelationName = "";
+    bool loadColumnar = false;
+    vector<string> loadIndexColumns; // B+ tree indexes
+    vector<string> loadHashColumns;
+    vector<string> loadBloomColumns;
+    bool loadIndexInBackground = false;
 
     string printRelationName = "";
 
@@ -172,6 +179,10 @@ public:
     
     vector<pair<string, int>> insertColumnsAndValues;
 
+    size_t memoryBudgetMB = 0;
+
+    string listObject = ""; // TABLES, INDEXES or BUFFER
+
     ParsedQuery();
     void clear();
 
@@ -195,6 +206,7 @@ bool syntacticParseSOURCE();
 bool syntacticParseINSERT();
 bool syntacticParseUPDATE();
 bool syntacticParseDELETE();
+bool syntacticParseSETMEMORY();
 // New prototype for LOAD MATRIX
 bool syntacticParseLOADMATRIX();
 bool syntacticParsePRINTMATRIX();
@@ -3,6 +3,9 @@
 #include <sstream>      // Make sure sstream is included
 #include <algorithm>    // For remove_if, needed by extractColumnNames if using original approach
 #include <cctype>       // For ::isspace if using original approach
+#include <thread>       // For hardware_concurrency
+#include "csvLoader.h"
+#include "ingestSink.h"
 
 /**
  * @brief Default constructor
@@ -16,7 +19,7 @@ Table::Table()
     this->rowCount = 0;
     this->blockCount = 0;
     this->maxRowsPerBlock = 0;
-    // multiColumnIndexData is default constructed (empty)
+    // indexes is default constructed (empty)
 }
 
 /**
@@ -36,7 +39,7 @@ Table::Table(const string &tableName)
     this->rowCount = 0;
     this->blockCount = 0;
     this->maxRowsPerBlock = 0;
-    // multiColumnIndexData is default constructed (empty)
+    // indexes is default constructed (empty)
 }
 
 /**
@@ -72,7 +75,7 @@ Table::Table(const string &tableName, const vector<string> &columns)
     // Initialize other members
     this->rowCount = 0; // New table starts empty
     this->blockCount = 0;
-    // multiColumnIndexData is default constructed (empty)
+    // indexes is default constructed (empty)
 
 
     // Write header row to the *temporary* file, truncating if it exists
@@ -91,10 +94,11 @@ Table::Table(const string &tableName, const vector<string> &columns)
  * reads data from the source file, splits it into blocks and updates table
  * statistics.
  *
+ * @param sinks extra ingest sinks for blockify, e.g. index builders
  * @return true if the table has been successfully loaded
  * @return false if an error occurred
  */
-bool Table::load()
+bool Table::load(const vector<IngestSink *> &sinks)
 {
     logger.log("Table::load: Starting load for " + this->tableName + " from " + this->sourceFileName);
     fstream fin(this->sourceFileName, ios::in);
@@ -111,7 +115,7 @@ bool Table::load()
              fin.clear(); // Clear potential EOF flags if needed
              fin.seekg(0, ios::beg);
              logger.log("Table::load: Column names extracted, proceeding to blockify.");
-             if (this->blockify()) { // blockify now uses the already open stream
+             if (this->blockify(sinks)) { // blockify now uses the already open stream
                   fin.close(); // Close file after successful blockify
                   logger.log("Table::load: Blockify successful for " + this->tableName);
                   return true;
@@ -201,34 +205,26 @@ bool Table::extractColumnNames(const string &firstLine)
 
 /**
  * @brief This function splits all the rows and stores them in multiple files of
- * one block size. Assumes the file stream is already open and positioned after the header.
+ * one block size. The data lines are parsed in byte ranges on a pool of
+ * threads (see CsvLoader); the parsed chunks come back in file order and are
+ * cut into pages here, so every page but the last is full and the pages are
+ * the same as with a single reader. Each page is handed to the ingest sinks:
+ * the page writer, the statistics collector, the zone map builder and any
+ * sinks passed in (e.g. index builders), so the data is only read once.
  *
+ * @param sinks extra sinks, run after the page writer, statistics and zone map
  * @return true if successfully blockified
  * @return false otherwise
  */
-bool Table::blockify()
+bool Table::blockify(const vector<IngestSink *> &sinks)
 {
     logger.log("Table::blockify starting for table " + this->tableName);
-    // Reopen the file; load() might have closed it or stream state might be bad
-    ifstream fin(this->sourceFileName, ios::in);
-     if (!fin.is_open()) {
-         logger.log("Table::blockify ERROR: Could not reopen source file " + this->sourceFileName);
-         return false;
-     }
-
-
-    string line, word;
     // Reset table stats before blockifying
     this->rowCount = 0;
     this->blockCount = 0;
     this->rowsPerBlockCount.clear();
-    // Ensure these are correctly sized AFTER columnCount is known
-    if (this->columnCount > 0) {
-        this->distinctValuesInColumns.assign(this->columnCount, unordered_set<int>());
-        this->distinctValuesPerColumnCount.assign(this->columnCount, 0);
-    } else {
+    if (this->columnCount == 0) {
          logger.log("Table::blockify ERROR: columnCount is 0.");
-         fin.close();
          return false;
     }
 
@@ -236,108 +232,83 @@ bool Table::blockify()
     // Ensure maxRowsPerBlock is positive before allocating page buffer
     if (this->maxRowsPerBlock == 0) {
          logger.log("Table::blockify ERROR: maxRowsPerBlock is zero. Check column count and BLOCK_SIZE.");
-         fin.close();
          return false;
      }
-    vector<vector<int> > rowsInPage(this->maxRowsPerBlock, vector<int>(this->columnCount));
 
+    PageWriterSink pageWriter;
+    StatisticsSink statistics;
+    ZoneMapSink zoneMap;
+    vector<IngestSink *> allSinks = {&pageWriter, &statistics, &zoneMap};
+    allSinks.insert(allSinks.end(), sinks.begin(), sinks.end());
+    for (IngestSink *sink : allSinks)
+    {
+        if (!sink->begin(*this)) {
+            logger.log("Table::blockify ERROR: An ingest sink could not start for " + this->tableName);
+            return false;
+        }
+    }
 
-    int pageRowCounter = 0; // How many rows currently in rowsInPage buffer
-    long long lineNum = 1; // Start counting lines after header
-    getline(fin, line); // Skip header line
+    CsvLoader loader(this->sourceFileName, this->columnCount);
+    string error;
+    if (!loader.start(max(1u, thread::hardware_concurrency()), error)) {
+        logger.log("Table::blockify ERROR: " + error);
+        return false;
+    }
+    logger.log("Table::blockify: Parsing " + to_string(loader.getChunkCount()) + " chunks on " + to_string(loader.getThreadCount()) + " threads.");
 
-    vector<int> currentRow(this->columnCount); // Use a temporary row vector
+    // Rows of the page being filled, row-major
+    vector<int> rowsInPage;
+    rowsInPage.reserve((size_t)this->maxRowsPerBlock * this->columnCount);
+    int pageRowCounter = 0; // How many rows currently in rowsInPage buffer
+    long long lineNum = 1; // Header line; a chunk's line i is line lineNum + 1 + i
 
-    while (getline(fin, line))
+    CsvChunk chunk;
+    while (loader.next(chunk))
     {
-        lineNum++;
-        stringstream s(line);
-        bool rowReadSuccess = true;
-        for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+        if (!chunk.valid) {
+            logger.log("Table::blockify ERROR: " + chunk.error);
+            cerr << "ERROR: Could not read " << this->sourceFileName << endl;
+            return false;
+        }
+        for (const CsvIssue &issue : chunk.issues)
         {
-            if (!getline(s, word, ',')) {
-                logger.log("Table::blockify WARNING: Line " + to_string(lineNum) + ": Not enough columns. Expected " + to_string(this->columnCount) + ". Line: " + line);
-                rowReadSuccess = false;
-                break;
+            long long issueLine = lineNum + 1 + issue.lineIndex;
+            if (issue.skipped) {
+                cout << "Skipping invalid row number " << issueLine << ": " << issue.line << endl;
+            } else {
+                logger.log("Table::blockify " + issue.level + ": Line " + to_string(issueLine) + issue.detail);
             }
-            try {
-                 // Trim whitespace before converting
-                 size_t first = word.find_first_not_of(" \t\n\r\f\v");
-                 if (string::npos == first) word = "";
-                 else {
-                     size_t last = word.find_last_not_of(" \t\n\r\f\v");
-                     word = word.substr(first, (last - first + 1));
-                 }
-
-                 if (word.empty()) { // Handle empty strings after trim - decide if this is an error or represents 0/NULL
-                     logger.log("Table::blockify WARNING: Line " + to_string(lineNum) + ", Column " + to_string(columnCounter) + ": Empty value after trim. Treating as 0.");
-                     currentRow[columnCounter] = 0; // Or handle as error/NULL if needed
-                 } else {
-                     currentRow[columnCounter] = stoi(word);
-                 }
-                 // Only copy to page buffer if conversion was okay so far
-                 if (rowReadSuccess) {
-                    rowsInPage[pageRowCounter][columnCounter] = currentRow[columnCounter];
-                 }
-             } catch (const std::invalid_argument& ia) {
-                 logger.log("Table::blockify ERROR: Line " + to_string(lineNum) + ": Invalid integer '" + word + "'.");
-                 rowReadSuccess = false;
-                 break;
-             } catch (const std::out_of_range& oor) {
-                 logger.log("Table::blockify ERROR: Line " + to_string(lineNum) + ": Integer out of range '" + word + "'.");
-                 rowReadSuccess = false;
-                 break;
-             }
         }
+        lineNum += chunk.lineCount;
 
-
-        // Check for too many columns
-        string remainingWord;
-        if (rowReadSuccess && getline(s, remainingWord)) {
-             // Trim remainingWord and check if it's empty
-            size_t first = remainingWord.find_first_not_of(" \t\n\r\f\v");
-             if (first != string::npos) { // Found non-whitespace characters
-                logger.log("Table::blockify WARNING: Line " + to_string(lineNum) + ": Too many columns. Extra content: '" + remainingWord + "'. Line: " + line);
-                rowReadSuccess = false;
-            }
-         }
-
-
-        if (rowReadSuccess) {
-            // Row is valid, update stats and add to page
-            this->updateStatistics(currentRow);
+        for (long long rowCounter = 0; rowCounter < chunk.rowCount; rowCounter++)
+        {
+            const int *row = chunk.values.data() + rowCounter * this->columnCount;
+            rowsInPage.insert(rowsInPage.end(), row, row + this->columnCount);
             this->rowCount++;
             pageRowCounter++;
 
-
             if (pageRowCounter == this->maxRowsPerBlock)
             {
                 logger.log("Table::blockify: Writing page " + to_string(this->blockCount) + " with " + to_string(pageRowCounter) + " rows.");
-                bufferManager.writePage(this->tableName, this->blockCount, rowsInPage, pageRowCounter);
-                this->blockCount++;
-                this->rowsPerBlockCount.emplace_back(pageRowCounter);
+                if (!this->writeBlock(allSinks, rowsInPage, pageRowCounter)) {
+                    return false;
+                }
                 pageRowCounter = 0; // Reset page buffer counter
             }
-        } else {
-             // Optional: Decide whether to skip the bad row or stop loading
-             cout << "Skipping invalid row number " << lineNum << ": " << line << endl;
-             // If you want to stop on error:
-             // fin.close(); return false;
-         }
-    } // End while(getline)
+        }
+    }
 
 
     // Write any remaining rows in the last partially filled page
     if (pageRowCounter > 0)
     {
         logger.log("Table::blockify: Writing final partial page " + to_string(this->blockCount) + " with " + to_string(pageRowCounter) + " rows.");
-        bufferManager.writePage(this->tableName, this->blockCount, rowsInPage, pageRowCounter);
-        this->blockCount++;
-        this->rowsPerBlockCount.emplace_back(pageRowCounter);
+        if (!this->writeBlock(allSinks, rowsInPage, pageRowCounter)) {
+            return false;
+        }
     }
 
-    fin.close(); // Close the file stream
-
 
     if (this->rowCount == 0 && this->columnCount > 0) {
         logger.log("Table::blockify WARNING: Table loaded successfully but is empty.");
@@ -345,52 +316,117 @@ bool Table::blockify()
     }
 
 
-    // Clear distinct value sets to save memory after blockification
-    this->distinctValuesInColumns.clear();
-    this->distinctValuesInColumns.shrink_to_fit();
+    for (IngestSink *sink : allSinks)
+    {
+        if (!sink->finish(*this)) {
+            logger.log("Table::blockify ERROR: An ingest sink could not finish for " + this->tableName);
+            return false;
+        }
+    }
+    this->invalidateDescriptor();
 
 
     logger.log("Table::blockify completed for " + this->tableName + ". Final Row Count: " + to_string(this->rowCount) + ", Final Block Count: " + to_string(this->blockCount));
     return true;
 }
 
+/**
+ * @brief Hands rowCount row-major rows to the sinks as the next page of the
+ * table, records the page and empties rows.
+ *
+ * @param sinks
+ * @param rows
+ * @param rowCount
+ * @return false if a sink failed
+ */
+bool Table::writeBlock(const vector<IngestSink *> &sinks, vector<int> &rows, int rowCount)
+{
+    RowBatch batch;
+    batch.data = rows.data();
+    batch.rowCount = rowCount;
+    batch.columnCount = this->columnCount;
+    for (IngestSink *sink : sinks)
+    {
+        if (!sink->consume(*this, this->blockCount, batch)) {
+            logger.log("Table::blockify ERROR: An ingest sink failed on page " + to_string(this->blockCount));
+            return false;
+        }
+    }
+    rows.clear();
+    this->blockCount++;
+    this->rowsPerBlockCount.emplace_back(rowCount);
+    return true;
+}
+
+
 
+/**
+ * @brief Starts collecting statistics from scratch, one ColumnStatistics per
+ * column.
+ */
+void Table::resetStatistics()
+{
+    this->columnStatistics.assign(this->columnCount, ColumnStatistics());
+    this->distinctValuesPerColumnCount.assign(this->columnCount, 0);
+}
 
 /**
  * @brief Given a row of values, this function will update the statistics it
- * stores i.e. it updates the number of rows that are present in the column and
- * the number of distinct values present in each column. These statistics are to
- * be used during optimisation. Called during blockify.
+ * stores i.e. the value count, zeros, min/max, distinct-count sketch and
+ * histogram sample of every column. These statistics are to be used during
+ * optimisation. Memory does not grow with the number of rows.
  *
  * @param row
  */
-void Table::updateStatistics(const vector<int> &row)
+void Table::updateStatistics(const RowView &row)
 {
-    // Ensure stats vectors are sized correctly (should be done by blockify start)
-     if (this->distinctValuesInColumns.size() != this->columnCount || this->distinctValuesPerColumnCount.size() != this->columnCount) {
+    if (this->columnStatistics.size() != this->columnCount) {
          // This indicates an earlier logic error
          logger.log("Table::updateStatistics ERROR: Stats vectors not initialized correctly.");
-         // Attempt to resize, but this might hide the root cause
-         this->distinctValuesInColumns.assign(this->columnCount, unordered_set<int>());
-         this->distinctValuesPerColumnCount.assign(this->columnCount, 0);
-         // return; // Or return to avoid potential crashes
-     }
+         this->resetStatistics();
+    }
+    for (int columnCounter = 0; columnCounter < (int)this->columnCount; columnCounter++)
+    {
+        this->columnStatistics[columnCounter].add(row[columnCounter]);
+    }
+}
 
+/**
+ * @brief Called after the last updateStatistics: builds the histograms and
+ * fills distinctValuesPerColumnCount from the sketches.
+ *
+ * @param histogramBuckets 0 for no histograms
+ */
+void Table::finishStatistics(int histogramBuckets)
+{
+    this->distinctValuesPerColumnCount.assign(this->columnCount, 0);
+    for (uint columnCounter = 0; columnCounter < this->columnCount && columnCounter < this->columnStatistics.size(); columnCounter++)
+    {
+        ColumnStatistics &statistics = this->columnStatistics[columnCounter];
+        statistics.buildHistogram(histogramBuckets);
+        this->distinctValuesPerColumnCount[columnCounter] = statistics.getDistinctCount();
+    }
+}
 
-    for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+
+/**
+ * @brief Marks the statistics of a column (or of every column, for -1) as
+ * stale after its values changed. They are not kept up to date row by row;
+ * the zone map is, and the planner falls back to it (see isFullScanCheaper).
+ *
+ * @param columnIndex
+ */
+void Table::invalidateStatistics(int columnIndex)
+{
+    for (int columnCounter = 0; columnCounter < (int)this->columnStatistics.size(); columnCounter++)
     {
-        // distinctValuesInColumns is guaranteed to be populated during blockify
-        // Check if the value is already in the set for this column
-        if (this->distinctValuesInColumns[columnCounter].find(row[columnCounter]) == this->distinctValuesInColumns[columnCounter].end())
+        if (columnIndex == -1 || columnIndex == columnCounter)
         {
-            // If not found, insert it and increment the distinct count
-            this->distinctValuesInColumns[columnCounter].insert(row[columnCounter]);
-            this->distinctValuesPerColumnCount[columnCounter]++;
+            this->columnStatistics[columnCounter].stale = true;
         }
     }
 }
 
-
 /**
  * @brief Checks if the given column is present in this table.
  *
@@ -427,15 +463,13 @@ void Table::renameColumn(const string &fromColumnName,
     {
         if (this->columns[columnCounter] == fromColumnName)
         {
-            // Update index data if this column was indexed
-                        // Check if the new name affects the index
-            if (this->multiColumnIndexData.count(fromColumnName)) {
-                logger.log("Table::renameColumn: Updating index map key from '" + fromColumnName + "' to '" + toColumnName + "' using C++11 method.");
-                // C++11 way: Copy the map, insert under new key, then erase old key.
-                std::map<int, RowLocation> indexMapCopy = this->multiColumnIndexData[fromColumnName]; // Make a copy
-                this->multiColumnIndexData[toColumnName] = std::move(indexMapCopy); // Move the copy to the new key
-                this->multiColumnIndexData.erase(fromColumnName); // Erase the entry with the old key
-                logger.log("Index map key updated.");
+            // The index keeps its pages under the name it was built with
+            auto index = this->indexes.find(fromColumnName);
+            if (index != this->indexes.end()) {
+                logger.log("Table::renameColumn: Moving index of '" + fromColumnName + "' to '" + toColumnName + "'.");
+                std::shared_ptr<ColumnIndex> columnIndex = index->second;
+                this->indexes.erase(index);
+                this->indexes[toColumnName] = columnIndex;
             }
             // Update the column name in the vector
             columns[columnCounter] = toColumnName;
@@ -639,17 +673,15 @@ bool Table::isPermanent() const
  */
 void Table::unload(){
     logger.log("Table::unload starting for table: " + this->tableName);
-    this->clearIndex(); // Clear in-memory index data first
+    this->clearIndex(); // Drops the index pages first
 
 
-    // Delete page files from temp directory
-    logger.log("Deleting page files for table '" + this->tableName + "' from ../data/temp/");
-    for (uint pageCounter = 0; pageCounter < this->blockCount; pageCounter++) { // Use uint for blockCount type
-        // Construct page file name reliably
-        string pageFileName = "../data/temp/" + this->tableName + "_Page" + to_string(pageCounter);
-        // Use BufferManager's delete method which might handle logging/errors
-        bufferManager.deleteFile(pageFileName); // Pass full path
-    }
+    // Pooled pages (dirty or not) must not outlive the files or be written back
+    bufferManager.discardTablePages(this->tableName);
+
+    // All pages live in one segment file, so this is a single unlink
+    logger.log("Deleting segment file for table '" + this->tableName + "' from ../data/temp/");
+    bufferManager.deleteSegment(this->tableName);
 
 
     // Delete the source CSV file *only if it's temporary*
@@ -665,13 +697,32 @@ void Table::unload(){
     // The Table object itself will be deleted by TableCatalogue::deleteTable
 }
 
+/**
+ * @brief Writes a row viewed inside a page in the same comma separated format
+ * as writeRow(vector<T>, ostream&), without copying it into a vector first.
+ *
+ * @param row
+ * @param fout
+ */
+void Table::writeRow(const RowView &row, ostream &fout) const
+{
+    for (int columnCounter = 0; columnCounter < row.size(); columnCounter++)
+    {
+        if (columnCounter != 0)
+            fout << ", ";
+        fout << row[columnCounter];
+    }
+    fout << '\n';
+}
 
 /**
  * @brief Function that returns a cursor positioned at the start of this table (page 0).
  *
+ * @param pageFilter pages for which it returns false are skipped unread,
+ * page 0 included (see Cursor)
  * @return Cursor
  */
-Cursor Table::getCursor() const
+Cursor Table::getCursor(const function<bool(int)> &pageFilter) const
 {
     logger.log("Table::getCursor for table " + this->tableName);
     // Check if table has blocks before creating cursor
@@ -679,10 +730,43 @@ Cursor Table::getCursor() const
          logger.log("Table::getCursor WARNING: Table '" + this->tableName + "' has no blocks. Cursor will return empty rows.");
          // Create cursor anyway, its getNext() should handle empty table state.
      }
-    Cursor cursor(this->tableName, 0); // Always start cursor at page 0
+    Cursor cursor(this->tableName, 0, pageFilter); // Always start cursor at page 0
     return cursor;
 }
 
+/**
+ * @brief Returns the storage descriptor of the table, building it if the
+ * storage changed since the last call.
+ *
+ * @return std::shared_ptr<const TableDescriptor>
+ */
+std::shared_ptr<const TableDescriptor> Table::getDescriptor() const
+{
+    if (!this->descriptor)
+    {
+        logger.log("Table::getDescriptor: Building descriptor for " + this->tableName);
+        std::shared_ptr<TableDescriptor> newDescriptor = std::make_shared<TableDescriptor>();
+        newDescriptor->tableName = this->tableName;
+        newDescriptor->columnCount = this->columnCount;
+        newDescriptor->blockCount = this->blockCount;
+        newDescriptor->maxRowsPerBlock = this->maxRowsPerBlock;
+        newDescriptor->rowsPerBlockCount = this->rowsPerBlockCount;
+        newDescriptor->layout = this->layout;
+        this->descriptor = newDescriptor;
+    }
+    return this->descriptor;
+}
+
+/**
+ * @brief Must be called whenever columnCount, blockCount, maxRowsPerBlock,
+ * rowsPerBlockCount or layout change, so the next getDescriptor() sees the change.
+ *
+ */
+void Table::invalidateDescriptor()
+{
+    this->descriptor.reset();
+}
+
 /**
  * @brief Function that returns the zero-based index of column indicated by columnName
  *
@@ -709,24 +793,18 @@ int Table::getColumnIndex(const string &columnName) const
 // --- Indexing Method Implementations ---
 
 
-// Clears all column indices stored in multiColumnIndexData
+// Drops every column index of the table, deleting their pages
 void Table::clearIndex() {
-    if (!this->multiColumnIndexData.empty()) {
-         logger.log("Clearing all (" + to_string(this->multiColumnIndexData.size()) + ") column indices for table '" + this->tableName + "'");
-         this->multiColumnIndexData.clear();
-    }
-    // Also reset any flags if they were used (they are removed now)
-    // this->indexed = false;
-    // this->indexedColumn = "";
-    // this->indexingStrategy = NOTHING;
+    if (!this->indexes.empty()) {
+         logger.log("Clearing all (" + to_string(this->indexes.size()) + ") column indices for table '" + this->tableName + "'");
+         this->indexes.clear();
+    }
 }
 
 
-// Checks if a *specific* column has an index map entry
+// Checks if a *specific* column has an index
 bool Table::isIndexed(const string& columnName) const {
-    bool indexed = this->multiColumnIndexData.count(columnName) > 0;
-    // logger.log("Table::isIndexed check for column '" + columnName + "': " + (indexed ? "Yes" : "No")); // Verbose
-    return indexed;
+    return this->indexes.count(columnName) > 0;
 }
 
 // Removed getIndexedColumn() and getIndexingStrategy() implementations as they are no longer class members
\ No newline at end of file
@@ -5,9 +5,13 @@
 #include <map>
 #include <vector>
 #include <string>
-#include <unordered_set> // For distinctValuesInColumns
-#include <unordered_map> // For multiColumnIndexData outer map
+#include <unordered_set>
+#include <unordered_map> // For the per-column index map
 #include <utility>
+#include <memory>
+#include "columnStatistics.h"
+#include "zoneMap.h"
+#include "bloomFilter.h"
 
 // Bring commonly used std names into scope for this header
 using std::vector;
@@ -27,11 +31,37 @@ using std::to_string; // For logging if needed inside Table
 
 enum IndexingStrategy
 {
-    BTREE, // Represents std::map for now
-    HASH,  // Currently unused
+    BTREE, // B+ tree (see BPTree)
+    HASH,  // Extendible hash (see HashIndex)
     NOTHING
 };
 
+/**
+ * @brief Immutable snapshot of how a table is laid out on disk: everything a
+ * page load needs, and nothing else. It is built by the owning Table (and so
+ * owned through the catalogue) and handed out as a shared_ptr, so loading a
+ * page never copies the Table with its column names and indexes. Whenever
+ * the table's storage changes the Table drops its snapshot and builds a new
+ * one on the next request; holders of the old one keep a consistent view.
+ */
+struct TableDescriptor
+{
+    string tableName;
+    uint columnCount = 0;
+    uint blockCount = 0;
+    uint maxRowsPerBlock = 0;
+    vector<uint> rowsPerBlockCount;
+    PageLayout layout = ROW_LAYOUT;
+
+    long long getRowCount(int pageIndex) const
+    {
+        return pageIndex >= 0 && pageIndex < (int)this->rowsPerBlockCount.size() ? this->rowsPerBlockCount[pageIndex] : 0;
+    }
+};
+
+class IngestSink;
+class ColumnIndex;
+
 /**
  * @brief The Table class holds all information related to a loaded table. It
  * also implements methods that interact with the parsers, executors, cursors
@@ -47,11 +77,12 @@ class Table
 public:
     // Type alias for row location {pageIndex, rowIndexInPage}
     using RowLocation = pair<int, int>;
-    // Key: Column Name -> Value: The index map (ColumnValue -> Location) for that column
-    unordered_map<string, map<int, RowLocation>> multiColumnIndexData; // <<< Index for all columns
+    // Key: Column Name -> Value: The index on that column (BPTree or HashIndex)
+    unordered_map<string, std::shared_ptr<ColumnIndex>> indexes;
 
-    vector<unordered_set<int> > distinctValuesInColumns; // Still useful for optimization stats
-    // std::map<int, RowLocation> indexMapData; // <<< Replaced by multiColumnIndexData
+    vector<ColumnStatistics> columnStatistics; // per column, for optimization
+    ZoneMap zoneMap; // per page min/max, lets scans skip pages
+    PageBloomFilters bloomFilters; // optional, on the columns chosen at LOAD
     string sourceFileName = "";
     string tableName = "";
     vector<string> columns;
@@ -66,7 +97,10 @@ public:
     uint blockCount = 0;
     uint maxRowsPerBlock = 0;
     vector<uint> rowsPerBlockCount;
-    // Removed explicit index flags, check multiColumnIndexData instead
+    PageLayout layout = ROW_LAYOUT; // PAX_LAYOUT for tables loaded COLUMNAR
+    // Call invalidateDescriptor() after changing any of the storage fields above
+    mutable std::shared_ptr<const TableDescriptor> descriptor;
+    // Removed explicit index flags, check indexes instead
     // bool indexed = false;
     // string indexedColumn = "";
     // IndexingStrategy indexingStrategy = NOTHING;
@@ -81,7 +115,7 @@ public:
     ~Table() = default;
 
     // Load & persistence
-    bool load(); // LOAD command
+    bool load(const vector<IngestSink *> &sinks = vector<IngestSink *>()); // LOAD command
     bool isPermanent() const;
     void makePermanent(); // EXPORT command
     void unload();        // CLEAR or DROP
@@ -94,13 +128,19 @@ public:
                       const string &toColumnName);
 
     // Statistics update
-    void updateStatistics(const vector<int> &row);
+    void resetStatistics();
+    void updateStatistics(const RowView &row);
+    void finishStatistics(int histogramBuckets = DEFAULT_HISTOGRAM_BUCKETS);
+    void invalidateStatistics(int columnIndex = -1);
 
     // Blockify and I/O
-    bool blockify();    // split into pages
+    bool blockify(const vector<IngestSink *> &sinks = vector<IngestSink *>()); // split into pages
+    bool writeBlock(const vector<IngestSink *> &sinks, vector<int> &rows, int rowCount);
     void print() const; // PRINT command
     void getNextPage(Cursor *cursor);
-    Cursor getCursor();
+    Cursor getCursor(const std::function<bool(int)> &pageFilter = nullptr);
+    std::shared_ptr<const TableDescriptor> getDescriptor() const;
+    void invalidateDescriptor();
     int getColumnIndex(string columnName);
     void unload();
 
@@ -131,6 +171,8 @@ void writeRow(vector<T> row, ostream &fout)
     fout << endl;
 }
 
+void writeRow(const RowView &row, ostream &fout) const;
+
 /**
  * @brief Static function that takes a vector of valued and prints them out in a
  * comma seperated format. Appends to the source file.
@@ -1,6 +1,7 @@
 #include "global.h"
 #include "tableCatalogue.h"
 #include "table.h"  // Include the full definition of Table
+#include "indexBuilder.h"
 #include <iostream> // Include for cout
 
 using namespace std;
@@ -39,6 +40,41 @@ Table *TableCatalogue::getTable(const string &tableName)
     // logger.log("TableCatalogue::getTable: Warning - Table '" + tableName + "' not found.");
     return nullptr; // Return nullptr if table doesn't exist
 }
+/**
+ * @brief Returns the storage descriptor of a table, for code that only needs
+ * to locate and size its pages (page loads, read-ahead). The node pages of
+ * an index are described the same way, under the index's relation name.
+ *
+ * @param tableName
+ * @return std::shared_ptr<const TableDescriptor> nullptr if the table doesn't exist
+ */
+std::shared_ptr<const TableDescriptor> TableCatalogue::getDescriptor(const string &tableName)
+{
+    Table *table = this->getTable(tableName);
+    if (table)
+    {
+        return table->getDescriptor();
+    }
+    auto it = this->indexDescriptors.find(tableName);
+    return it == this->indexDescriptors.end() ? nullptr : it->second;
+}
+
+/**
+ * @brief Registers (or replaces) the descriptor of an index's node pages, so
+ * the buffer manager can load them like table pages.
+ *
+ * @param indexName relation name of the index (see getIndexName)
+ * @param descriptor
+ */
+void TableCatalogue::setIndexDescriptor(const string &indexName, std::shared_ptr<const TableDescriptor> descriptor)
+{
+    this->indexDescriptors[indexName] = descriptor;
+}
+
+void TableCatalogue::removeIndexDescriptor(const string &indexName)
+{
+    this->indexDescriptors.erase(indexName);
+}
 // Change parameter type to const string&
 bool TableCatalogue::isTable(const string &tableName)
 {
@@ -74,6 +110,38 @@ void TableCatalogue::print()
     printRowCount(rowCount);
 }
 
+/**
+ * @brief Prints every index of every table: its column, strategy, entry and
+ * page count, or that it is still being built in the background.
+ */
+void TableCatalogue::printIndexes()
+{
+    logger.log("TableCatalogue::printIndexes");
+    cout << "\nINDEXES" << endl;
+
+    int indexCount = 0;
+    for (auto rel : this->tables)
+    {
+        Table *table = rel.second;
+        for (const string &columnName : table->columns)
+        {
+            auto index = table->indexes.find(columnName);
+            if (index != table->indexes.end())
+            {
+                cout << rel.first << "." << columnName << " " << index->second->getStrategyName()
+                     << " (entries: " << index->second->getEntryCount() << ", pages: " << index->second->getPageCount() << ")" << endl;
+                indexCount++;
+            }
+            else if (isIndexBuildPending(rel.first, columnName))
+            {
+                cout << rel.first << "." << columnName << " (building in the background)" << endl;
+                indexCount++;
+            }
+        }
+    }
+    printRowCount(indexCount);
+}
+
 TableCatalogue::~TableCatalogue()
 {
     logger.log("TableCatalogue::~TableCatalogue");
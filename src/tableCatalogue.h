@@ -3,12 +3,14 @@
 
 #include <string>
 #include <unordered_map>
+#include <memory>
 #include "logger.h" // Include Logger for logging capabilities
 
 using namespace std;
 
 // Forward declare Table instead of including the full header
 class Table;
+struct TableDescriptor;
 
 /**
  * @brief The TableCatalogue acts like an index of tables existing in the
@@ -20,16 +22,21 @@ class TableCatalogue
 {
 
     unordered_map<string, Table *> tables;
+    unordered_map<string, std::shared_ptr<const TableDescriptor>> indexDescriptors; // index relation -> its node pages
 
 public:
     TableCatalogue() {}
     void insertTable(Table *table);
     void deleteTable(const std::string &tableName);                                      // Use const&
     Table *getTable(const std::string &tableName);                                       // Use const&
+    std::shared_ptr<const TableDescriptor> getDescriptor(const std::string &tableName);
+    void setIndexDescriptor(const std::string &indexName, std::shared_ptr<const TableDescriptor> descriptor);
+    void removeIndexDescriptor(const std::string &indexName);
     bool isTable(const std::string &tableName);                                          // Use const&
     bool isColumnFromTable(const std::string &columnName, const std::string &tableName); // Added declaration
     bool isMatrix(string matrixName);                                                    // Assuming this is used elsewhere
     void print();
+    void printIndexes();
     ~TableCatalogue();
 };
 
@@ -0,0 +1,133 @@
+#include "global.h"
+#include "zoneMap.h"
+
+/**
+ * @brief Drops all zones and starts a map for a table of columnCount columns
+ * with no pages.
+ *
+ * @param columnCount
+ */
+void ZoneMap::reset(int columnCount)
+{
+    this->columnCount = columnCount;
+    this->minValues.clear();
+    this->maxValues.clear();
+    this->rowCounts.clear();
+}
+
+/**
+ * @brief Drops all zones for good: used when the pages were rewritten in a
+ * way that does not maintain the map, so every page has to be read again.
+ */
+void ZoneMap::clear()
+{
+    this->reset(0);
+}
+
+/**
+ * @brief Empties the zone of pageIndex, appending it if pageIndex is the next
+ * page. A page further on would leave pages without a zone in between.
+ *
+ * @param pageIndex
+ * @return false if the page cannot be given a zone
+ */
+bool ZoneMap::startPage(int pageIndex)
+{
+    if (!this->isValid() || pageIndex < 0 || pageIndex > this->getPageCount())
+    {
+        return false;
+    }
+    if (pageIndex == this->getPageCount())
+    {
+        this->minValues.resize(this->minValues.size() + this->columnCount);
+        this->maxValues.resize(this->maxValues.size() + this->columnCount);
+        this->rowCounts.push_back(0);
+    }
+    this->rowCounts[pageIndex] = 0;
+    return true;
+}
+
+/**
+ * @brief Sets the zone of pageIndex to the range of the given rows, which
+ * are all the rows of the page.
+ *
+ * @param pageIndex
+ * @param rows row-major
+ */
+void ZoneMap::setPage(int pageIndex, const RowBatch &rows)
+{
+    if (rows.columnCount != this->columnCount || !this->startPage(pageIndex))
+    {
+        return;
+    }
+    for (int rowCounter = 0; rowCounter < rows.rowCount; rowCounter++)
+    {
+        this->addRow(pageIndex, rows.row(rowCounter));
+    }
+}
+
+/**
+ * @brief Recomputes the zone of pageIndex from the page itself, after its
+ * rows were changed or removed in place.
+ *
+ * @param pageIndex
+ * @param page
+ */
+void ZoneMap::setPage(int pageIndex, const Page &page)
+{
+    if (page.getColumnCount() != this->columnCount || !this->startPage(pageIndex))
+    {
+        return;
+    }
+    long long rowCount = page.getRowCount();
+    if (rowCount == 0)
+    {
+        return;
+    }
+    size_t zoneStart = (size_t)pageIndex * this->columnCount;
+    for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+    {
+        // Column at a time: read in place on PAX pages
+        const int *column = page.getColumn(columnCounter);
+        int minValue = column[0];
+        int maxValue = column[0];
+        for (long long rowCounter = 1; rowCounter < rowCount; rowCounter++)
+        {
+            minValue = min(minValue, column[rowCounter]);
+            maxValue = max(maxValue, column[rowCounter]);
+        }
+        this->minValues[zoneStart + columnCounter] = minValue;
+        this->maxValues[zoneStart + columnCounter] = maxValue;
+    }
+    this->rowCounts[pageIndex] = rowCount;
+}
+
+/**
+ * @brief Widens the zone of pageIndex to hold a row added to the page. The
+ * row may start a new page right after the last one.
+ *
+ * @param pageIndex
+ * @param row
+ */
+void ZoneMap::addRow(int pageIndex, const RowView &row)
+{
+    if (row.size() != this->columnCount || (pageIndex == this->getPageCount() && !this->startPage(pageIndex)) || !this->covers(pageIndex, 0))
+    {
+        return;
+    }
+    size_t zoneStart = (size_t)pageIndex * this->columnCount;
+    bool first = this->rowCounts[pageIndex] == 0;
+    for (int columnCounter = 0; columnCounter < this->columnCount; columnCounter++)
+    {
+        int value = row[columnCounter];
+        if (first || value < this->minValues[zoneStart + columnCounter])
+        {
+            this->minValues[zoneStart + columnCounter] = value;
+        }
+        if (first || value > this->maxValues[zoneStart + columnCounter])
+        {
+            this->maxValues[zoneStart + columnCounter] = value;
+        }
+    }
+    this->rowCounts[pageIndex]++;
+}
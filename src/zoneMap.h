@@ -0,0 +1,49 @@
+#ifndef ZONEMAP_H
+#define ZONEMAP_H
+
+#include "cursor.h"
+#include <vector>
+
+// DO NOT USE "using namespace std;" in header files
+
+/**
+ * @brief Per-page, per-column minimum and maximum of a table ("zone map"),
+ * so a scan can skip pages whose values cannot satisfy its predicate without
+ * reading them. Built by Table::blockify and kept up to date by the commands
+ * that change pages in place (INSERT, UPDATE, DELETE).
+ *
+ * A zone is always a superset of the page's values: after an update it is
+ * recomputed from the page, after an insert it is only widened. Pages past
+ * getPageCount() have no zone and must be read; a cleared map (columnCount
+ * 0) has none at all and ignores updates until reset().
+ */
+class ZoneMap
+{
+    int columnCount = 0;
+    // pageIndex * columnCount + columnIndex
+    std::vector<int> minValues;
+    std::vector<int> maxValues;
+    std::vector<long long> rowCounts; // per page
+
+    bool startPage(int pageIndex);
+
+public:
+    void reset(int columnCount);
+    void clear();
+
+    bool isValid() const { return this->columnCount > 0; }
+    int getPageCount() const { return this->rowCounts.size(); }
+    bool covers(int pageIndex, int columnIndex) const
+    {
+        return pageIndex >= 0 && pageIndex < this->getPageCount() && columnIndex >= 0 && columnIndex < this->columnCount;
+    }
+    bool isEmpty(int pageIndex) const { return this->rowCounts[pageIndex] == 0; }
+    int getMin(int pageIndex, int columnIndex) const { return this->minValues[(size_t)pageIndex * this->columnCount + columnIndex]; }
+    int getMax(int pageIndex, int columnIndex) const { return this->maxValues[(size_t)pageIndex * this->columnCount + columnIndex]; }
+
+    void setPage(int pageIndex, const RowBatch &rows);
+    void setPage(int pageIndex, const Page &page);
+    void addRow(int pageIndex, const RowView &row);
+};
+
+#endif // ZONEMAP_H